@@ -4,33 +4,37 @@ out vec4 out_colour;
 in vec2 v_tex;
 in vec4 v_colour;
 in vec2 v_sprite_pos;
+flat in float v_tex_slot;
 
-// hard coded for kennynl spritesheet atm
-const int num_cols = 48;
-const int num_rows = 22;
-const float scale_x = 1.0f / num_cols;
-const float scale_y = 1.0f / num_rows;
-
-uniform sampler2D tex;
+// every spritesheet is a layer in one array, so all sprites go out in one draw call.
+// layers are sized to the biggest sheet, tex_uv_scale is the part of a layer each sheet covers.
+const int max_layers = MAX_TEXTURE_LAYERS; // sprite_renderer::max_texture_layers
+uniform sampler2DArray tex;
+uniform vec2 tex_uv_scale[max_layers];
+uniform vec2 tex_cells[max_layers]; // cells across and down each sheet, from its atlas
 
 // uniform bool aces_tone_mapping;
 
 void
 main()
 {
+  int layer = int(v_tex_slot + 0.5);
+  vec2 uv_scale = tex_uv_scale[layer];
+  vec2 cells = tex_cells[layer];
+
   // clang-format off
   vec2 sprite_tex_coord = vec2(
-    v_tex.x / num_cols + v_sprite_pos.x * scale_x,
-    v_tex.y / num_rows + v_sprite_pos.y * scale_y
+    (v_tex.x + v_sprite_pos.x) / cells.x,
+    (v_tex.y + v_sprite_pos.y) / cells.y
   );
   // clang-format on
 
   vec4 c;
 
   if (v_sprite_pos.x == 0 && v_sprite_pos.y == 0) {
-    c = v_colour * texture(tex, v_tex);
+    c = v_colour * texture(tex, vec3(v_tex * uv_scale, layer));
   } else {
-    c = v_colour * texture(tex, sprite_tex_coord);
+    c = v_colour * texture(tex, vec3(sprite_tex_coord * uv_scale, layer));
   }
 
   out_colour = c;
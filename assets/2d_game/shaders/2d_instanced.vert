@@ -4,14 +4,22 @@ layout(location = 0) in vec4 vertex;
 layout(location = 1) in vec4 colour;
 layout(location = 2) in vec2 sprite_pos;
 layout(location = 3) in mat4 model;
+layout(location = 7) in float tex_slot;
 
 out vec2 v_tex;
 out vec4 v_colour;
 out vec2 v_sprite_pos;
+flat out float v_tex_slot;
 
-uniform mat4 projection;
-uniform bool shake;
-uniform float time;
+layout(std140) uniform FrameData
+{
+  mat4 projection;
+  float time;
+  bool shake;
+  vec2 screen_size;
+};
+
+uniform mat4 view; // identity for dynamic sprites, the camera for static sprites
 const float strength = 0.005;
 
 void
@@ -20,8 +28,9 @@ main()
   v_tex = vertex.zw;
   v_colour = colour;
   v_sprite_pos = sprite_pos;
+  v_tex_slot = tex_slot;
 
-  gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
+  gl_Position = projection * view * model * vec4(vertex.xy, 0.0, 1.0);
 
   if (shake) {
     gl_Position.x += cos(time * 10) * strength;
@@ -1,22 +1,56 @@
 #version 330 core
+#ifdef QUANTIZED_VERTICES
+layout (location = 0) in vec4 aPos;       // snorm16, within the mesh bounds
+layout (location = 1) in vec2 aNormal;    // snorm16, octahedral encoded
+layout (location = 2) in vec2 aTexCoords; // half floats
+
+uniform vec3 position_offset;
+uniform vec3 position_scale;
+
+// same as mesh_format::decode_octahedral()
+vec3 decode_octahedral(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+#else
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+#endif
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
 uniform mat4 view_projection;
+#ifdef INSTANCED
+layout (location = 3) in mat4 instance_model; // per instance, see InstanceBuffer
+#else
 uniform mat4 model;
+#endif
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));   
+#ifdef INSTANCED
+    mat4 model = instance_model;
+#endif
+#ifdef QUANTIZED_VERTICES
+    vec3 position = position_offset + position_scale * aPos.xyz;
+    vec3 normal = decode_octahedral(aNormal);
+#else
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+#endif
+
+    FragPos = vec3(model * vec4(position, 1.0));   
     TexCoords = aTexCoords;
         
     mat3 normalMatrix = transpose(inverse(mat3(model)));
-    Normal = normalize(normalMatrix * aNormal);
+    Normal = normalize(normalMatrix * normal);
     
-    gl_Position = view_projection * model * vec4(aPos, 1.0);
+    gl_Position = view_projection * model * vec4(position, 1.0);
 }
@@ -13,6 +13,12 @@ struct triangle {
     vertex p1;
     vertex p2;
 };
+struct bvh_node {
+    vec3 min;
+    uint index; // leaf: first triangle, interior: skip index
+    vec3 max;
+    uint count; // 0 for interior nodes, whose first child is the next node
+};
 struct ray {
     vec3 origin, direction;
 };
@@ -43,7 +49,11 @@ layout(binding = 0, rgba16f) readonly uniform image2D normalTexture;
 layout(binding = 1, rgba16f) writeonly uniform image2D outTexture;
 layout( std430, binding = 2 ) readonly buffer bufferData
 {
-    triangle triangles[];
+    triangle triangles[]; // in bvh leaf order
+};
+layout( std430, binding = 3 ) readonly buffer bvhData
+{
+    bvh_node nodes[]; // see bvh::build()
 };
 
 // ---- DEFINES ----
@@ -64,6 +74,7 @@ layout( std430, binding = 2 ) readonly buffer bufferData
 // ---- UNIFORMS ----
 
 uniform int set_triangles;
+uniform int set_nodes;
 uniform float time;
 uniform vec3 eye, ray00, ray01, ray10, ray11;
 vec3 light_source;
@@ -179,27 +190,55 @@ bool intersects_triangle(ray r, triangle tri, inout hit_info i)
     return false; // this ray hits the triangle
 }
 
-bool intersects_any_triangle(ray r, inout hit_info info, int set_triangles)
+// slab test, only counts boxes nearer than the closest hit so far
+bool intersects_box(const bvh_node node, const ray r, const vec3 inv_direction, float closest)
+{
+    vec3 t0 = (node.min - r.origin) * inv_direction;
+    vec3 t1 = (node.max - r.origin) * inv_direction;
+    vec3 near = min(t0, t1);
+    vec3 far = max(t0, t1);
+    float t_near = max(max(near.x, near.y), near.z);
+    float t_far = min(min(far.x, far.y), far.z);
+    return t_far >= max(t_near, 0.0) && t_near < closest;
+}
+
+// stackless, same walk as bvh::intersect(): into a node on a hit, past its subtree on a miss
+bool intersects_any_triangle(ray r, inout hit_info info, int set_nodes)
 {
     float t_nearest = LARGE_FLOAT;
     bool intersect = false;
-    int t_index;
+    vec3 inv_direction = 1.0 / r.direction;
 
-    for (int i = 0; i < set_triangles; i++)
+    uint i = 0;
+    while (i < uint(set_nodes))
     {
-        hit_info h;
-        const triangle tri = triangles[i];
-        if (intersects_triangle(r, tri, h) && h.t < t_nearest)
+        const bvh_node node = nodes[i];
+        bool leaf = node.count > 0;
+
+        if (!intersects_box(node, r, inv_direction, t_nearest))
         {
-            //a closer triangle intersected the ray!
-            intersect = true;
+            i = leaf ? i + 1 : node.index;
+            continue;
+        }
 
-            t_nearest = h.t;
-            t_index = i;
+        if (leaf)
+        {
+            for (uint j = node.index; j < node.index + node.count; j++)
+            {
+                hit_info h;
+                if (intersects_triangle(r, triangles[j], h) && h.t < t_nearest)
+                {
+                    //a closer triangle intersected the ray!
+                    intersect = true;
+                    t_nearest = h.t;
+                    info = h;
+                    info.index = int(j);
+                }
+            }
         }
+        i++;
     }
 
-    info.index = t_index;
     return intersect;
 }
 
@@ -323,7 +362,31 @@ vec3 trace(ray r, vec3 normal)
 
     for(int index = 0; index < BOUNCES; index++ )
     {
-        if(intersects_any_sphere(ray_to_shoot, i))
+        hit_info triangle_hit;
+        bool hit_triangle = intersects_any_triangle(ray_to_shoot, triangle_hit, set_nodes);
+        bool hit_any_sphere = intersects_any_sphere(ray_to_shoot, i);
+
+        // triangles are diffuse, in their first vertex's colour
+        if(hit_triangle && (!hit_any_sphere || triangle_hit.t < i.t))
+        {
+            if(index == BOUNCES - 1){
+                final_attenuation = vec3(0.0, 0.0, 0.0);
+                break;
+            }
+
+            material triangle_mat;
+            triangle_mat.material_type = MATERIAL_DIFFUSE;
+            triangle_mat.albedo_colour = triangles[triangle_hit.index].p0.colour.rgb;
+
+            ray scattered_ray;
+            vec3 attenuation;
+            scatter_diffuse(ray_to_shoot, triangle_hit, triangle_mat, attenuation, scattered_ray);
+            final_attenuation *= attenuation;
+            ray_to_shoot = scattered_ray;
+            continue;
+        }
+
+        if(hit_any_sphere)
         {
             intersected = true;
             const sphere hit_sphere = spheres[i.index];
@@ -0,0 +1,42 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in uvec4 aBoneIds;
+layout (location = 4) in vec4 aBoneWeights; // unorm8, sums to 1
+
+#define MAX_BONES 100 // animation::max_bones
+
+// this instance's range of the palette buffer, see SkinnedModel::draw()
+layout (std140) uniform BonePalette
+{
+    mat4 bones[MAX_BONES];
+};
+
+out VS_OUT
+{
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+} vs_out;
+
+uniform mat4 view_projection;
+uniform mat4 model;
+
+void main()
+{
+    mat4 skin = bones[aBoneIds.x] * aBoneWeights.x
+              + bones[aBoneIds.y] * aBoneWeights.y
+              + bones[aBoneIds.z] * aBoneWeights.z
+              + bones[aBoneIds.w] * aBoneWeights.w;
+    mat4 skinned_model = model * skin;
+
+    vec4 world_position = skinned_model * vec4(aPos, 1.0);
+    vs_out.FragPos = world_position.xyz;
+    vs_out.TexCoords = aTexCoords;
+
+    mat3 normalMatrix = transpose(inverse(mat3(skinned_model)));
+    vs_out.Normal = normalize(normalMatrix * aNormal);
+
+    gl_Position = view_projection * world_position;
+}
@@ -14,6 +14,8 @@
 // #include "engine/graphics/shader.hpp"
 // #include "engine/graphics/util/opengl_util.hpp"
 // #include "engine/mesh/primitives.hpp"
+// #include "engine/bvh.hpp"
+// #include "engine/thread_pool.hpp"
 
 // namespace fightingengine {
 
@@ -53,9 +55,12 @@
 //   unsigned int ssbo;
 //   unsigned int ssbo_binding;
 
-//   size_t max_triangles = 100;
+//   // triangles are uploaded in bvh leaf order, and the shader walks the nodes
 //   size_t set_triangles = 0;
 //   std::vector<ComputeShaderTriangle> triangles;
+//   unsigned int bvh_ssbo;
+//   unsigned int bvh_ssbo_binding = 3;
+//   size_t set_nodes = 0;
 
 //   primitives::Plane plane;
 
@@ -267,6 +272,8 @@
 //   CHECK_OPENGL_ERROR(4);
 
 //   s_Data.ssbo = SSBO;
+
+//   glGenBuffers(1, &s_Data.bvh_ssbo);
 // }
 
 // // 1. geometry pass: render scene's geometry/color data into gbuffer
@@ -306,23 +313,27 @@
 //       std::vector<Triangle> triangles_in_scene = triangles;
 //       size_t triangles_in_scene_size = triangles_in_scene.size();
 
-//       // Check max triangles
-//       if (triangles_in_scene_size > s_Data.max_triangles) {
-//         printf("too many triangles! handle this scenario");
-//         return;
-//       }
-
 //       // Check ssbo size
 //       if (s_Data.set_triangles != triangles_in_scene_size) {
 //         printf("Updating SSBO triangles with: %zi triangles \n",
 //                triangles_in_scene_size);
 
+//         // build the bvh, the triangles go up in its leaf order
+//         std::vector<bvh::Triangle> bvh_triangles(triangles_in_scene_size);
+//         for (size_t i = 0; i < triangles_in_scene_size; i++) {
+//           bvh_triangles[i].v0 = triangles_in_scene[i].p0.Position;
+//           bvh_triangles[i].v1 = triangles_in_scene[i].p1.Position;
+//           bvh_triangles[i].v2 = triangles_in_scene[i].p2.Position;
+//         }
+//         bvh::Tree tree = bvh::build(bvh_triangles, get_thread_pool());
+
 //         // refresh triangle data
 //         s_Data.triangles.clear();
 //         s_Data.triangles.resize(triangles_in_scene_size);
 
 //         // convert FGTriangle to ComputeShaderTriangle
-//         for (int i = 0; i < triangles_in_scene_size; i++) {
+//         for (int slot = 0; slot < triangles_in_scene_size; slot++) {
+//           const size_t i = tree.indices[slot];
 //           ComputeShaderVertex v1;
 //           v1.pos = glm::vec4(triangles_in_scene[i].p0.Position, 1.0f);
 //           v1.nml = glm::vec4(triangles_in_scene[i].p0.Normal, 1.0f);
@@ -341,9 +352,9 @@
 //           v3.tex = glm::vec4(triangles_in_scene[i].p2.TexCoords, 1.0f, 1.0f);
 //           v3.colour = triangles_in_scene[i].p2.Colour.colour;
 
-//           s_Data.triangles[i].p0 = v1;
-//           s_Data.triangles[i].p1 = v2;
-//           s_Data.triangles[i].p2 = v3;
+//           s_Data.triangles[slot].p0 = v1;
+//           s_Data.triangles[slot].p1 = v2;
+//           s_Data.triangles[slot].p2 = v3;
 //         }
 
 //         // upload data to ssbo when triangle size changes
@@ -359,7 +370,14 @@
 //         // glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int),
 //         // all_balls.size() * sizeof(Ball), &(all_balls[0]));
 
+//         glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_Data.bvh_ssbo);
+//         glBufferData(GL_SHADER_STORAGE_BUFFER,
+//                      tree.nodes.size() * sizeof(bvh::Node),
+//                      tree.nodes.data(),
+//                      GL_STATIC_DRAW);
+
 //         s_Data.set_triangles = triangles_in_scene_size;
+//         s_Data.set_nodes = tree.nodes.size();
 //       }
 
 //       s_Data.refresh_ssbo = false;
@@ -410,6 +428,8 @@
 
 //   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, s_Data.ssbo_binding, s_Data.ssbo);
 //   CHECK_OPENGL_ERROR(9);
+//   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, s_Data.bvh_ssbo_binding, s_Data.bvh_ssbo);
+//   s_Data.compute_shader.set_int("set_nodes", static_cast<int>(s_Data.set_nodes));
 
 //   // set the ssbo size in a uniform
 //   // s_Data.compute_shader.setInt("set_triangles", s_Data.set_triangles);
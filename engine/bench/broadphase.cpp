@@ -0,0 +1,99 @@
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "2d_game.hpp"
+#include "2d_physics.hpp"
+#include "engine/maths_core.hpp"
+
+using namespace fightingengine;
+using namespace game2d;
+
+enum class Distribution
+{
+  Uniform,   // spread over the world
+  Clustered, // a horde around a few points, lots of overlap
+  Line,      // every object at the same x, the worst case for the x axis sweep
+};
+
+static std::vector<GameObject2D>
+make_objects(size_t count, Distribution distribution)
+{
+  RandomState rnd;
+  // about as dense as a busy game at 1k objects
+  const float extent = 40.0f * std::sqrt(static_cast<float>(count));
+
+  std::vector<glm::vec2> clusters(8);
+  for (glm::vec2& cluster : clusters)
+    cluster = { rand_det_s(rnd.rng, 0.0f, extent), rand_det_s(rnd.rng, 0.0f, extent) };
+
+  std::vector<GameObject2D> objects(count);
+  for (size_t i = 0; i < count; i++) {
+    GameObject2D& obj = objects[i];
+    obj.collision_layer = i % 4 == 0 ? CollisionLayer::Bullet : CollisionLayer::Enemy;
+    switch (distribution) {
+      case Distribution::Uniform:
+        obj.pos = { rand_det_s(rnd.rng, 0.0f, extent), rand_det_s(rnd.rng, 0.0f, extent) };
+        break;
+      case Distribution::Clustered: {
+        const glm::vec2 centre = clusters[i % clusters.size()];
+        obj.pos = centre + glm::vec2(rand_det_s(rnd.rng, -100.0f, 100.0f), rand_det_s(rnd.rng, -100.0f, 100.0f));
+        break;
+      }
+      case Distribution::Line:
+        obj.pos = { 0.0f, rand_det_s(rnd.rng, 0.0f, extent) };
+        break;
+    }
+  }
+  return objects;
+}
+
+// arg 0: objects, arg 1: Distribution, arg 2: 1 to sort the objects by morton code first
+static void
+BM_SapBroadphase(benchmark::State& state)
+{
+  std::vector<GameObject2D> objects =
+    make_objects(static_cast<size_t>(state.range(0)), static_cast<Distribution>(state.range(1)));
+  if (state.range(2) == 1)
+    sort_by_morton(objects, PHYSICS_GRID_SIZE);
+  std::vector<std::reference_wrapper<GameObject2D>> collidable(objects.begin(), objects.end());
+  std::map<uint64_t, Collision2D> collisions;
+
+  for (auto _ : state) {
+    collisions.clear();
+    generate_filtered_broadphase_collisions(collidable, collisions);
+    benchmark::DoNotOptimize(collisions.size());
+  }
+  state.counters["pairs"] = static_cast<double>(collisions.size());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SapBroadphase)
+  ->ArgNames({ "objects", "distribution", "morton" })
+  ->ArgsProduct({ { 100, 1000, 10000 },
+                  { static_cast<int>(Distribution::Uniform),
+                    static_cast<int>(Distribution::Clustered),
+                    static_cast<int>(Distribution::Line) },
+                  { 0, 1 } })
+  ->Unit(benchmark::kMicrosecond);
+
+// arg 0: objects. sorts a freshly spawned (unsorted) list every iteration
+static void
+BM_SortByMorton(benchmark::State& state)
+{
+  const std::vector<GameObject2D> objects = make_objects(static_cast<size_t>(state.range(0)), Distribution::Uniform);
+  std::vector<GameObject2D> sorting;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    sorting = objects;
+    state.ResumeTiming();
+    sort_by_morton(sorting, PHYSICS_GRID_SIZE);
+    benchmark::DoNotOptimize(sorting.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SortByMorton)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
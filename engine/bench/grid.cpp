@@ -0,0 +1,111 @@
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "engine/grid.hpp"
+#include "engine/maths_core.hpp"
+
+using namespace fightingengine;
+
+// objects the size of a sprite, spread over a few screens
+static std::vector<glm::vec2>
+make_positions(size_t count)
+{
+  RandomState rnd;
+  std::vector<glm::vec2> positions(count);
+  for (glm::vec2& pos : positions)
+    pos = { rand_det_s(rnd.rng, -2000.0f, 2000.0f), rand_det_s(rnd.rng, -2000.0f, 2000.0f) };
+  return positions;
+}
+
+static void
+BM_GetUniqueCells(benchmark::State& state)
+{
+  const std::vector<glm::vec2> positions = make_positions(1024);
+  const glm::vec2 size = { 20.0f, 20.0f };
+  const int grid_size = static_cast<int>(state.range(0));
+  std::vector<glm::ivec2> cells;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    game2d::grid::get_unique_cells(positions[i++ & 1023], size, grid_size, cells);
+    benchmark::DoNotOptimize(cells.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+// small cells, most objects straddle a corner
+BENCHMARK(BM_GetUniqueCells)->Arg(16)->Arg(100);
+
+static void
+BM_EncodeCantorPairing(benchmark::State& state)
+{
+  const std::vector<glm::vec2> positions = make_positions(1024);
+  std::vector<glm::ivec2> ids(positions.size());
+  std::transform(positions.begin(), positions.end(), ids.begin(), [](const glm::vec2& pos) {
+    return glm::ivec2(std::abs(static_cast<int>(pos.x)), std::abs(static_cast<int>(pos.y)));
+  });
+
+  size_t i = 0;
+  for (auto _ : state) {
+    const glm::ivec2& id = ids[i++ & 1023];
+    benchmark::DoNotOptimize(encode_cantor_pairing_function(id.x, id.y));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EncodeCantorPairing);
+
+static void
+BM_DecodeCantorPairing(benchmark::State& state)
+{
+  std::vector<uint64_t> keys(1024);
+  for (size_t i = 0; i < keys.size(); i++)
+    keys[i] = encode_cantor_pairing_function(static_cast<int>(i * 7), static_cast<int>(i * 13));
+
+  size_t i = 0;
+  uint32_t x, y;
+  for (auto _ : state) {
+    decode_cantor_pairing_function(keys[i++ & 1023], x, y);
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(y);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DecodeCantorPairing);
+
+// the bit at a time loop encode_cantor_pairing_function() used to be, to compare against
+static uint64_t
+interleave_bits_loop(uint32_t x, uint32_t y)
+{
+  uint64_t p = 0;
+  int i = 0;
+  while (x || y) {
+    p |= static_cast<uint64_t>(x & 1) << i;
+    x >>= 1;
+    p |= static_cast<uint64_t>(y & 1) << (i + 1);
+    y >>= 1;
+    i += 2;
+  }
+  return p;
+}
+
+// arg 0: 1 for morton_encode_2d(), 0 for the loop
+static void
+BM_MortonEncode(benchmark::State& state)
+{
+  const std::vector<glm::vec2> positions = make_positions(1024);
+  std::vector<glm::uvec2> cells(positions.size());
+  std::transform(positions.begin(), positions.end(), cells.begin(), [](const glm::vec2& pos) {
+    return glm::uvec2(static_cast<uint32_t>(pos.x + 2000.0f), static_cast<uint32_t>(pos.y + 2000.0f));
+  });
+
+  const bool magic = state.range(0) == 1;
+  size_t i = 0;
+  for (auto _ : state) {
+    const glm::uvec2& cell = cells[i++ & 1023];
+    benchmark::DoNotOptimize(magic ? morton_encode_2d(cell.x, cell.y) : interleave_bits_loop(cell.x, cell.y));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MortonEncode)->ArgName("magic")->Arg(0)->Arg(1);
@@ -0,0 +1,72 @@
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "engine/tools/metrics.hpp"
+#include "engine/tools/profiler.hpp"
+
+using namespace fightingengine;
+
+// what a PROFILE_ZONE costs the code it times
+static void
+BM_ProfileZone(benchmark::State& state)
+{
+  std::vector<profiler::Zone> zones;
+  uint32_t since_collect = 0;
+  for (auto _ : state) {
+    {
+      PROFILE_ZONE("bench zone");
+    }
+    // collect like new_frame() would, so the buffer never fills and drops zones
+    if (++since_collect == profiler::zones_per_thread) {
+      state.PauseTiming();
+      zones.clear();
+      profiler::collect_zones(zones);
+      since_collect = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProfileZone);
+
+static void
+BM_ProfilerStage(benchmark::State& state)
+{
+  Profiler profiler;
+  for (auto _ : state) {
+    profiler.begin(Profiler::Stage::GameTick);
+    profiler.end(Profiler::Stage::GameTick);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ProfilerStage);
+
+// arg 0: zones finished during the frame, collected and sorted by new_frame()
+static void
+BM_ProfilerNewFrame(benchmark::State& state)
+{
+  Profiler profiler;
+  profiler.new_frame();
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int64_t i = 0; i < state.range(0); i++) {
+      PROFILE_ZONE("bench zone");
+    }
+    state.ResumeTiming();
+    profiler.new_frame();
+  }
+}
+BENCHMARK(BM_ProfilerNewFrame)->Arg(0)->Arg(1000)->Arg(10000);
+
+static void
+BM_MetricsAdd(benchmark::State& state)
+{
+  const metrics::Id id = metrics::register_counter("bench counter");
+  for (auto _ : state)
+    metrics::add(id);
+  metrics::new_frame();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MetricsAdd);
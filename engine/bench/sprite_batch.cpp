@@ -0,0 +1,79 @@
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "2d_game_object.hpp"
+#include "engine/maths_core.hpp"
+#include "opengl/render_queue.hpp"
+#include "opengl/sprite_renderer.hpp"
+#include "spritemap.hpp"
+
+using namespace fightingengine;
+using namespace game2d;
+
+static std::vector<GameObject2D>
+make_sprites(size_t count)
+{
+  RandomState rnd;
+  std::vector<GameObject2D> sprites(count);
+  for (size_t i = 0; i < count; i++) {
+    GameObject2D& sprite = sprites[i];
+    sprite.pos = { rand_det_s(rnd.rng, 0.0f, 1280.0f), rand_det_s(rnd.rng, 0.0f, 720.0f) };
+    sprite.angle_radians = rand_det_s(rnd.rng, 0.0f, PI);
+    sprite.render_layer = static_cast<RenderLayer>(i % 4);
+    sprite.sprite = i % 2 == 0 ? sprite::type::SQUARE : sprite::type::PERSON_1;
+    sprite.tex_slot = static_cast<int>(i % 2);
+  }
+  return sprites;
+}
+
+// the cpu side of sprite_renderer::draw_instanced_sprite(), filling the vertex buffer without a gl context
+static void
+BM_SpriteBatchBuild(benchmark::State& state)
+{
+  const std::vector<GameObject2D> sprites = make_sprites(static_cast<size_t>(state.range(0)));
+  const GameObject2D camera = gameobject::create_camera();
+  const glm::ivec2 screen_size = { 1280, 720 };
+  const glm::vec4 colour = { 1.0f, 1.0f, 1.0f, 1.0f };
+  std::vector<sprite_renderer::Vertex> vertices(sprite_renderer::max_quad_vert_count);
+
+  for (auto _ : state) {
+    sprite_renderer::Vertex* ptr = vertices.data();
+    for (const GameObject2D& go : sprites) {
+      const glm::vec2 worldspace_pos = gameobject_in_worldspace(camera, go);
+      if (gameobject_off_screen(worldspace_pos, go.render_size, screen_size))
+        continue;
+      const glm::vec2 pivot = sprite::spritemap::get_sprite_pivot(go.sprite);
+      const glm::mat4 model =
+        sprite_renderer::sprite_model_matrix(worldspace_pos, go.angle_radians, go.render_size, pivot);
+      const glm::vec2 sprite_offset = sprite::spritemap::get_sprite_offset(go.sprite);
+      sprite_renderer::write_quad(
+        ptr, model, sprite_offset, static_cast<float>(go.tex_slot), colour, colour, colour, colour);
+    }
+    benchmark::DoNotOptimize(ptr);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpriteBatchBuild)->Arg(1000)->Arg(5000);
+
+// building and radix sorting the render queue's keys, drain() is the part that needs gl
+static void
+BM_RenderQueueSubmitSort(benchmark::State& state)
+{
+  const std::vector<GameObject2D> sprites = make_sprites(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    render_queue::begin_frame();
+    for (size_t i = 0; i < sprites.size(); i++) {
+      const GameObject2D& go = sprites[i];
+      const BlendMode blend = i % 8 == 0 ? BlendMode::Additive : BlendMode::Alpha;
+      render_queue::submit(go, go.render_size, 0, static_cast<uint8_t>(go.tex_slot), blend);
+    }
+    render_queue::sort();
+  }
+  render_queue::reset_stats();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RenderQueueSubmitSort)->Arg(1000)->Arg(5000);
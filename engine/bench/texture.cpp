@@ -0,0 +1,101 @@
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "engine/mapped_file.hpp"
+#include "engine/maths_core.hpp"
+#include "engine/texture_format.hpp"
+
+using namespace fightingengine;
+
+// a gradient with some noise, so the png doesn't compress to nothing
+static texture_format::Image
+make_image(uint32_t size)
+{
+  RandomState rnd;
+  texture_format::Image image;
+  image.width = size;
+  image.height = size;
+  image.rgba.resize(static_cast<size_t>(size) * size * 4);
+  for (uint32_t y = 0; y < size; y++) {
+    for (uint32_t x = 0; x < size; x++) {
+      uint8_t* texel = &image.rgba[(static_cast<size_t>(y) * size + x) * 4];
+      const uint8_t noise = static_cast<uint8_t>(rand_det_s(rnd.rng, 0.0f, 32.0f));
+      texel[0] = static_cast<uint8_t>(x * 255 / size) ^ noise;
+      texel[1] = static_cast<uint8_t>(y * 255 / size);
+      texel[2] = noise;
+      texel[3] = 255;
+    }
+  }
+  return image;
+}
+
+// what load_texture() does for a source image
+static void
+BM_DecodePng(benchmark::State& state)
+{
+  const texture_format::Image image = make_image(static_cast<uint32_t>(state.range(0)));
+  int png_size = 0;
+  unsigned char* png = stbi_write_png_to_mem(
+    image.rgba.data(), static_cast<int>(image.width * 4), image.width, image.height, 4, &png_size);
+
+  for (auto _ : state) {
+    int width, height, components;
+    unsigned char* data = stbi_load_from_memory(png, png_size, &width, &height, &components, 4);
+    benchmark::DoNotOptimize(data);
+    stbi_image_free(data);
+  }
+  std::free(png);
+  state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK(BM_DecodePng)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// what texture_cooker does before compressing, decoding srgb and filtering every level
+static void
+BM_GenerateMips(benchmark::State& state)
+{
+  const texture_format::Image image = make_image(static_cast<uint32_t>(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(texture_format::generate_mips(image, true));
+  state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * 4);
+}
+BENCHMARK(BM_GenerateMips)->Arg(256)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// what load_texture() does for a baked .tex, the alternative to BM_DecodePng
+static void
+BM_MapBakedTexture(benchmark::State& state)
+{
+  const texture_format::Image image = make_image(static_cast<uint32_t>(state.range(0)));
+  texture_format::TextureData texture;
+  texture.format = texture_format::Format::RGBA8;
+  texture.width = image.width;
+  texture.height = image.height;
+  for (texture_format::Image& mip : texture_format::generate_mips(image, true))
+    texture.levels.push_back(std::move(mip.rgba));
+
+  const std::string path = (std::filesystem::temp_directory_path() / "fightingengine_bench.tex").string();
+  if (!texture_format::write(path, texture)) {
+    state.SkipWithError("could not write the texture");
+    return;
+  }
+
+  for (auto _ : state) {
+    MappedFile file;
+    texture_format::TextureView view;
+    if (!map_file(path, file) || !texture_format::parse(file.data, file.size, view)) {
+      state.SkipWithError("could not map the texture");
+      break;
+    }
+    benchmark::DoNotOptimize(view.data);
+    unmap_file(file);
+  }
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_MapBakedTexture)->Arg(256)->Arg(1024);
@@ -79,3 +79,19 @@ endif()
 
 
 
+
+# counts every new/delete, for the profiler panel. see engine/tools/profiler.hpp
+option(FIGHTINGENGINE_TRACK_ALLOCATIONS "Replace operator new/delete to track allocations" OFF)
+if(FIGHTINGENGINE_TRACK_ALLOCATIONS)
+    add_compile_definitions(FIGHTINGENGINE_TRACK_ALLOCATIONS)
+endif()
+
+# pdep/pext morton codes, for cpus with BMI2. see engine/maths_core.hpp
+option(FIGHTINGENGINE_BMI2 "Build for cpus with BMI2" OFF)
+if(FIGHTINGENGINE_BMI2)
+    if(MSVC)
+        add_compile_options(/arch:AVX2)
+    else()
+        add_compile_options(-mbmi2)
+    endif()
+endif()
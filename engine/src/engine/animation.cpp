@@ -0,0 +1,248 @@
+// header
+#include "engine/animation.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cmath>
+
+// your project headers
+#include "engine/simd.hpp"
+#include "engine/thread_pool.hpp"
+#include "engine/tools/profiler.hpp"
+
+namespace fightingengine {
+
+namespace animation {
+
+void
+Pose::resize(size_t nodes)
+{
+  for (std::vector<float>* channel : { &tx, &ty, &tz, &rx, &ry, &rz, &sx, &sy, &sz })
+    channel->resize(nodes, 0.0f);
+  rw.resize(nodes, 1.0f);
+}
+
+int32_t
+Skeleton::find_node(const std::string& name) const
+{
+  for (size_t i = 0; i < names.size(); i++) {
+    if (names[i] == name)
+      return static_cast<int32_t>(i);
+  }
+  return node_not_found;
+}
+
+// the keys either side of time, and how far between them it is
+static void
+find_keys(const float* times, uint32_t count, float time, uint32_t& a, uint32_t& b, float& t)
+{
+  const float* next = std::upper_bound(times, times + count, time);
+  if (next == times) {
+    a = b = 0;
+    t = 0.0f;
+    return;
+  }
+  if (next == times + count) {
+    a = b = count - 1;
+    t = 0.0f;
+    return;
+  }
+  b = static_cast<uint32_t>(next - times);
+  a = b - 1;
+  const float span = times[b] - times[a];
+  t = span > 0.0f ? (time - times[a]) / span : 0.0f;
+}
+
+void
+sample_clip(const Skeleton& skeleton, const Clip& clip, float time, Pose& pose)
+{
+  pose = skeleton.bind_pose;
+
+  for (const Track& track : clip.tracks) {
+    const size_t node = track.node;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    float t = 0.0f;
+
+    if (track.position_count > 0) {
+      find_keys(&clip.position_times[track.first_position], track.position_count, time, a, b, t);
+      const glm::vec3 p = glm::mix(clip.positions[track.first_position + a], clip.positions[track.first_position + b], t);
+      pose.tx[node] = p.x;
+      pose.ty[node] = p.y;
+      pose.tz[node] = p.z;
+    }
+    if (track.rotation_count > 0) {
+      find_keys(&clip.rotation_times[track.first_rotation], track.rotation_count, time, a, b, t);
+      const glm::quat q = glm::normalize(
+        glm::slerp(clip.rotations[track.first_rotation + a], clip.rotations[track.first_rotation + b], t));
+      pose.rx[node] = q.x;
+      pose.ry[node] = q.y;
+      pose.rz[node] = q.z;
+      pose.rw[node] = q.w;
+    }
+    if (track.scale_count > 0) {
+      find_keys(&clip.scale_times[track.first_scale], track.scale_count, time, a, b, t);
+      const glm::vec3 s = glm::mix(clip.scales[track.first_scale + a], clip.scales[track.first_scale + b], t);
+      pose.sx[node] = s.x;
+      pose.sy[node] = s.y;
+      pose.sz[node] = s.z;
+    }
+  }
+}
+
+// translation * rotation * scale, for one node
+static void
+local_matrix(const Pose& pose, size_t i, glm::mat4& out)
+{
+  const float x = pose.rx[i], y = pose.ry[i], z = pose.rz[i], w = pose.rw[i];
+  out[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * pose.sx[i];
+  out[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * pose.sy[i];
+  out[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * pose.sz[i];
+  out[3] = glm::vec4(pose.tx[i], pose.ty[i], pose.tz[i], 1.0f);
+}
+
+#ifdef FIGHTINGENGINE_SSE
+
+// the same as local_matrix(), for nodes i to i + 3, one node per lane
+static void
+local_matrices_x4(const Pose& pose, size_t i, glm::mat4* out)
+{
+  const __m128 x = _mm_loadu_ps(&pose.rx[i]);
+  const __m128 y = _mm_loadu_ps(&pose.ry[i]);
+  const __m128 z = _mm_loadu_ps(&pose.rz[i]);
+  const __m128 w = _mm_loadu_ps(&pose.rw[i]);
+  const __m128 sx = _mm_loadu_ps(&pose.sx[i]);
+  const __m128 sy = _mm_loadu_ps(&pose.sy[i]);
+  const __m128 sz = _mm_loadu_ps(&pose.sz[i]);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+  const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+  const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+  // m[column][row], scaled by column
+  float m[12][4];
+  _mm_storeu_ps(m[0], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx));
+  _mm_storeu_ps(m[1], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx));
+  _mm_storeu_ps(m[2], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx));
+  _mm_storeu_ps(m[3], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy));
+  _mm_storeu_ps(m[4], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy));
+  _mm_storeu_ps(m[5], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy));
+  _mm_storeu_ps(m[6], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz));
+  _mm_storeu_ps(m[7], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz));
+  _mm_storeu_ps(m[8], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz));
+  _mm_storeu_ps(m[9], _mm_loadu_ps(&pose.tx[i]));
+  _mm_storeu_ps(m[10], _mm_loadu_ps(&pose.ty[i]));
+  _mm_storeu_ps(m[11], _mm_loadu_ps(&pose.tz[i]));
+
+  for (int lane = 0; lane < 4; lane++) {
+    glm::mat4& o = out[lane];
+    o[0] = glm::vec4(m[0][lane], m[1][lane], m[2][lane], 0.0f);
+    o[1] = glm::vec4(m[3][lane], m[4][lane], m[5][lane], 0.0f);
+    o[2] = glm::vec4(m[6][lane], m[7][lane], m[8][lane], 0.0f);
+    o[3] = glm::vec4(m[9][lane], m[10][lane], m[11][lane], 1.0f);
+  }
+}
+
+// out = a * b, column major. out may alias a or b.
+static void
+multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+  const float* pa = &a[0][0];
+  const float* pb = &b[0][0];
+  const __m128 a0 = _mm_loadu_ps(pa + 0);
+  const __m128 a1 = _mm_loadu_ps(pa + 4);
+  const __m128 a2 = _mm_loadu_ps(pa + 8);
+  const __m128 a3 = _mm_loadu_ps(pa + 12);
+
+  __m128 columns[4];
+  for (int c = 0; c < 4; c++) {
+    __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[c * 4 + 0]));
+    r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[c * 4 + 1])));
+    r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[c * 4 + 2])));
+    r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[c * 4 + 3])));
+    columns[c] = r;
+  }
+  float* po = &out[0][0];
+  for (int c = 0; c < 4; c++)
+    _mm_storeu_ps(po + c * 4, columns[c]);
+}
+
+#else
+
+static void
+multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+  out = a * b;
+}
+
+#endif
+
+void
+compute_palette(const Skeleton& skeleton, const Pose& pose, std::vector<glm::mat4>& scratch, glm::mat4* palette)
+{
+  const size_t nodes = skeleton.parents.size();
+  scratch.resize(nodes);
+
+  size_t i = 0;
+#ifdef FIGHTINGENGINE_SSE
+  for (; i + 4 <= nodes; i += 4)
+    local_matrices_x4(pose, i, &scratch[i]);
+#endif
+  for (; i < nodes; i++)
+    local_matrix(pose, i, scratch[i]);
+
+  // parents come first, so they're already global when their children get here
+  for (i = 0; i < nodes; i++) {
+    const int32_t parent = skeleton.parents[i];
+    if (parent != no_parent)
+      multiply(scratch[parent], scratch[i], scratch[i]);
+  }
+
+  for (i = 0; i < nodes; i++) {
+    const int32_t bone = skeleton.bones[i];
+    if (bone == not_a_bone)
+      continue;
+    glm::mat4 node_to_model;
+    multiply(skeleton.global_inverse, scratch[i], node_to_model);
+    multiply(node_to_model, skeleton.bone_offsets[bone], palette[bone]);
+  }
+}
+
+void
+update_animations(const Skeleton& skeleton,
+                  const std::vector<Clip>& clips,
+                  std::vector<AnimationState>& states,
+                  float delta_time_s,
+                  ThreadPool& pool)
+{
+  PROFILE_ZONE("animation::update_animations");
+  // a handful of characters per chunk keeps the pool busy without much scheduling
+  const size_t chunk_size = 4;
+
+  pool.parallel_for(states.size(), chunk_size, [&](size_t begin, size_t end) {
+    std::vector<glm::mat4> scratch;
+    for (size_t i = begin; i < end; i++) {
+      AnimationState& state = states[i];
+      if (state.clip >= clips.size())
+        continue;
+      const Clip& clip = clips[state.clip];
+
+      state.time += delta_time_s * state.speed;
+      if (clip.duration > 0.0f) {
+        state.time = std::fmod(state.time, clip.duration);
+        if (state.time < 0.0f)
+          state.time += clip.duration;
+      }
+
+      sample_clip(skeleton, clip, state.time, state.pose);
+      state.palette.resize(skeleton.get_bone_count());
+      compute_palette(skeleton, state.pose, scratch, state.palette.data());
+    }
+  });
+}
+
+} // namespace animation
+
+} // namespace fightingengine
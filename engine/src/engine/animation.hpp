@@ -0,0 +1,114 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// other library headers
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace fightingengine {
+
+class ThreadPool;
+
+//
+// Skeletal animation, cpu side.
+// Clips are sampled in to a Pose (structure of arrays, one entry per skeleton node),
+// and a Pose is turned in to the bone palette the skinning vertex shader reads.
+// Nothing here touches GL, see SkinnedModel for loading and drawing.
+//
+
+namespace animation {
+
+static const uint32_t max_bones = 100;       // MAX_BONES in skinned.vert
+static const uint32_t bones_per_vertex = 4; // the rest of a vertex's weights are dropped
+static const int32_t no_parent = -1;
+static const int32_t not_a_bone = -1;
+static const int32_t node_not_found = -1; // from Skeleton::find_node()
+
+// local transforms, one entry per node in each array
+struct Pose
+{
+  std::vector<float> tx, ty, tz;
+  std::vector<float> rx, ry, rz, rw;
+  std::vector<float> sx, sy, sz;
+
+  void resize(size_t nodes);
+  [[nodiscard]] size_t size() const { return tx.size(); };
+};
+
+struct Skeleton
+{
+  // depth first, so every parent comes before its children
+  std::vector<std::string> names;
+  std::vector<int32_t> parents;
+  std::vector<int32_t> bones;          // node to bone index, or not_a_bone
+  std::vector<glm::mat4> bone_offsets; // per bone, mesh space to bone space
+  Pose bind_pose;                      // the node transforms, for nodes without a track
+  glm::mat4 global_inverse = glm::mat4(1.0f);
+
+  // returns node_not_found if there's no node with that name
+  [[nodiscard]] int32_t find_node(const std::string& name) const;
+  [[nodiscard]] uint32_t get_bone_count() const { return static_cast<uint32_t>(bone_offsets.size()); };
+};
+
+// where one node's keys live in a Clip's key arrays
+struct Track
+{
+  uint32_t node = 0;
+  uint32_t first_position = 0;
+  uint32_t position_count = 0;
+  uint32_t first_rotation = 0;
+  uint32_t rotation_count = 0;
+  uint32_t first_scale = 0;
+  uint32_t scale_count = 0;
+};
+
+// every track's keys packed in to shared arrays, times in seconds
+struct Clip
+{
+  std::string name;
+  float duration = 0.0f;
+  std::vector<Track> tracks;
+  std::vector<float> position_times;
+  std::vector<glm::vec3> positions;
+  std::vector<float> rotation_times;
+  std::vector<glm::quat> rotations;
+  std::vector<float> scale_times;
+  std::vector<glm::vec3> scales;
+};
+
+// one animated instance of a skeleton
+struct AnimationState
+{
+  uint32_t clip = 0;
+  float time = 0.0f; // seconds
+  float speed = 1.0f;
+  Pose pose;
+  std::vector<glm::mat4> palette; // one per bone, what the shader reads
+};
+
+// nodes without a track keep their bind pose
+void
+sample_clip(const Skeleton& skeleton, const Clip& clip, float time, Pose& pose);
+
+// palette[bone] = global_inverse * global node transform * bone offset.
+// locals are built 4 nodes at a time with SSE where it's available.
+// globals are one matrix multiply per node (SSE across the columns), as each node needs its parent's first.
+// scratch is resized to the node count, so it can be reused between calls.
+void
+compute_palette(const Skeleton& skeleton, const Pose& pose, std::vector<glm::mat4>& scratch, glm::mat4* palette);
+
+// advances (looping), samples and builds the palette for every state, split across the pool
+void
+update_animations(const Skeleton& skeleton,
+                  const std::vector<Clip>& clips,
+                  std::vector<AnimationState>& states,
+                  float delta_time_s,
+                  ThreadPool& pool);
+
+} // namespace animation
+
+} // namespace fightingengine
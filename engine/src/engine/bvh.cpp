@@ -0,0 +1,356 @@
+// header
+#include "engine/bvh.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// your project headers
+#include "engine/thread_pool.hpp"
+#include "engine/tools/profiler.hpp"
+
+namespace fightingengine {
+
+namespace bvh {
+
+static const float epsilon = 0.0001f; // EPSILON in raytraced.glsl
+
+// ranges smaller than this aren't worth handing to another thread
+static const uint32_t min_parallel_triangles = 1024;
+
+struct Bounds
+{
+  glm::vec3 min = glm::vec3(FLT_MAX);
+  glm::vec3 max = glm::vec3(-FLT_MAX);
+
+  void grow(const glm::vec3& p)
+  {
+    min = glm::min(min, p);
+    max = glm::max(max, p);
+  }
+  void grow(const Bounds& b)
+  {
+    min = glm::min(min, b.min);
+    max = glm::max(max, b.max);
+  }
+  [[nodiscard]] float area() const
+  {
+    const glm::vec3 e = max - min;
+    if (e.x < 0.0f)
+      return 0.0f;
+    return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+  }
+};
+
+struct BuildNode
+{
+  Bounds bounds;
+  uint32_t left = 0;
+  uint32_t right = 0;
+  uint32_t first = 0;
+  uint32_t count = 0;     // > 0 for leaves
+  int32_t subtree = -1;   // built separately, see Subtree
+};
+
+// a range below the parallel depth, built on its own thread
+struct Subtree
+{
+  uint32_t first = 0;
+  uint32_t count = 0;
+  std::vector<BuildNode> nodes;
+};
+
+struct Builder
+{
+  std::vector<Bounds> bounds; // per triangle
+  std::vector<glm::vec3> centroids;
+  std::vector<uint32_t> order; // partitioned in place, becomes Tree::indices
+  uint32_t parallel_depth = 0;
+  std::vector<Subtree> subtrees;
+};
+
+// partitions order[first, first + count) and returns the size of the left half, or 0 for a leaf
+static uint32_t
+split(Builder& builder, uint32_t first, uint32_t count, const Bounds& node_bounds)
+{
+  if (count <= 1)
+    return 0;
+
+  Bounds centroid_bounds;
+  for (uint32_t i = first; i < first + count; i++)
+    centroid_bounds.grow(builder.centroids[builder.order[i]]);
+  const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+
+  // cost of a split, relative to intersecting one triangle: 1 + (area_l * count_l + area_r * count_r) / area
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  uint32_t best_bin = 0;
+  const float node_area = std::max(node_bounds.area(), FLT_MIN);
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (extent[axis] <= 0.0f)
+      continue;
+    const float scale = bins / extent[axis];
+
+    Bounds bin_bounds[bins];
+    uint32_t bin_counts[bins] = {};
+    for (uint32_t i = first; i < first + count; i++) {
+      const uint32_t triangle = builder.order[i];
+      const float offset = builder.centroids[triangle][axis] - centroid_bounds.min[axis];
+      const uint32_t bin = std::min(bins - 1, static_cast<uint32_t>(offset * scale));
+      bin_counts[bin] += 1;
+      bin_bounds[bin].grow(builder.bounds[triangle]);
+    }
+
+    // sweep from the right, then from the left, to cost each of the bins - 1 planes
+    float right_areas[bins];
+    uint32_t right_counts[bins];
+    Bounds right;
+    uint32_t right_count = 0;
+    for (uint32_t b = bins - 1; b > 0; b--) {
+      right.grow(bin_bounds[b]);
+      right_count += bin_counts[b];
+      right_areas[b] = right.area();
+      right_counts[b] = right_count;
+    }
+    Bounds left;
+    uint32_t left_count = 0;
+    for (uint32_t b = 0; b < bins - 1; b++) {
+      left.grow(bin_bounds[b]);
+      left_count += bin_counts[b];
+      if (left_count == 0 || right_counts[b + 1] == 0)
+        continue;
+      const float cost = 1.0f + (left.area() * left_count + right_areas[b + 1] * right_counts[b + 1]) / node_area;
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+      }
+    }
+  }
+
+  uint32_t* begin = builder.order.data() + first;
+  uint32_t* end = begin + count;
+
+  if (best_axis == -1) {
+    // every centroid in the same place, split them evenly if there are too many for one leaf
+    if (count <= max_leaf_size)
+      return 0;
+    return count / 2;
+  }
+  if (best_cost >= static_cast<float>(count) && count <= max_leaf_size)
+    return 0;
+
+  const float scale = bins / extent[best_axis];
+  const float axis_min = centroid_bounds.min[best_axis];
+  uint32_t* middle = std::partition(begin, end, [&](uint32_t triangle) {
+    const float offset = builder.centroids[triangle][best_axis] - axis_min;
+    return std::min(bins - 1, static_cast<uint32_t>(offset * scale)) <= best_bin;
+  });
+  const uint32_t left_count = static_cast<uint32_t>(middle - begin);
+  if (left_count == 0 || left_count == count)
+    return count / 2;
+  return left_count;
+}
+
+static uint32_t
+build_node(Builder& builder, std::vector<BuildNode>& nodes, uint32_t first, uint32_t count, uint32_t depth, bool top)
+{
+  const uint32_t index = static_cast<uint32_t>(nodes.size());
+  nodes.emplace_back();
+  BuildNode node;
+  node.first = first;
+  for (uint32_t i = first; i < first + count; i++)
+    node.bounds.grow(builder.bounds[builder.order[i]]);
+
+  // the subtrees are built after the top of the tree, all at once
+  if (top && depth == builder.parallel_depth && count >= min_parallel_triangles) {
+    node.subtree = static_cast<int32_t>(builder.subtrees.size());
+    Subtree subtree;
+    subtree.first = first;
+    subtree.count = count;
+    builder.subtrees.push_back(std::move(subtree));
+    nodes[index] = node;
+    return index;
+  }
+
+  const uint32_t left_count = split(builder, first, count, node.bounds);
+  if (left_count == 0) {
+    node.count = count;
+    nodes[index] = node;
+    return index;
+  }
+
+  node.left = build_node(builder, nodes, first, left_count, depth + 1, top);
+  node.right = build_node(builder, nodes, first + left_count, count - left_count, depth + 1, top);
+  nodes[index] = node;
+  return index;
+}
+
+// depth first, writing each interior node's skip index once its subtree is out
+static void
+flatten(const std::vector<BuildNode>& nodes, uint32_t i, const std::vector<Subtree>& subtrees, std::vector<Node>& out)
+{
+  const BuildNode& node = nodes[i];
+  if (node.subtree >= 0) {
+    flatten(subtrees[node.subtree].nodes, 0, subtrees, out);
+    return;
+  }
+
+  const size_t index = out.size();
+  Node flat;
+  flat.min = node.bounds.min;
+  flat.max = node.bounds.max;
+  out.push_back(flat);
+
+  if (node.count > 0) {
+    out[index].index = node.first;
+    out[index].count = node.count;
+    return;
+  }
+  flatten(nodes, node.left, subtrees, out);
+  flatten(nodes, node.right, subtrees, out);
+  out[index].index = static_cast<uint32_t>(out.size());
+}
+
+Tree
+build(const std::vector<Triangle>& triangles, ThreadPool& pool)
+{
+  PROFILE_ZONE("bvh::build");
+  Tree tree;
+  if (triangles.empty())
+    return tree;
+
+  const uint32_t count = static_cast<uint32_t>(triangles.size());
+  Builder builder;
+  builder.bounds.resize(count);
+  builder.centroids.resize(count);
+  builder.order.resize(count);
+  pool.parallel_for(count, 4096, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const Triangle& triangle = triangles[i];
+      Bounds bounds;
+      bounds.grow(triangle.v0);
+      bounds.grow(triangle.v1);
+      bounds.grow(triangle.v2);
+      builder.bounds[i] = bounds;
+      builder.centroids[i] = (bounds.min + bounds.max) * 0.5f;
+      builder.order[i] = static_cast<uint32_t>(i);
+    }
+  });
+
+  // enough subtrees to keep every thread busy, even when they're uneven
+  const size_t threads = pool.get_worker_count() + 1;
+  while ((size_t(1) << builder.parallel_depth) < threads * 4)
+    builder.parallel_depth += 1;
+  if (threads == 1)
+    builder.parallel_depth = UINT32_MAX;
+
+  std::vector<BuildNode> top;
+  build_node(builder, top, 0, count, 0, true);
+
+  // the subtrees own disjoint ranges of order
+  pool.parallel_for(builder.subtrees.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      PROFILE_ZONE("bvh::build subtree");
+      Subtree& subtree = builder.subtrees[i];
+      build_node(builder, subtree.nodes, subtree.first, subtree.count, 0, false);
+    }
+  });
+
+  tree.nodes.reserve(top.size() * 2);
+  flatten(top, 0, builder.subtrees, tree.nodes);
+  tree.indices = std::move(builder.order);
+  return tree;
+}
+
+bool
+intersect_triangle(const Triangle& triangle, const glm::vec3& origin, const glm::vec3& direction, Hit& hit)
+{
+  const glm::vec3 v0v1 = triangle.v1 - triangle.v0;
+  const glm::vec3 v0v2 = triangle.v2 - triangle.v0;
+  const glm::vec3 pvec = glm::cross(direction, v0v2);
+  const float det = glm::dot(v0v1, pvec);
+
+  // no culling
+  if (std::abs(det) < epsilon)
+    return false;
+  const float inv_det = 1.0f / det;
+
+  const glm::vec3 tvec = origin - triangle.v0;
+  const float u = glm::dot(tvec, pvec) * inv_det;
+  if (u < 0.0f || u > 1.0f)
+    return false;
+
+  const glm::vec3 qvec = glm::cross(tvec, v0v1);
+  const float v = glm::dot(direction, qvec) * inv_det;
+  if (v < 0.0f || u + v > 1.0f)
+    return false;
+
+  const float t = glm::dot(v0v2, qvec) * inv_det;
+  if (t <= epsilon)
+    return false;
+
+  hit.t = t;
+  hit.u = u;
+  hit.v = v;
+  return true;
+}
+
+// slab test, only counts boxes nearer than the closest hit so far
+static bool
+intersect_box(const Node& node, const glm::vec3& origin, const glm::vec3& inv_direction, float closest)
+{
+  const glm::vec3 t0 = (node.min - origin) * inv_direction;
+  const glm::vec3 t1 = (node.max - origin) * inv_direction;
+  const glm::vec3 near = glm::min(t0, t1);
+  const glm::vec3 far = glm::max(t0, t1);
+  const float t_near = std::max(std::max(near.x, near.y), near.z);
+  const float t_far = std::min(std::min(far.x, far.y), far.z);
+  return t_far >= std::max(t_near, 0.0f) && t_near < closest;
+}
+
+bool
+intersect(const Tree& tree,
+          const std::vector<Triangle>& triangles,
+          const glm::vec3& origin,
+          const glm::vec3& direction,
+          Hit& hit)
+{
+  const glm::vec3 inv_direction = 1.0f / direction;
+  const uint32_t node_count = static_cast<uint32_t>(tree.nodes.size());
+  float closest = FLT_MAX;
+  bool found = false;
+
+  uint32_t i = 0;
+  while (i < node_count) {
+    const Node& node = tree.nodes[i];
+    const bool leaf = node.count > 0;
+
+    if (!intersect_box(node, origin, inv_direction, closest)) {
+      i = leaf ? i + 1 : node.index;
+      continue;
+    }
+
+    if (leaf) {
+      for (uint32_t j = node.index; j < node.index + node.count; j++) {
+        Hit candidate;
+        const uint32_t triangle = tree.indices[j];
+        if (intersect_triangle(triangles[triangle], origin, direction, candidate) && candidate.t < closest) {
+          closest = candidate.t;
+          hit = candidate;
+          hit.triangle = triangle;
+          found = true;
+        }
+      }
+    }
+    i += 1;
+  }
+
+  return found;
+}
+
+} // namespace bvh
+
+} // namespace fightingengine
@@ -0,0 +1,71 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <vector>
+
+// other library headers
+#include <glm/glm.hpp>
+
+namespace fightingengine {
+
+class ThreadPool;
+
+//
+// Bounding volume hierarchy over a triangle soup, for the compute ray tracer.
+// Built top down with a binned surface area heuristic, then flattened in to
+// depth first order with skip links, so it can be walked without a stack:
+// a hit goes to the next node, a miss jumps to the node's skip index.
+//
+
+namespace bvh {
+
+static const uint32_t bins = 16;
+static const uint32_t max_leaf_size = 4;
+
+struct Triangle
+{
+  glm::vec3 v0 = glm::vec3(0.0f);
+  glm::vec3 v1 = glm::vec3(0.0f);
+  glm::vec3 v2 = glm::vec3(0.0f);
+};
+
+// matches struct bvh_node in raytraced.glsl (std430)
+struct Node
+{
+  glm::vec3 min = glm::vec3(0.0f);
+  uint32_t index = 0; // leaf: first triangle, interior: skip index (the node after this subtree)
+  glm::vec3 max = glm::vec3(0.0f);
+  uint32_t count = 0; // triangles, 0 for interior nodes (whose first child is the next node)
+};
+static_assert(sizeof(Node) == 32, "bvh::Node must match the std430 layout of bvh_node");
+
+struct Tree
+{
+  std::vector<Node> nodes;       // nodes[0] is the root
+  std::vector<uint32_t> indices; // leaf order to the index of the triangle passed to build()
+};
+
+struct Hit
+{
+  float t = 0.0f;
+  float u = 0.0f;
+  float v = 0.0f;
+  uint32_t triangle = 0; // index in to the triangles passed to build()
+};
+
+// subtrees below the first few splits are built in parallel on the pool
+[[nodiscard]] Tree
+build(const std::vector<Triangle>& triangles, ThreadPool& pool);
+
+// the closest hit, walking the tree the same way raytraced.glsl does
+bool
+intersect(const Tree& tree, const std::vector<Triangle>& triangles, const glm::vec3& origin, const glm::vec3& direction, Hit& hit);
+
+// same test as intersects_triangle() in raytraced.glsl
+bool
+intersect_triangle(const Triangle& triangle, const glm::vec3& origin, const glm::vec3& direction, Hit& hit);
+
+} // namespace bvh
+
+} // namespace fightingengine
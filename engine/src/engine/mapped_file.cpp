@@ -0,0 +1,106 @@
+// header
+#include "engine/mapped_file.hpp"
+
+// c++ standard library headers
+#include <iostream>
+
+// platform headers
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fightingengine {
+
+#ifdef _WIN32
+
+bool
+map_file(const std::string& path, MappedFile& mapped)
+{
+  HANDLE file =
+    CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == NULL) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  mapped.data = static_cast<const uint8_t*>(data);
+  mapped.size = static_cast<size_t>(size.QuadPart);
+  mapped.file = reinterpret_cast<intptr_t>(file);
+  mapped.mapping = reinterpret_cast<intptr_t>(mapping);
+  return true;
+}
+
+void
+unmap_file(MappedFile& mapped)
+{
+  if (mapped.data != nullptr) {
+    UnmapViewOfFile(mapped.data);
+    CloseHandle(reinterpret_cast<HANDLE>(mapped.mapping));
+    CloseHandle(reinterpret_cast<HANDLE>(mapped.file));
+  }
+  mapped = MappedFile();
+}
+
+#else
+
+bool
+map_file(const std::string& path, MappedFile& mapped)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    std::cerr << "mmap failed for " << path << std::endl;
+    close(fd);
+    return false;
+  }
+
+  mapped.data = static_cast<const uint8_t*>(data);
+  mapped.size = static_cast<size_t>(info.st_size);
+  mapped.file = fd;
+  return true;
+}
+
+void
+unmap_file(MappedFile& mapped)
+{
+  if (mapped.data != nullptr) {
+    munmap(const_cast<uint8_t*>(mapped.data), mapped.size);
+    close(static_cast<int>(mapped.file));
+  }
+  mapped = MappedFile();
+}
+
+#endif
+
+} // namespace fightingengine
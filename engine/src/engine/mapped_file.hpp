@@ -0,0 +1,28 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fightingengine {
+
+// a read only view of a whole file, mapped in to memory
+struct MappedFile
+{
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+
+  // platform handles
+  intptr_t file = -1;
+  intptr_t mapping = 0;
+};
+
+// returns false if the file couldn't be opened or mapped (empty files can't be mapped)
+[[nodiscard]] bool
+map_file(const std::string& path, MappedFile& mapped);
+
+void
+unmap_file(MappedFile& mapped);
+
+} // namespace fightingengine
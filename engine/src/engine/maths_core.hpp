@@ -1,12 +1,19 @@
 #pragma once
 
 // c++ standard lib headers
+#include <cstdint>
 #include <random>
+#include <utility>
 
 // other library headers
 #include <glm/glm.hpp>
 #include <glm/gtx/compatibility.hpp>
 
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define FIGHTINGENGINE_BMI2
+#include <immintrin.h>
+#endif
+
 namespace fightingengine {
 
 constexpr float PI{ 3.1415926535897932385f };
@@ -45,11 +52,76 @@ rand_unit_vector(RandomState& rnd);
 [[nodiscard]] glm::vec3
 random_in_hemisphere(RandomState& rnd, glm::vec3& normal);
 
-[[nodiscard]] uint64_t
-encode_cantor_pairing_function(int x, int y);
+//
+// morton codes
+//
+
+// Interleaves the bits of x and y (x in the even bits, y in the odd), so points
+// close in 2d are usually close in the code. pdep/pext when compiled for BMI2,
+// otherwise shifts and masks. Zen 1 and 2 microcode pdep/pext, so only build
+// for BMI2 when targeting newer cpus.
+[[nodiscard]] inline uint64_t
+morton_encode_2d(uint32_t x, uint32_t y)
+{
+#ifdef FIGHTINGENGINE_BMI2
+  return _pdep_u64(x, 0x5555555555555555ull) | _pdep_u64(y, 0xAAAAAAAAAAAAAAAAull);
+#else
+  auto spread = [](uint64_t v) {
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+  };
+  return spread(x) | (spread(y) << 1);
+#endif
+}
+
+inline void
+morton_decode_2d(uint64_t code, uint32_t& x, uint32_t& y)
+{
+#ifdef FIGHTINGENGINE_BMI2
+  x = static_cast<uint32_t>(_pext_u64(code, 0x5555555555555555ull));
+  y = static_cast<uint32_t>(_pext_u64(code, 0xAAAAAAAAAAAAAAAAull));
+#else
+  auto compact = [](uint64_t v) {
+    v &= 0x5555555555555555ull;
+    v = (v | (v >> 1)) & 0x3333333333333333ull;
+    v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v >> 4)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v >> 8)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+    return static_cast<uint32_t>(v);
+  };
+  x = compact(code);
+  y = compact(code >> 1);
+#endif
+}
 
-[[nodiscard]] void
-decode_cantor_pairing_function(uint64_t p, uint32_t& x, uint32_t& y);
+// the morton code of a grid cell, signed cells keep their order (-1 sorts before 0)
+[[nodiscard]] inline uint64_t
+morton_encode_2d(glm::ivec2 cell)
+{
+  return morton_encode_2d(static_cast<uint32_t>(cell.x) ^ 0x80000000u, static_cast<uint32_t>(cell.y) ^ 0x80000000u);
+}
+
+// A unique key for an unordered pair of non-negative ints, (x, y) and (y, x) give the same key.
+// Despite the name it's the morton code of the sorted pair, not Cantor's pairing function.
+[[nodiscard]] inline uint64_t
+encode_cantor_pairing_function(int x, int y)
+{
+  if (y < x)
+    std::swap(x, y);
+  return morton_encode_2d(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+}
+
+// x is the smaller of the pair
+inline void
+decode_cantor_pairing_function(uint64_t p, uint32_t& x, uint32_t& y)
+{
+  morton_decode_2d(p, x, y);
+}
 
 // scale x from [min,max] to [a,b]
 [[nodiscard]] float
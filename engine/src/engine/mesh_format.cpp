@@ -0,0 +1,331 @@
+// header
+#include "engine/mesh_format.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace fightingengine {
+
+namespace mesh_format {
+
+static uint32_t
+align_16(uint32_t offset)
+{
+  return (offset + 15u) & ~15u;
+}
+
+Bounds
+compute_bounds(const Vertex* vertices, size_t count)
+{
+  Bounds bounds;
+  for (size_t i = 0; i < count; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      float p = vertices[i].position[axis];
+      bounds.min[axis] = i == 0 ? p : std::min(bounds.min[axis], p);
+      bounds.max[axis] = i == 0 ? p : std::max(bounds.max[axis], p);
+    }
+  }
+  return bounds;
+}
+
+//
+// Quantization
+//
+
+uint16_t
+float_to_half(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000u;
+  const uint32_t float_exponent = (bits >> 23) & 0xffu;
+  uint32_t mantissa = bits & 0x7fffffu;
+
+  if (float_exponent == 0xffu) // inf, nan
+    return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+
+  const int32_t exponent = static_cast<int32_t>(float_exponent) - 127 + 15;
+  if (exponent >= 31) // too big, inf
+    return static_cast<uint16_t>(sign | 0x7c00u);
+
+  if (exponent <= 0) { // subnormal half, or zero
+    if (exponent < -10)
+      return static_cast<uint16_t>(sign);
+    mantissa |= 0x800000u;
+    const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+    uint32_t half = mantissa >> shift;
+    if ((mantissa >> (shift - 1)) & 1u) // round to nearest
+      half += 1;
+    return static_cast<uint16_t>(sign | half);
+  }
+
+  uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+  if (mantissa & 0x1000u) // round to nearest, a carry in to the exponent is still correct
+    half += 1;
+  return static_cast<uint16_t>(half);
+}
+
+float
+half_to_float(uint16_t value)
+{
+  const uint32_t sign = (value & 0x8000u) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1fu;
+  const uint32_t mantissa = value & 0x3ffu;
+
+  if (exponent == 0) {
+    float subnormal = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign != 0 ? -subnormal : subnormal;
+  }
+
+  uint32_t bits;
+  if (exponent == 31)
+    bits = sign | 0x7f800000u | (mantissa << 13);
+  else
+    bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static int16_t
+to_snorm16(float value)
+{
+  value = std::max(-1.0f, std::min(1.0f, value));
+  return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+static float
+from_snorm16(int16_t value)
+{
+  return std::max(-1.0f, static_cast<float>(value) / 32767.0f);
+}
+
+void
+encode_octahedral(const float normal[3], int16_t encoded[2])
+{
+  const float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+  if (length == 0.0f) {
+    encoded[0] = encoded[1] = 0;
+    return;
+  }
+
+  // project on to the octahedron, then fold the lower half over the upper
+  float x = normal[0] / length;
+  float y = normal[1] / length;
+  if (normal[2] < 0.0f) {
+    const float folded_x = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+    const float folded_y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    x = folded_x;
+    y = folded_y;
+  }
+  encoded[0] = to_snorm16(x);
+  encoded[1] = to_snorm16(y);
+}
+
+void
+decode_octahedral(const int16_t encoded[2], float normal[3])
+{
+  // same as decode_octahedral() in lit.vert
+  float x = from_snorm16(encoded[0]);
+  float y = from_snorm16(encoded[1]);
+  float z = 1.0f - std::fabs(x) - std::fabs(y);
+  const float t = std::max(-z, 0.0f);
+  x += x >= 0.0f ? -t : t;
+  y += y >= 0.0f ? -t : t;
+
+  const float length = std::sqrt(x * x + y * y + z * z);
+  normal[0] = x / length;
+  normal[1] = y / length;
+  normal[2] = z / length;
+}
+
+void
+get_position_decode(const Bounds& bounds, float offset[3], float scale[3])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    offset[axis] = (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+    // flat axes still need a non zero scale to divide by
+    scale[axis] = std::max((bounds.max[axis] - bounds.min[axis]) * 0.5f, 1e-6f);
+  }
+}
+
+QuantizedVertex
+quantize_vertex(const Vertex& vertex, const Bounds& bounds)
+{
+  float offset[3];
+  float scale[3];
+  get_position_decode(bounds, offset, scale);
+
+  QuantizedVertex quantized;
+  for (int axis = 0; axis < 3; axis++)
+    quantized.position[axis] = to_snorm16((vertex.position[axis] - offset[axis]) / scale[axis]);
+  quantized.position[3] = 0;
+  encode_octahedral(vertex.normal, quantized.normal);
+  quantized.tex_coords[0] = float_to_half(vertex.tex_coords[0]);
+  quantized.tex_coords[1] = float_to_half(vertex.tex_coords[1]);
+  return quantized;
+}
+
+Vertex
+dequantize_vertex(const QuantizedVertex& vertex, const Bounds& bounds)
+{
+  float offset[3];
+  float scale[3];
+  get_position_decode(bounds, offset, scale);
+
+  Vertex result;
+  for (int axis = 0; axis < 3; axis++)
+    result.position[axis] = offset[axis] + scale[axis] * from_snorm16(vertex.position[axis]);
+  decode_octahedral(vertex.normal, result.normal);
+  result.tex_coords[0] = half_to_float(vertex.tex_coords[0]);
+  result.tex_coords[1] = half_to_float(vertex.tex_coords[1]);
+  return result;
+}
+
+bool
+fits_16bit_indices(const std::vector<Submesh>& submeshes)
+{
+  for (const Submesh& submesh : submeshes) {
+    if (submesh.vertex_count > 65536)
+      return false;
+  }
+  return true;
+}
+
+//
+// Files
+//
+
+bool
+write(const std::string& path, const MeshData& mesh)
+{
+  const bool quantized = mesh.layout == VertexLayout::Quantized;
+  const bool short_indices = quantized && fits_16bit_indices(mesh.submeshes);
+
+  Header header;
+  std::memcpy(header.magic, magic, 4);
+  header.version = version;
+  header.vertex_stride = quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+  header.vertex_count = static_cast<uint32_t>(mesh.vertices.size());
+  header.index_count = static_cast<uint32_t>(mesh.indices.size());
+  header.submesh_count = static_cast<uint32_t>(mesh.submeshes.size());
+  header.vertex_layout = mesh.layout;
+  header.index_size = short_indices ? 2 : 4;
+  header.vertex_offset = align_16(sizeof(Header));
+  header.index_offset = align_16(header.vertex_offset + header.vertex_count * header.vertex_stride);
+  header.submesh_offset = align_16(header.index_offset + header.index_count * header.index_size);
+  header.bounds = mesh.bounds;
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "mesh: could not write " << path << std::endl;
+    return false;
+  }
+
+  const char padding[16] = {};
+  auto pad_to = [&](uint32_t offset) {
+    size_t at = static_cast<size_t>(out.tellp());
+    out.write(padding, offset - at);
+  };
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  pad_to(header.vertex_offset);
+  if (quantized) {
+    std::vector<QuantizedVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (const Vertex& vertex : mesh.vertices)
+      vertices.push_back(quantize_vertex(vertex, mesh.bounds));
+    out.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(QuantizedVertex));
+  } else {
+    out.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+  }
+  pad_to(header.index_offset);
+  if (short_indices) {
+    std::vector<uint16_t> indices(mesh.indices.begin(), mesh.indices.end());
+    out.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint16_t));
+  } else {
+    out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+  }
+  pad_to(header.submesh_offset);
+  out.write(reinterpret_cast<const char*>(mesh.submeshes.data()), mesh.submeshes.size() * sizeof(Submesh));
+
+  return out.good();
+}
+
+bool
+parse(const uint8_t* data, size_t size, MeshView& view)
+{
+  if (data == nullptr || size < sizeof(Header))
+    return false;
+
+  const Header* header = reinterpret_cast<const Header*>(data);
+  if (std::memcmp(header->magic, magic, 4) != 0 || header->version != version) {
+    std::cerr << "mesh: not a v" << version << " mesh file" << std::endl;
+    return false;
+  }
+
+  const bool quantized = header->vertex_layout == VertexLayout::Quantized;
+  if ((header->vertex_layout != VertexLayout::Float && !quantized) ||
+      header->vertex_stride != (quantized ? sizeof(QuantizedVertex) : sizeof(Vertex)) ||
+      (header->index_size != 2 && header->index_size != 4)) {
+    std::cerr << "mesh: unknown vertex layout or index size" << std::endl;
+    return false;
+  }
+
+  auto fits = [size](uint64_t offset, uint64_t bytes) { return offset % 4 == 0 && offset + bytes <= size; };
+  if (!fits(header->vertex_offset, uint64_t(header->vertex_count) * header->vertex_stride) ||
+      !fits(header->index_offset, uint64_t(header->index_count) * header->index_size) ||
+      !fits(header->submesh_offset, uint64_t(header->submesh_count) * sizeof(Submesh))) {
+    std::cerr << "mesh: file is truncated" << std::endl;
+    return false;
+  }
+
+  view.header = header;
+  view.vertex_data = data + header->vertex_offset;
+  view.index_data = data + header->index_offset;
+  view.submeshes = reinterpret_cast<const Submesh*>(data + header->submesh_offset);
+
+  for (uint32_t i = 0; i < header->submesh_count; i++) {
+    const Submesh& submesh = view.submeshes[i];
+    if (uint64_t(submesh.first_index) + submesh.index_count > header->index_count ||
+        uint64_t(submesh.base_vertex) + submesh.vertex_count > header->vertex_count) {
+      std::cerr << "mesh: submesh " << i << " is out of range" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<uint8_t>
+convert_vertices(const MeshView& view, VertexLayout layout)
+{
+  const Header& header = *view.header;
+  if (header.vertex_layout == layout)
+    return std::vector<uint8_t>(view.vertex_data, view.vertex_data + header.vertex_count * header.vertex_stride);
+
+  std::vector<uint8_t> result;
+  if (layout == VertexLayout::Quantized) {
+    result.resize(header.vertex_count * sizeof(QuantizedVertex));
+    const Vertex* in = reinterpret_cast<const Vertex*>(view.vertex_data);
+    QuantizedVertex* out = reinterpret_cast<QuantizedVertex*>(result.data());
+    for (uint32_t i = 0; i < header.vertex_count; i++)
+      out[i] = quantize_vertex(in[i], header.bounds);
+  } else {
+    result.resize(header.vertex_count * sizeof(Vertex));
+    const QuantizedVertex* in = reinterpret_cast<const QuantizedVertex*>(view.vertex_data);
+    Vertex* out = reinterpret_cast<Vertex*>(result.data());
+    for (uint32_t i = 0; i < header.vertex_count; i++)
+      out[i] = dequantize_vertex(in[i], header.bounds);
+  }
+  return result;
+}
+
+} // namespace mesh_format
+
+} // namespace fightingengine
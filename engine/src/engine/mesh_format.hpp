@@ -0,0 +1,155 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fightingengine {
+
+//
+// Baked mesh files (.mesh), written offline by tools/mesh_cooker.
+// The file is the gpu upload: one interleaved vertex blob, one index blob,
+// and a submesh table, so the runtime maps it and hands the blobs to GL.
+//
+// Layout (little endian, blobs 16 byte aligned)
+//
+// Header
+// Vertex or QuantizedVertex[vertex_count]  at vertex_offset
+// uint32_t or uint16_t[index_count]         at index_offset, relative to the submesh's base_vertex
+// Submesh[submesh_count]                    at submesh_offset
+//
+
+namespace mesh_format {
+
+static const char magic[4] = { 'M', 'E', 'S', 'H' };
+static const uint32_t version = 2;
+
+enum class VertexLayout : uint16_t
+{
+  Float = 0,     // Vertex
+  Quantized = 1, // QuantizedVertex, decoded in the vertex shader
+};
+
+struct Bounds
+{
+  float min[3] = { 0.0f, 0.0f, 0.0f };
+  float max[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+struct Header
+{
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t vertex_stride = 0;
+  uint32_t vertex_count = 0;
+  uint32_t index_count = 0;
+  uint32_t submesh_count = 0;
+  uint32_t vertex_offset = 0; // bytes from the start of the file
+  uint32_t index_offset = 0;
+  uint32_t submesh_offset = 0;
+  VertexLayout vertex_layout = VertexLayout::Float;
+  uint16_t index_size = 4; // bytes, 2 when every submesh has <= 65536 vertices
+  Bounds bounds;
+};
+static_assert(sizeof(Header) == 64, "mesh header layout changed, bump the version");
+
+struct Submesh
+{
+  uint32_t first_index = 0;
+  uint32_t index_count = 0;
+  uint32_t base_vertex = 0;
+  uint32_t vertex_count = 0;
+  uint32_t material = 0;
+  Bounds bounds;
+};
+static_assert(sizeof(Submesh) == 44, "mesh submesh layout changed, bump the version");
+
+// same layout as fightingengine::Vertex (mesh.hpp)
+struct Vertex
+{
+  float position[3];
+  float normal[3];
+  float tex_coords[2];
+};
+static_assert(sizeof(Vertex) == 32, "mesh vertex layout changed, bump the version");
+
+// position: snorm16 within the mesh bounds (w is unused), see get_position_decode()
+// normal: snorm16 octahedral encoded
+// tex_coords: half floats
+struct QuantizedVertex
+{
+  int16_t position[4];
+  int16_t normal[2];
+  uint16_t tex_coords[2];
+};
+static_assert(sizeof(QuantizedVertex) == 16, "mesh vertex layout changed, bump the version");
+
+struct MeshData
+{
+  std::vector<Vertex> vertices; // full precision, write() quantizes them for VertexLayout::Quantized
+  std::vector<uint32_t> indices;
+  std::vector<Submesh> submeshes;
+  Bounds bounds;
+  VertexLayout layout = VertexLayout::Float;
+};
+
+// pointers in to a file's bytes, valid while the bytes are.
+// vertex_data and index_data are in the header's vertex_layout and index_size.
+struct MeshView
+{
+  const Header* header = nullptr;
+  const uint8_t* vertex_data = nullptr;
+  const uint8_t* index_data = nullptr;
+  const Submesh* submeshes = nullptr;
+};
+
+[[nodiscard]] Bounds
+compute_bounds(const Vertex* vertices, size_t count);
+
+//
+// Quantization
+//
+
+[[nodiscard]] uint16_t
+float_to_half(float value);
+
+[[nodiscard]] float
+half_to_float(uint16_t value);
+
+void
+encode_octahedral(const float normal[3], int16_t encoded[2]);
+
+void
+decode_octahedral(const int16_t encoded[2], float normal[3]);
+
+// position = offset + scale * snorm position
+void
+get_position_decode(const Bounds& bounds, float offset[3], float scale[3]);
+
+[[nodiscard]] QuantizedVertex
+quantize_vertex(const Vertex& vertex, const Bounds& bounds);
+
+[[nodiscard]] Vertex
+dequantize_vertex(const QuantizedVertex& vertex, const Bounds& bounds);
+
+// true if every submesh's indices fit in 16 bits
+[[nodiscard]] bool
+fits_16bit_indices(const std::vector<Submesh>& submeshes);
+
+[[nodiscard]] bool
+write(const std::string& path, const MeshData& mesh);
+
+// checks the header, and that every blob is inside the file
+[[nodiscard]] bool
+parse(const uint8_t* data, size_t size, MeshView& view);
+
+// the view's vertices in another layout, for a file cooked with a different one than the renderer wants.
+// positions are quantized within the header's bounds.
+[[nodiscard]] std::vector<uint8_t>
+convert_vertices(const MeshView& view, VertexLayout layout);
+
+} // namespace mesh_format
+
+} // namespace fightingengine
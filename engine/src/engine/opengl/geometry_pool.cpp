@@ -0,0 +1,180 @@
+// header
+#include "engine/opengl/geometry_pool.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <memory>
+
+// other library headers
+#include <GL/glew.h>
+
+namespace fightingengine {
+
+static const uint32_t min_pool_vertices = 1 << 16;
+static const uint32_t min_pool_indices = 1 << 18;
+
+// [layout][index size == 4]
+static std::unique_ptr<GeometryPool> s_pools[2][2];
+
+// scratch for draw_geometry(), kept to avoid allocating per draw
+static std::vector<GLsizei> s_counts;
+static std::vector<void*> s_offsets;
+static std::vector<GLint> s_base_vertices;
+
+static void
+grow_buffer(unsigned int& buffer, size_t used_bytes, size_t new_bytes)
+{
+  unsigned int grown = 0;
+  glGenBuffers(1, &grown);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+  glBufferData(GL_COPY_WRITE_BUFFER, new_bytes, nullptr, GL_STATIC_DRAW);
+
+  if (buffer != 0) {
+    if (used_bytes > 0) {
+      glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used_bytes);
+      glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  buffer = grown;
+}
+
+static void
+reserve_geometry(GeometryPool& pool, uint32_t vertex_count, uint32_t index_count)
+{
+  bool rebind = false;
+
+  if (pool.vertex_count + vertex_count > pool.vertex_capacity) {
+    uint32_t capacity = std::max({ min_pool_vertices, pool.vertex_capacity * 2, pool.vertex_count + vertex_count });
+    grow_buffer(pool.vbo, size_t(pool.vertex_count) * pool.vertex_stride, size_t(capacity) * pool.vertex_stride);
+    pool.vertex_capacity = capacity;
+    rebind = true;
+  }
+  if (pool.index_count + index_count > pool.index_capacity) {
+    uint32_t capacity = std::max({ min_pool_indices, pool.index_capacity * 2, pool.index_count + index_count });
+    grow_buffer(pool.ebo, size_t(pool.index_count) * pool.index_size, size_t(capacity) * pool.index_size);
+    pool.index_capacity = capacity;
+    rebind = true;
+  }
+
+  // the vao still points at the old buffers
+  if (rebind) {
+    glBindVertexArray(pool.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+    set_vertex_layout_attributes(pool.layout);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.ebo);
+    glBindVertexArray(0);
+  }
+}
+
+GeometryPool&
+get_geometry_pool(VertexLayout layout, uint32_t index_size)
+{
+  const bool quantized = layout == VertexLayout::Quantized;
+  std::unique_ptr<GeometryPool>& pool = s_pools[quantized ? 1 : 0][index_size == 4 ? 1 : 0];
+
+  if (!pool) {
+    pool = std::make_unique<GeometryPool>();
+    pool->layout = layout;
+    pool->vertex_stride = quantized ? sizeof(mesh_format::QuantizedVertex) : sizeof(mesh_format::Vertex);
+    pool->index_size = index_size;
+    glGenVertexArrays(1, &pool->vao);
+  }
+  return *pool;
+}
+
+void
+add_geometry(GeometryPool& pool,
+             const void* vertices,
+             uint32_t vertex_count,
+             const void* indices,
+             uint32_t index_count,
+             uint32_t& base_vertex,
+             uint32_t& first_index)
+{
+  reserve_geometry(pool, vertex_count, index_count);
+
+  base_vertex = pool.vertex_count;
+  first_index = pool.index_count;
+
+  glBindVertexArray(pool.vao);
+  glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+  glBufferSubData(
+    GL_ARRAY_BUFFER, size_t(base_vertex) * pool.vertex_stride, size_t(vertex_count) * pool.vertex_stride, vertices);
+  glBufferSubData(
+    GL_ELEMENT_ARRAY_BUFFER, size_t(first_index) * pool.index_size, size_t(index_count) * pool.index_size, indices);
+  glBindVertexArray(0);
+
+  pool.vertex_count += vertex_count;
+  pool.index_count += index_count;
+}
+
+void
+draw_geometry(const GeometryPool& pool, const std::vector<mesh_format::Submesh>& submeshes)
+{
+  if (submeshes.empty())
+    return;
+
+  s_counts.clear();
+  s_offsets.clear();
+  s_base_vertices.clear();
+  for (const mesh_format::Submesh& submesh : submeshes) {
+    s_counts.push_back(static_cast<GLsizei>(submesh.index_count));
+    s_offsets.push_back((void*)(uintptr_t(submesh.first_index) * pool.index_size));
+    s_base_vertices.push_back(static_cast<GLint>(submesh.base_vertex));
+  }
+
+  glBindVertexArray(pool.vao);
+  glMultiDrawElementsBaseVertex(GL_TRIANGLES,
+                                s_counts.data(),
+                                pool.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                                s_offsets.data(),
+                                static_cast<GLsizei>(submeshes.size()),
+                                s_base_vertices.data());
+  glBindVertexArray(0);
+}
+
+void
+draw_geometry_instanced(GeometryPool& pool,
+                        const std::vector<mesh_format::Submesh>& submeshes,
+                        const std::vector<glm::mat4>& instances)
+{
+  if (submeshes.empty() || instances.empty())
+    return;
+
+  glBindVertexArray(pool.vao);
+  if (pool.instances.vbo == 0)
+    attach_instance_buffer(pool.instances);
+  upload_instances(pool.instances, instances);
+
+  const GLenum index_type = pool.index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  for (const mesh_format::Submesh& submesh : submeshes) {
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                      static_cast<GLsizei>(submesh.index_count),
+                                      index_type,
+                                      (void*)(uintptr_t(submesh.first_index) * pool.index_size),
+                                      static_cast<GLsizei>(instances.size()),
+                                      static_cast<GLint>(submesh.base_vertex));
+  }
+  glBindVertexArray(0);
+}
+
+void
+shutdown_geometry_pools()
+{
+  for (auto& pools : s_pools) {
+    for (std::unique_ptr<GeometryPool>& pool : pools) {
+      if (!pool)
+        continue;
+      glDeleteBuffers(1, &pool->vbo);
+      glDeleteBuffers(1, &pool->ebo);
+      glDeleteBuffers(1, &pool->instances.vbo);
+      glDeleteVertexArrays(1, &pool->vao);
+      pool.reset();
+    }
+  }
+}
+
+} // namespace fightingengine
@@ -0,0 +1,66 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <vector>
+
+// your project headers
+#include "engine/mesh_format.hpp"
+#include "engine/opengl/mesh.hpp"
+
+namespace fightingengine {
+
+//
+// Shared vertex and index buffers for static geometry.
+// Meshes are appended and addressed by base vertex + first index,
+// so a whole model (or many models) draws with one vao bind and one
+// glMultiDrawElementsBaseVertex() call.
+//
+
+struct GeometryPool
+{
+  unsigned int vao = 0;
+  unsigned int vbo = 0;
+  unsigned int ebo = 0;
+
+  VertexLayout layout = VertexLayout::Float;
+  uint32_t vertex_stride = 0;
+  uint32_t index_size = 0; // bytes, 2 or 4
+
+  uint32_t vertex_capacity = 0;
+  uint32_t index_capacity = 0;
+  uint32_t vertex_count = 0;
+  uint32_t index_count = 0;
+
+  InstanceBuffer instances; // created on the first instanced draw
+};
+
+// one pool per vertex layout and index size, created on first use
+[[nodiscard]] GeometryPool&
+get_geometry_pool(VertexLayout layout, uint32_t index_size);
+
+// appends the vertices (in the pool's layout) and indices (of the pool's index size),
+// growing the buffers if needed. indices stay relative to base_vertex.
+void
+add_geometry(GeometryPool& pool,
+             const void* vertices,
+             uint32_t vertex_count,
+             const void* indices,
+             uint32_t index_count,
+             uint32_t& base_vertex,
+             uint32_t& first_index);
+
+// one submission for every submesh
+void
+draw_geometry(const GeometryPool& pool, const std::vector<mesh_format::Submesh>& submeshes);
+
+// one instanced draw per submesh (GL 3.3 has no instanced multi draw)
+void
+draw_geometry_instanced(GeometryPool& pool,
+                        const std::vector<mesh_format::Submesh>& submeshes,
+                        const std::vector<glm::mat4>& instances);
+
+void
+shutdown_geometry_pools();
+
+} // namespace fightingengine
@@ -3,6 +3,7 @@
 #include "engine/opengl/mesh.hpp"
 
 // c++ libs
+#include <algorithm>
 #include <iostream>
 
 // other library headers
@@ -60,10 +61,78 @@ static unsigned short indexPlane[6]
 };
 // clang-format on
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+static_assert(sizeof(Vertex) == sizeof(mesh_format::Vertex), "mesh_format::Vertex mirrors Vertex");
+
+void
+set_vertex_layout_attributes(VertexLayout layout)
+{
+  if (layout == VertexLayout::Quantized) {
+    using mesh_format::QuantizedVertex;
+    const GLsizei stride = sizeof(QuantizedVertex);
+    // vertex positions, snorm16 in the mesh bounds
+    glVertexAttribPointer(0, 4, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, position));
+    glEnableVertexAttribArray(0);
+    // vertex normals, snorm16 octahedral
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, normal));
+    glEnableVertexAttribArray(1);
+    // vertex texture coords, half floats
+    glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(QuantizedVertex, tex_coords));
+    glEnableVertexAttribArray(2);
+    return;
+  }
+
+  // vertex positions
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+  glEnableVertexAttribArray(0);
+  // vertex normals
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+  glEnableVertexAttribArray(1);
+  // vertex texture coords
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tex_coords));
+  glEnableVertexAttribArray(2);
+}
+
+void
+set_position_decode_uniforms(Shader& shader, const mesh_format::Bounds& bounds)
+{
+  float offset[3];
+  float scale[3];
+  mesh_format::get_position_decode(bounds, offset, scale);
+  shader.set_vec3("position_offset", offset[0], offset[1], offset[2]);
+  shader.set_vec3("position_scale", scale[0], scale[1], scale[2]);
+}
+
+void
+attach_instance_buffer(InstanceBuffer& buffer)
+{
+  glGenBuffers(1, &buffer.vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+
+  // a mat4 is 4 vec4 attributes
+  for (unsigned int column = 0; column < 4; column++) {
+    const unsigned int location = 3 + column;
+    glVertexAttribPointer(
+      location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4) * column));
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, 1);
+  }
+}
+
+void
+upload_instances(InstanceBuffer& buffer, const std::vector<glm::mat4>& instances)
+{
+  glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+  if (instances.size() > buffer.capacity)
+    buffer.capacity = std::max(instances.size(), buffer.capacity * 2);
+  glBufferData(GL_ARRAY_BUFFER, buffer.capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(glm::mat4), instances.data());
+}
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, VertexLayout layout)
 {
   this->verts = vertices;
   this->indices = indices;
+  this->layout = layout;
 
   setup_mesh();
 }
@@ -79,20 +148,34 @@ Mesh::setup_mesh()
   glBindVertexArray(vao);
   // load data into vertex buffers
   glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), &verts[0], GL_STATIC_DRAW);
-
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
 
-  // vertex positions
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-  glEnableVertexAttribArray(0);
-  // vertex normals
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-  glEnableVertexAttribArray(1);
-  // vertex texture coords
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, tex_coords));
-  glEnableVertexAttribArray(2);
+  const mesh_format::Vertex* source = reinterpret_cast<const mesh_format::Vertex*>(verts.data());
+
+  if (layout == VertexLayout::Quantized) {
+    bounds = mesh_format::compute_bounds(source, verts.size());
+
+    std::vector<mesh_format::QuantizedVertex> quantized;
+    quantized.reserve(verts.size());
+    for (size_t i = 0; i < verts.size(); i++)
+      quantized.push_back(mesh_format::quantize_vertex(source[i], bounds));
+    glBufferData(GL_ARRAY_BUFFER, quantized.size() * sizeof(quantized[0]), quantized.data(), GL_STATIC_DRAW);
+  } else {
+    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(Vertex), &verts[0], GL_STATIC_DRAW);
+  }
+
+  // 16 bit indices when every vertex can be reached with them
+  if (layout == VertexLayout::Quantized && verts.size() <= 65536) {
+    std::vector<uint16_t> short_indices(indices.begin(), indices.end());
+    index_type = GL_UNSIGNED_SHORT;
+    glBufferData(
+      GL_ELEMENT_ARRAY_BUFFER, short_indices.size() * sizeof(uint16_t), short_indices.data(), GL_STATIC_DRAW);
+  } else {
+    index_type = GL_UNSIGNED_INT;
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+  }
+
+  set_vertex_layout_attributes(layout);
 
   // unbind
   glBindVertexArray(0);
@@ -101,11 +184,62 @@ Mesh::setup_mesh()
 void
 Mesh::draw(Shader& shader)
 {
+  if (layout == VertexLayout::Quantized)
+    set_position_decode_uniforms(shader, bounds);
+
   // bind vao
   glBindVertexArray(vao);
-  glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+  glDrawElements(GL_TRIANGLES, indices.size(), index_type, 0);
   glBindVertexArray(0);
   glActiveTexture(GL_TEXTURE0);
 }
 
+void
+Mesh::draw_instanced(Shader& shader, const std::vector<glm::mat4>& instances)
+{
+  if (instances.empty())
+    return;
+
+  if (layout == VertexLayout::Quantized)
+    set_position_decode_uniforms(shader, bounds);
+
+  glBindVertexArray(vao);
+  if (instance_buffer.vbo == 0)
+    attach_instance_buffer(instance_buffer);
+  upload_instances(instance_buffer, instances);
+  glDrawElementsInstanced(GL_TRIANGLES, indices.size(), index_type, 0, static_cast<GLsizei>(instances.size()));
+  glBindVertexArray(0);
+}
+
+Mesh
+create_cube_mesh(VertexLayout layout)
+{
+  // a face per axis direction, 4 vertices each so the normals stay flat
+  const glm::vec3 normals[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  vertices.reserve(24);
+  indices.reserve(36);
+
+  for (const glm::vec3& normal : normals) {
+    // two axes spanning the face, ordered so the face winds counter clockwise seen from outside
+    const glm::vec3 u = glm::vec3(normal.y, normal.z, normal.x);
+    const glm::vec3 v = glm::cross(normal, u);
+
+    const unsigned int first = static_cast<unsigned int>(vertices.size());
+    const glm::vec2 corners[4] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+    for (const glm::vec2& corner : corners) {
+      Vertex vertex;
+      vertex.position = normal + u * corner.x + v * corner.y;
+      vertex.normal = normal;
+      vertex.tex_coords = (corner + glm::vec2(1.0f)) * 0.5f;
+      vertices.push_back(vertex);
+    }
+    indices.insert(indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+  }
+
+  return Mesh(vertices, indices, layout);
+}
+
 } // namespace fightingengine
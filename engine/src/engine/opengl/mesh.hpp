@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 
+#include "engine/mesh_format.hpp"
 #include "engine/opengl/shader.hpp"
 #include "engine/opengl/texture.hpp"
 
@@ -27,6 +28,32 @@ struct Vertex
   glm::vec2 tex_coords = glm::vec2(0.0, 0.0);
 };
 
+using mesh_format::VertexLayout;
+
+// attributes 0 - 2 for the bound vao and array buffer.
+// VertexLayout::Quantized needs a shader built with QUANTIZED_VERTICES.
+void
+set_vertex_layout_attributes(VertexLayout layout);
+
+// the position_offset and position_scale uniforms quantized positions are decoded with
+void
+set_position_decode_uniforms(Shader& shader, const mesh_format::Bounds& bounds);
+
+// per instance model matrices, read by shaders built with INSTANCED
+struct InstanceBuffer
+{
+  unsigned int vbo = 0;
+  size_t capacity = 0; // instances
+};
+
+// creates the buffer, and points attributes 3 - 6 (one mat4 per instance) of the bound vao at it
+void
+attach_instance_buffer(InstanceBuffer& buffer);
+
+// orphans the old contents, so it's safe to upload again while earlier draws are in flight
+void
+upload_instances(InstanceBuffer& buffer, const std::vector<glm::mat4>& instances);
+
 class Mesh
 {
 public:
@@ -34,15 +61,25 @@ public:
   std::vector<unsigned int> indices;
 
 public:
-  Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+  Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, VertexLayout layout = VertexLayout::Float);
 
   void draw(Shader& shader);
+  // one draw call for every instance
+  void draw_instanced(Shader& shader, const std::vector<glm::mat4>& instances);
 
 private:
   unsigned int vao, vbo, ebo = 0;
+  InstanceBuffer instance_buffer;
+  VertexLayout layout = VertexLayout::Float;
+  unsigned int index_type = 0; // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+  mesh_format::Bounds bounds;
 
   // commits all buffers and attributes to the GPU driver
   void setup_mesh();
 };
 
+// 2x2x2, centred on the origin
+[[nodiscard]] Mesh
+create_cube_mesh(VertexLayout layout = VertexLayout::Float);
+
 }
@@ -3,27 +3,135 @@
 #include "engine/opengl/model.hpp"
 
 // standard lib headers
+#include <filesystem> // C++17
 #include <iostream>
 #include <string>
+#include <vector>
 
 // other project libs
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
+#include <GL/glew.h>
 #include <stb_image.h>
 
+// your project libs
+#include "engine/mapped_file.hpp"
+
 namespace fightingengine {
 
-Model::Model(const std::string& full_path)
+Model::Model(const std::string& full_path, VertexLayout layout)
+  : layout(layout)
 {
+  namespace fs = std::filesystem;
+  fs::path path(full_path);
+
+  if (path.extension() == ".mesh") {
+    load_baked_model(full_path);
+    return;
+  }
+
+  // prefer a baked file (see tools/mesh_cooker) if it's newer than the source
+  fs::path baked = fs::path(path).replace_extension(".mesh");
+  std::error_code error;
+  if (fs::exists(baked, error) && fs::last_write_time(baked, error) >= fs::last_write_time(path, error)) {
+    if (load_baked_model(baked.string()))
+      return;
+  }
+
   load_model(full_path);
 }
 
 void
 Model::draw(Shader& shader)
 {
-  for (int i = 0; i < this->meshes.size(); i++)
-    this->meshes[i].draw(shader);
+  if (pool == nullptr)
+    return;
+
+  // quantized positions are relative to the whole model's bounds
+  if (layout == VertexLayout::Quantized)
+    set_position_decode_uniforms(shader, bounds);
+
+  draw_geometry(*pool, submeshes);
+}
+
+void
+Model::draw_instanced(Shader& shader, const std::vector<glm::mat4>& instances)
+{
+  if (pool == nullptr)
+    return;
+
+  if (layout == VertexLayout::Quantized)
+    set_position_decode_uniforms(shader, bounds);
+
+  draw_geometry_instanced(*pool, submeshes, instances);
+}
+
+void
+Model::add_to_pool(const void* vertices,
+                   uint32_t vertex_count,
+                   const void* indices,
+                   uint32_t index_count,
+                   uint32_t index_size,
+                   const std::vector<mesh_format::Submesh>& model_submeshes)
+{
+  pool = &get_geometry_pool(layout, index_size);
+
+  uint32_t base_vertex = 0;
+  uint32_t first_index = 0;
+  add_geometry(*pool, vertices, vertex_count, indices, index_count, base_vertex, first_index);
+
+  submeshes = model_submeshes;
+  for (mesh_format::Submesh& submesh : submeshes) {
+    submesh.base_vertex += base_vertex;
+    submesh.first_index += first_index;
+  }
+}
+
+bool
+Model::load_baked_model(const std::string& path)
+{
+  std::cout << "loading baked model: " << path << std::endl;
+
+  MappedFile file;
+  if (!map_file(path, file)) {
+    std::cerr << "Failed to map baked model: " << path << std::endl;
+    return false;
+  }
+
+  mesh_format::MeshView view;
+  if (!mesh_format::parse(file.data, file.size, view)) {
+    std::cerr << "Failed to load baked model: " << path << std::endl;
+    unmap_file(file);
+    return false;
+  }
+  const mesh_format::Header& header = *view.header;
+
+  // the shaders are built for the layout the caller asked for, a file cooked with the other one is converted.
+  // otherwise the blobs go straight from the mapping to the driver
+  std::vector<uint8_t> converted;
+  const uint8_t* vertex_data = view.vertex_data;
+  if (header.vertex_layout != layout) {
+    std::cout << "baked model " << path << " was cooked with another vertex layout, converting it. "
+              << "cook it with the layout the game uses to skip this" << std::endl;
+    converted = mesh_format::convert_vertices(view, layout);
+    vertex_data = converted.data();
+  }
+
+  bounds = header.bounds;
+  add_to_pool(vertex_data,
+              header.vertex_count,
+              view.index_data,
+              header.index_count,
+              header.index_size,
+              std::vector<mesh_format::Submesh>(view.submeshes, view.submeshes + header.submesh_count));
+  this->directory = path.substr(0, path.find_last_of('/'));
+
+  std::cout << "Loaded baked model with submeshes: " << header.submesh_count << ", vertices: " << header.vertex_count
+            << ", indices: " << header.index_count << std::endl;
+
+  unmap_file(file);
+  return true;
 }
 
 void
@@ -42,83 +150,52 @@ Model::load_model(const std::string& path)
   this->directory = path.substr(0, path.find_last_of('/'));
   std::cout << "loading model from directory: " << directory << std::endl;
 
-  process_node(scene->mRootNode, scene);
+  mesh_format::MeshData data;
+  process_node(scene->mRootNode, scene, data);
+  bounds = mesh_format::compute_bounds(data.vertices.data(), data.vertices.size());
+
+  if (layout == VertexLayout::Quantized) {
+    std::vector<mesh_format::QuantizedVertex> vertices;
+    vertices.reserve(data.vertices.size());
+    for (const mesh_format::Vertex& vertex : data.vertices)
+      vertices.push_back(mesh_format::quantize_vertex(vertex, bounds));
+
+    // indices are per submesh, so 16 bits covers any submesh up to 65536 vertices
+    if (mesh_format::fits_16bit_indices(data.submeshes)) {
+      std::vector<uint16_t> indices(data.indices.begin(), data.indices.end());
+      add_to_pool(vertices.data(), vertices.size(), indices.data(), indices.size(), 2, data.submeshes);
+      return;
+    }
+    add_to_pool(vertices.data(), vertices.size(), data.indices.data(), data.indices.size(), 4, data.submeshes);
+    return;
+  }
+
+  add_to_pool(data.vertices.data(), data.vertices.size(), data.indices.data(), data.indices.size(), 4, data.submeshes);
 }
 
 void
-Model::process_node(aiNode* node, const aiScene* scene)
+Model::process_node(aiNode* node, const aiScene* scene, mesh_format::MeshData& out)
 {
   // process all the node's meshes (if any)
   for (unsigned int i = 0; i < node->mNumMeshes; i++) {
     aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-    Mesh m = process_mesh(mesh, scene);
-    this->meshes.push_back(m);
+    process_mesh(mesh, scene, out);
   }
   // then do the same for each of its children
   for (unsigned int i = 0; i < node->mNumChildren; i++) {
-    process_node(node->mChildren[i], scene);
+    process_node(node->mChildren[i], scene, out);
   }
 }
 
-// struct VertexWithBoneData
-// {
-//   Vertex v; // pos, normal, tex_coords
-
-//   const int num_bones_per_vertex = 4;
-//   uint ids[num_bones_per_vertex];
-//   float weights[num_bones_per_vertex];
-// };
-
-Mesh
-Model::process_mesh(aiMesh* mesh, const aiScene* scene)
+void
+Model::process_mesh(aiMesh* mesh, const aiScene* scene, mesh_format::MeshData& out)
 {
   std::vector<Vertex> vertices;
   std::vector<unsigned int> indices;
+  vertices.reserve(mesh->mNumVertices);
+  indices.reserve(mesh->mNumFaces * 3); // triangulated
 
-  //
-  // TODO finish animations see: player_model.cc
-  // http://ogldev.atspace.co.uk/www/tutorial38/tutorial38.html
-  //
-
-  // each mesh contains aiBone[]
-  // each mesh contains aiVector3D vertices[]
-  // each aiBone contasn name, aiVertexWeight[], offsetMatrix
-  // each aiVertexWeight[] contains vertexID, weight
-
-  // each scene contains aiNodes
-  // each scene contains aiAnimation
-  // each aiAnimation contains duration, and ticker per  second
-  // each aiAnimation contains aiNodeAnim
-
-  // SEE: http://ogldev.atspace.co.uk/www/tutorial38/tutorial38.html
-  // The structure above contains everything we need at the vertex level. By default, we have enough storage for four
-  // bones (ID and weight per bone). VertexBoneData was structured like that to make it simple to pass it on to the
-  // shader. We already got position, texture coordinates and normal bound at locations 0, 1 and 2, respectively.
-
-  // SEE: player_model.cc line 335
-
-  aiMatrix4x4 inverse_transform = scene->mRootNode->mTransformation.Inverse();
-
-  // clang-format off
-  
-  std::cout << " mesh " << mesh->mName.C_Str()
-            << "\n (bones): " << std::to_string(mesh->mNumBones)
-            << "\n (animations): " << std::to_string(scene->mNumAnimations)
-            << std::endl;
-
-  if(scene->mNumAnimations > 0){
-    float anim_ticks_per_second = scene->mAnimations[0]->mTicksPerSecond;
-    float anim_time_in_seconds = 2.0f;
-    float anim_time_in_ticks = anim_time_in_seconds * anim_ticks_per_second;
-  }
-
-  // clang-format on
-
-  for (int i = 0; i < mesh->mNumBones; i++) {
-    aiBone* bone = mesh->mBones[i];
-    const std::string bone_name = bone->mName.C_Str();
-    std::cout << "found a bone!: " << bone_name << std::endl;
-  }
+  // bones and animations are ignored here, see SkinnedModel
 
   for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
     Vertex vertex;
@@ -171,7 +248,18 @@ Model::process_mesh(aiMesh* mesh, const aiScene* scene)
   // specular: texture_specularN
   // normal: texture_normalN
 
-  return Mesh(vertices, indices);
+  mesh_format::Submesh submesh;
+  submesh.first_index = static_cast<uint32_t>(out.indices.size());
+  submesh.index_count = static_cast<uint32_t>(indices.size());
+  submesh.base_vertex = static_cast<uint32_t>(out.vertices.size());
+  submesh.vertex_count = static_cast<uint32_t>(vertices.size());
+  submesh.material = mesh->mMaterialIndex;
+  const mesh_format::Vertex* mesh_vertices = reinterpret_cast<const mesh_format::Vertex*>(vertices.data());
+  submesh.bounds = mesh_format::compute_bounds(mesh_vertices, vertices.size());
+
+  out.vertices.insert(out.vertices.end(), mesh_vertices, mesh_vertices + vertices.size());
+  out.indices.insert(out.indices.end(), indices.begin(), indices.end());
+  out.submeshes.push_back(submesh);
 }
 
 } // namespace fightingengine
\ No newline at end of file
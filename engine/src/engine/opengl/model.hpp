@@ -6,6 +6,8 @@
 #include "assimp/scene.h"
 
 // your project libs
+#include "engine/mesh_format.hpp"
+#include "engine/opengl/geometry_pool.hpp"
 #include "engine/opengl/mesh.hpp"
 #include "engine/opengl/shader.hpp"
 
@@ -23,18 +25,39 @@ namespace fightingengine {
 class Model
 {
 public:
-  Model(const std::string& full_path);
+  // loads a baked .mesh file if given one, or if there's an up to date one next to the source.
+  // the model is always in layout, baked files cooked with the other layout are converted on load.
+  // the geometry goes in to the shared GeometryPool for its layout.
+  Model(const std::string& full_path, VertexLayout layout = VertexLayout::Float);
 
+  // every submesh in one multi draw
   void draw(Shader& shader);
+  // every instance of a submesh in one draw, the shader needs INSTANCED defined
+  void draw_instanced(Shader& shader, const std::vector<glm::mat4>& instances);
+
+  // the shader needs QUANTIZED_VERTICES defined for VertexLayout::Quantized
+  [[nodiscard]] VertexLayout get_layout() const { return layout; };
 
 private:
-  std::vector<Mesh> meshes;
   std::string directory;
+  VertexLayout layout = VertexLayout::Float;
+
+  GeometryPool* pool = nullptr;
+  std::vector<mesh_format::Submesh> submeshes; // base vertex and first index are in the pool
+  mesh_format::Bounds bounds;
 
 private:
+  bool load_baked_model(const std::string& path);
   void load_model(const std::string& path);
-  void process_node(aiNode* node, const aiScene* scene);
-  Mesh process_mesh(aiMesh* mesh, const aiScene* scene);
+  void process_node(aiNode* node, const aiScene* scene, mesh_format::MeshData& out);
+  void process_mesh(aiMesh* mesh, const aiScene* scene, mesh_format::MeshData& out);
+  // vertices and indices are in the pool's layout and index size
+  void add_to_pool(const void* vertices,
+                   uint32_t vertex_count,
+                   const void* indices,
+                   uint32_t index_count,
+                   uint32_t index_size,
+                   const std::vector<mesh_format::Submesh>& model_submeshes);
 };
 
 } // namespace fightingengine
\ No newline at end of file
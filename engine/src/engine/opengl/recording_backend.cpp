@@ -0,0 +1,244 @@
+// header
+#include "engine/opengl/recording_backend.hpp"
+
+namespace fightingengine {
+
+void
+RecordingRenderBackend::reset()
+{
+  stats = RecordedStats();
+  commands.clear();
+}
+
+void
+RecordingRenderBackend::record(RecordedCommandType type, unsigned int id, size_t size)
+{
+  if (!record_commands)
+    return;
+  RecordedCommand command;
+  command.type = type;
+  command.id = id;
+  command.size = size;
+  commands.push_back(command);
+}
+
+void
+RecordingRenderBackend::set_viewport(int x, int y, int width, int height)
+{
+  stats.state_sets += 1;
+  record(RecordedCommandType::SetViewport);
+}
+
+void
+RecordingRenderBackend::set_clear_colour(const glm::vec4& colour)
+{
+  stats.state_sets += 1;
+  record(RecordedCommandType::SetClearColour);
+}
+
+void
+RecordingRenderBackend::clear(unsigned int mask)
+{
+  record(RecordedCommandType::Clear, mask);
+}
+
+void
+RecordingRenderBackend::set_enabled(unsigned int cap, bool enabled)
+{
+  stats.state_sets += 1;
+  record(RecordedCommandType::SetEnabled, cap, enabled ? 1 : 0);
+}
+
+void
+RecordingRenderBackend::set_blend_func(unsigned int src_rgb, unsigned int dst_rgb, unsigned int src_a, unsigned int dst_a)
+{
+  stats.state_sets += 1;
+  record(RecordedCommandType::SetBlendFunc, dst_rgb);
+}
+
+void
+RecordingRenderBackend::set_depth_func(unsigned int func)
+{
+  stats.state_sets += 1;
+  record(RecordedCommandType::SetDepthFunc, func);
+}
+
+unsigned int
+RecordingRenderBackend::create_vertex_array()
+{
+  unsigned int id = next_id++;
+  record(RecordedCommandType::CreateVertexArray, id);
+  return id;
+}
+
+unsigned int
+RecordingRenderBackend::create_buffer()
+{
+  unsigned int id = next_id++;
+  record(RecordedCommandType::CreateBuffer, id);
+  return id;
+}
+
+void
+RecordingRenderBackend::delete_vertex_array(unsigned int id)
+{
+  record(RecordedCommandType::DeleteVertexArray, id);
+}
+
+void
+RecordingRenderBackend::delete_buffer(unsigned int id)
+{
+  record(RecordedCommandType::DeleteBuffer, id);
+}
+
+void
+RecordingRenderBackend::bind_vertex_array(unsigned int id)
+{
+  stats.vertex_array_binds += 1;
+  record(RecordedCommandType::BindVertexArray, id);
+}
+
+void
+RecordingRenderBackend::bind_buffer(unsigned int target, unsigned int id)
+{
+  stats.buffer_binds += 1;
+  record(RecordedCommandType::BindBuffer, id);
+}
+
+void
+RecordingRenderBackend::bind_buffer_base(unsigned int target, unsigned int binding, unsigned int id)
+{
+  stats.buffer_binds += 1;
+  record(RecordedCommandType::BindBufferBase, id, binding);
+}
+
+void
+RecordingRenderBackend::buffer_data(unsigned int target, size_t bytes, const void* data, unsigned int usage)
+{
+  // allocations without data don't upload anything
+  if (data != nullptr)
+    stats.bytes_uploaded += bytes;
+  record(RecordedCommandType::BufferData, target, bytes);
+}
+
+void
+RecordingRenderBackend::buffer_sub_data(unsigned int target, size_t offset, size_t bytes, const void* data)
+{
+  stats.bytes_uploaded += bytes;
+  record(RecordedCommandType::BufferSubData, target, bytes);
+}
+
+void
+RecordingRenderBackend::vertex_attrib_float(unsigned int index, int components, size_t stride, size_t offset)
+{
+  record(RecordedCommandType::VertexAttrib, index, components);
+}
+
+void
+RecordingRenderBackend::bind_texture(unsigned int target, unsigned int id, int unit)
+{
+  stats.texture_binds += 1;
+  record(RecordedCommandType::BindTexture, id, unit < 0 ? 0 : unit);
+}
+
+unsigned int
+RecordingRenderBackend::create_program(const std::string& vert_code, const std::string& frag_code)
+{
+  unsigned int id = next_id++;
+  record(RecordedCommandType::CreateProgram, id);
+  return id;
+}
+
+std::vector<unsigned int>
+RecordingRenderBackend::create_programs(const std::vector<ProgramSource>& sources)
+{
+  std::vector<unsigned int> ids;
+  for (const ProgramSource& source : sources)
+    ids.push_back(create_program(source.vert_code, source.frag_code));
+  return ids;
+}
+
+void
+RecordingRenderBackend::delete_program(unsigned int id)
+{
+  uniform_locations.erase(id);
+  record(RecordedCommandType::DeleteProgram, id);
+}
+
+void
+RecordingRenderBackend::use_program(unsigned int id)
+{
+  stats.program_binds += 1;
+  record(RecordedCommandType::UseProgram, id);
+}
+
+int
+RecordingRenderBackend::get_uniform_location(unsigned int program, const std::string& name)
+{
+  auto& locations = uniform_locations[program];
+  auto it = locations.find(name);
+  if (it != locations.end())
+    return it->second;
+  int location = static_cast<int>(locations.size());
+  locations[name] = location;
+  return location;
+}
+
+std::vector<std::string>
+RecordingRenderBackend::get_active_uniforms(unsigned int program)
+{
+  // there's no source to reflect, locations are handed out when first asked for
+  return {};
+}
+
+bool
+RecordingRenderBackend::bind_uniform_block(unsigned int program, const std::string& block, unsigned int binding)
+{
+  record(RecordedCommandType::BindUniformBlock, program, binding);
+  return true;
+}
+
+void
+RecordingRenderBackend::set_uniform_int(int location, int value)
+{
+  stats.uniform_sets += 1;
+  record(RecordedCommandType::SetUniform, location, sizeof(int));
+}
+
+void
+RecordingRenderBackend::set_uniform_uint(int location, unsigned int value)
+{
+  stats.uniform_sets += 1;
+  record(RecordedCommandType::SetUniform, location, sizeof(unsigned int));
+}
+
+void
+RecordingRenderBackend::set_uniform_floats(int location, int components, const float* value)
+{
+  stats.uniform_sets += 1;
+  record(RecordedCommandType::SetUniform, location, components * sizeof(float));
+}
+
+void
+RecordingRenderBackend::set_uniform_matrix(int location, int dimension, const float* value)
+{
+  stats.uniform_sets += 1;
+  record(RecordedCommandType::SetUniform, location, dimension * dimension * sizeof(float));
+}
+
+void
+RecordingRenderBackend::draw_indexed_triangles(unsigned int index_count)
+{
+  stats.draw_calls += 1;
+  stats.indices_drawn += index_count;
+  record(RecordedCommandType::DrawIndexed, 0, index_count);
+}
+
+void
+RecordingRenderBackend::draw_line_loop(unsigned int vertex_count)
+{
+  stats.draw_calls += 1;
+  record(RecordedCommandType::DrawLineLoop, 0, vertex_count);
+}
+
+} // namespace fightingengine
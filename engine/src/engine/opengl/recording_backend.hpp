@@ -0,0 +1,121 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// your project headers
+#include "engine/opengl/render_backend.hpp"
+
+namespace fightingengine {
+
+//
+// A render backend that never touches the gpu.
+// It counts (and optionally logs) everything the renderers ask for,
+// so batch building can be benchmarked and tested headless.
+//
+
+enum class RecordedCommandType
+{
+  SetViewport,
+  SetClearColour,
+  Clear,
+  SetEnabled,
+  SetBlendFunc,
+  SetDepthFunc,
+  CreateVertexArray,
+  CreateBuffer,
+  DeleteVertexArray,
+  DeleteBuffer,
+  BindVertexArray,
+  BindBuffer,
+  BindBufferBase,
+  BufferData,
+  BufferSubData,
+  VertexAttrib,
+  BindTexture,
+  CreateProgram,
+  DeleteProgram,
+  UseProgram,
+  SetUniform,
+  BindUniformBlock,
+  DrawIndexed,
+  DrawLineLoop,
+};
+
+struct RecordedCommand
+{
+  RecordedCommandType type;
+  unsigned int id = 0; // object, target or location, depending on the command
+  size_t size = 0;     // bytes uploaded, or indices or vertices drawn
+};
+
+struct RecordedStats
+{
+  int draw_calls = 0;
+  size_t indices_drawn = 0;
+  int vertex_array_binds = 0;
+  int buffer_binds = 0;
+  int texture_binds = 0;
+  int program_binds = 0;
+  size_t bytes_uploaded = 0;
+  int uniform_sets = 0;
+  int state_sets = 0;
+};
+
+class RecordingRenderBackend : public RenderBackend
+{
+public:
+  RecordedStats stats;
+  std::vector<RecordedCommand> commands;
+  bool record_commands = true; // turn off to only keep stats
+
+  // clears stats and commands, keeps created objects
+  void reset();
+
+  void set_viewport(int x, int y, int width, int height) override;
+  void set_clear_colour(const glm::vec4& colour) override;
+  void clear(unsigned int mask) override;
+  void set_enabled(unsigned int cap, bool enabled) override;
+  void set_blend_func(unsigned int src_rgb, unsigned int dst_rgb, unsigned int src_a, unsigned int dst_a) override;
+  void set_depth_func(unsigned int func) override;
+
+  [[nodiscard]] unsigned int create_vertex_array() override;
+  [[nodiscard]] unsigned int create_buffer() override;
+  void delete_vertex_array(unsigned int id) override;
+  void delete_buffer(unsigned int id) override;
+  void bind_vertex_array(unsigned int id) override;
+  void bind_buffer(unsigned int target, unsigned int id) override;
+  void bind_buffer_base(unsigned int target, unsigned int binding, unsigned int id) override;
+  void buffer_data(unsigned int target, size_t bytes, const void* data, unsigned int usage) override;
+  void buffer_sub_data(unsigned int target, size_t offset, size_t bytes, const void* data) override;
+  void vertex_attrib_float(unsigned int index, int components, size_t stride, size_t offset) override;
+
+  void bind_texture(unsigned int target, unsigned int id, int unit) override;
+
+  [[nodiscard]] unsigned int create_program(const std::string& vert_code, const std::string& frag_code) override;
+  [[nodiscard]] std::vector<unsigned int> create_programs(const std::vector<ProgramSource>& sources) override;
+  void delete_program(unsigned int id) override;
+  void use_program(unsigned int id) override;
+  [[nodiscard]] int get_uniform_location(unsigned int program, const std::string& name) override;
+  [[nodiscard]] std::vector<std::string> get_active_uniforms(unsigned int program) override;
+  bool bind_uniform_block(unsigned int program, const std::string& block, unsigned int binding) override;
+  void set_uniform_int(int location, int value) override;
+  void set_uniform_uint(int location, unsigned int value) override;
+  void set_uniform_floats(int location, int components, const float* value) override;
+  void set_uniform_matrix(int location, int dimension, const float* value) override;
+
+  void draw_indexed_triangles(unsigned int index_count) override;
+  void draw_line_loop(unsigned int vertex_count) override;
+
+private:
+  void record(RecordedCommandType type, unsigned int id = 0, size_t size = 0);
+
+  unsigned int next_id = 1;
+  // uniform locations are handed out per program, in the order they're asked for
+  std::unordered_map<unsigned int, std::unordered_map<std::string, int>> uniform_locations;
+};
+
+} // namespace fightingengine
@@ -0,0 +1,397 @@
+// header
+#include "engine/opengl/render_backend.hpp"
+
+// other library headers
+#include <GL/glew.h>
+
+// your project headers
+#include "engine/opengl/shader.hpp"
+#include "engine/opengl/shader_cache.hpp"
+
+namespace fightingengine {
+
+//
+// GLRenderBackend
+//
+
+void
+GLRenderBackend::set_viewport(int x, int y, int width, int height)
+{
+  glViewport(x, y, width, height);
+}
+
+void
+GLRenderBackend::set_clear_colour(const glm::vec4& colour)
+{
+  glClearColor(colour.r, colour.g, colour.b, colour.a);
+}
+
+void
+GLRenderBackend::clear(unsigned int mask)
+{
+  glClear(mask);
+}
+
+void
+GLRenderBackend::set_enabled(unsigned int cap, bool enabled)
+{
+  if (enabled)
+    glEnable(cap);
+  else
+    glDisable(cap);
+}
+
+void
+GLRenderBackend::set_blend_func(unsigned int src_rgb, unsigned int dst_rgb, unsigned int src_a, unsigned int dst_a)
+{
+  glBlendFuncSeparate(src_rgb, dst_rgb, src_a, dst_a);
+}
+
+void
+GLRenderBackend::set_depth_func(unsigned int func)
+{
+  glDepthFunc(func);
+}
+
+unsigned int
+GLRenderBackend::create_vertex_array()
+{
+  unsigned int id = 0;
+  glGenVertexArrays(1, &id);
+  return id;
+}
+
+unsigned int
+GLRenderBackend::create_buffer()
+{
+  unsigned int id = 0;
+  glGenBuffers(1, &id);
+  return id;
+}
+
+void
+GLRenderBackend::delete_vertex_array(unsigned int id)
+{
+  glDeleteVertexArrays(1, &id);
+}
+
+void
+GLRenderBackend::delete_buffer(unsigned int id)
+{
+  glDeleteBuffers(1, &id);
+}
+
+void
+GLRenderBackend::bind_vertex_array(unsigned int id)
+{
+  glBindVertexArray(id);
+}
+
+void
+GLRenderBackend::bind_buffer(unsigned int target, unsigned int id)
+{
+  glBindBuffer(target, id);
+}
+
+void
+GLRenderBackend::bind_buffer_base(unsigned int target, unsigned int binding, unsigned int id)
+{
+  glBindBufferBase(target, binding, id);
+}
+
+void
+GLRenderBackend::buffer_data(unsigned int target, size_t bytes, const void* data, unsigned int usage)
+{
+  glBufferData(target, static_cast<GLsizeiptr>(bytes), data, usage);
+}
+
+void
+GLRenderBackend::buffer_sub_data(unsigned int target, size_t offset, size_t bytes, const void* data)
+{
+  glBufferSubData(target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+}
+
+void
+GLRenderBackend::vertex_attrib_float(unsigned int index, int components, size_t stride, size_t offset)
+{
+  glEnableVertexAttribArray(index);
+  glVertexAttribPointer(index, components, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(stride), (const void*)offset);
+}
+
+void
+GLRenderBackend::bind_texture(unsigned int target, unsigned int id, int unit)
+{
+  if (unit >= 0)
+    glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(target, id);
+}
+
+unsigned int
+GLRenderBackend::create_program(const std::string& vert_code, const std::string& frag_code)
+{
+  ProgramSource source;
+  source.vert_code = vert_code;
+  source.frag_code = frag_code;
+  return create_programs({ source })[0];
+}
+
+const std::string&
+GLRenderBackend::get_driver_string()
+{
+  if (driver.empty()) {
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+      const GLubyte* value = glGetString(name);
+      if (value != nullptr)
+        driver += reinterpret_cast<const char*>(value);
+      driver += "|";
+    }
+  }
+  return driver;
+}
+
+std::vector<unsigned int>
+GLRenderBackend::create_programs(const std::vector<ProgramSource>& sources)
+{
+  if (program_binaries_supported == -1) {
+    GLint formats = 0;
+    if (GLEW_ARB_get_program_binary)
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    program_binaries_supported = formats > 0 ? 1 : 0;
+
+    // let the driver use as many compiler threads as it wants
+    if (GLEW_KHR_parallel_shader_compile)
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+  }
+  const bool use_cache = program_binaries_supported == 1 && !shader_cache::get_directory().empty();
+
+  struct Pending
+  {
+    size_t index;
+    uint64_t key;
+    unsigned int vert_shader;
+    unsigned int frag_shader;
+  };
+  std::vector<Pending> pending;
+  std::vector<unsigned int> ids(sources.size(), 0);
+
+  for (size_t i = 0; i < sources.size(); i++) {
+    const ProgramSource& source = sources[i];
+    uint64_t key = 0;
+
+    if (use_cache) {
+      key = shader_cache::make_key(source.vert_code, source.frag_code, source.defines, get_driver_string());
+
+      // the driver can reject a blob (e.g. after an update that kept the version string), so check the link
+      shader_cache::ProgramBinary binary;
+      if (shader_cache::load(key, binary)) {
+        unsigned int id = glCreateProgram();
+        glProgramBinary(id, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(id, GL_LINK_STATUS, &linked);
+        if (linked == GL_TRUE) {
+          ids[i] = id;
+          continue;
+        }
+        glDeleteProgram(id);
+      }
+    }
+
+    // no status queries here, they would wait for each compile to finish
+    const char* vert_code = source.vert_code.c_str();
+    const char* frag_code = source.frag_code.c_str();
+    Pending p;
+    p.index = i;
+    p.key = key;
+    p.vert_shader = glCreateShader(GL_VERTEX_SHADER);
+    p.frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(p.vert_shader, 1, &vert_code, NULL);
+    glShaderSource(p.frag_shader, 1, &frag_code, NULL);
+    glCompileShader(p.vert_shader);
+    glCompileShader(p.frag_shader);
+
+    unsigned int id = glCreateProgram();
+    glAttachShader(id, p.vert_shader);
+    glAttachShader(id, p.frag_shader);
+    if (use_cache)
+      glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(id);
+
+    ids[i] = id;
+    pending.push_back(p);
+  }
+
+  for (const Pending& p : pending) {
+    unsigned int id = ids[p.index];
+
+    bool compiled = check_compile_errors(p.vert_shader, "VERTEX");
+    compiled &= check_compile_errors(p.frag_shader, "FRAGMENT");
+    bool linked = compiled && check_compile_errors(id, "PROGRAM");
+
+    glDetachShader(id, p.vert_shader);
+    glDetachShader(id, p.frag_shader);
+    glDeleteShader(p.vert_shader);
+    glDeleteShader(p.frag_shader);
+
+    if (!linked) {
+      glDeleteProgram(id);
+      ids[p.index] = 0;
+      continue;
+    }
+
+    if (use_cache) {
+      GLint length = 0;
+      glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+      if (length > 0) {
+        shader_cache::ProgramBinary binary;
+        binary.key = p.key;
+        binary.data.resize(length);
+        GLenum format = 0;
+        glGetProgramBinary(id, length, NULL, &format, binary.data.data());
+        binary.format = format;
+        shader_cache::save(binary);
+      }
+    }
+  }
+
+  return ids;
+}
+
+void
+GLRenderBackend::delete_program(unsigned int id)
+{
+  glDeleteProgram(id);
+}
+
+void
+GLRenderBackend::use_program(unsigned int id)
+{
+  glUseProgram(id);
+}
+
+int
+GLRenderBackend::get_uniform_location(unsigned int program, const std::string& name)
+{
+  return glGetUniformLocation(program, name.c_str());
+}
+
+std::vector<std::string>
+GLRenderBackend::get_active_uniforms(unsigned int program)
+{
+  std::vector<std::string> names;
+
+  GLint count = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+
+  GLchar name[256];
+  for (GLint i = 0; i < count; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+    std::string uniform(name, length);
+
+    // arrays are reported once, as name[0]
+    const std::string array_suffix = "[0]";
+    if (size > 1 && uniform.size() > array_suffix.size() &&
+        uniform.compare(uniform.size() - array_suffix.size(), array_suffix.size(), array_suffix) == 0) {
+      std::string base = uniform.substr(0, uniform.size() - array_suffix.size());
+      names.push_back(base);
+      for (GLint element = 0; element < size; element++)
+        names.push_back(base + "[" + std::to_string(element) + "]");
+    } else {
+      names.push_back(uniform);
+    }
+  }
+
+  return names;
+}
+
+bool
+GLRenderBackend::bind_uniform_block(unsigned int program, const std::string& block, unsigned int binding)
+{
+  GLuint index = glGetUniformBlockIndex(program, block.c_str());
+  if (index == GL_INVALID_INDEX)
+    return false;
+  glUniformBlockBinding(program, index, binding);
+  return true;
+}
+
+void
+GLRenderBackend::set_uniform_int(int location, int value)
+{
+  glUniform1i(location, value);
+}
+
+void
+GLRenderBackend::set_uniform_uint(int location, unsigned int value)
+{
+  glUniform1ui(location, value);
+}
+
+void
+GLRenderBackend::set_uniform_floats(int location, int components, const float* value)
+{
+  switch (components) {
+    case 1:
+      glUniform1fv(location, 1, value);
+      break;
+    case 2:
+      glUniform2fv(location, 1, value);
+      break;
+    case 3:
+      glUniform3fv(location, 1, value);
+      break;
+    case 4:
+      glUniform4fv(location, 1, value);
+      break;
+  }
+}
+
+void
+GLRenderBackend::set_uniform_matrix(int location, int dimension, const float* value)
+{
+  switch (dimension) {
+    case 2:
+      glUniformMatrix2fv(location, 1, GL_FALSE, value);
+      break;
+    case 3:
+      glUniformMatrix3fv(location, 1, GL_FALSE, value);
+      break;
+    case 4:
+      glUniformMatrix4fv(location, 1, GL_FALSE, value);
+      break;
+  }
+}
+
+void
+GLRenderBackend::draw_indexed_triangles(unsigned int index_count)
+{
+  glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
+}
+
+void
+GLRenderBackend::draw_line_loop(unsigned int vertex_count)
+{
+  glDrawArrays(GL_LINE_LOOP, 0, vertex_count);
+}
+
+//
+// Backend selection
+//
+
+static GLRenderBackend s_gl_backend;
+static RenderBackend* s_backend = &s_gl_backend;
+
+RenderBackend&
+get_render_backend()
+{
+  return *s_backend;
+}
+
+void
+set_render_backend(RenderBackend* backend)
+{
+  s_backend = backend != nullptr ? backend : &s_gl_backend;
+}
+
+} // namespace fightingengine
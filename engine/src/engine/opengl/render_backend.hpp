@@ -0,0 +1,140 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// other library headers
+#include <glm/glm.hpp>
+
+namespace fightingengine {
+
+//
+// Everything the renderers need from the gpu goes through a RenderBackend.
+// GLRenderBackend is the real one, RecordingRenderBackend (recording_backend.hpp)
+// captures the command stream so batch building can run without a gpu.
+// enums (targets, caps, blend factors, usage) are the GL values.
+//
+
+struct ProgramSource
+{
+  std::string vert_code;
+  std::string frag_code;
+  std::vector<std::string> defines; // already in the code, kept for the program cache key
+};
+
+class RenderBackend
+{
+public:
+  virtual ~RenderBackend() = default;
+
+  // state
+  virtual void set_viewport(int x, int y, int width, int height) = 0;
+  virtual void set_clear_colour(const glm::vec4& colour) = 0;
+  virtual void clear(unsigned int mask) = 0;
+  virtual void set_enabled(unsigned int cap, bool enabled) = 0;
+  virtual void set_blend_func(unsigned int src_rgb, unsigned int dst_rgb, unsigned int src_a, unsigned int dst_a) = 0;
+  virtual void set_depth_func(unsigned int func) = 0;
+
+  // buffers
+  [[nodiscard]] virtual unsigned int create_vertex_array() = 0;
+  [[nodiscard]] virtual unsigned int create_buffer() = 0;
+  virtual void delete_vertex_array(unsigned int id) = 0;
+  virtual void delete_buffer(unsigned int id) = 0;
+  virtual void bind_vertex_array(unsigned int id) = 0;
+  virtual void bind_buffer(unsigned int target, unsigned int id) = 0;
+  // binds the buffer to an indexed binding point, e.g. a uniform block binding
+  virtual void bind_buffer_base(unsigned int target, unsigned int binding, unsigned int id) = 0;
+  virtual void buffer_data(unsigned int target, size_t bytes, const void* data, unsigned int usage) = 0;
+  virtual void buffer_sub_data(unsigned int target, size_t offset, size_t bytes, const void* data) = 0;
+  // enables the attribute, and points it at floats in the bound array buffer
+  virtual void vertex_attrib_float(unsigned int index, int components, size_t stride, size_t offset) = 0;
+
+  // textures
+  // unit of -1 binds to the active unit
+  virtual void bind_texture(unsigned int target, unsigned int id, int unit) = 0;
+
+  // programs
+  // returns 0 if the program failed to compile or link
+  [[nodiscard]] virtual unsigned int create_program(const std::string& vert_code, const std::string& frag_code) = 0;
+  // starts every compile before waiting on any, so the driver can build them in parallel.
+  // ids are in the same order as sources, 0 for any that failed.
+  [[nodiscard]] virtual std::vector<unsigned int> create_programs(const std::vector<ProgramSource>& sources) = 0;
+  virtual void delete_program(unsigned int id) = 0;
+  virtual void use_program(unsigned int id) = 0;
+  [[nodiscard]] virtual int get_uniform_location(unsigned int program, const std::string& name) = 0;
+  // names of every active uniform, arrays are listed as name and name[i]
+  [[nodiscard]] virtual std::vector<std::string> get_active_uniforms(unsigned int program) = 0;
+  // returns false if the program doesn't use the block
+  virtual bool bind_uniform_block(unsigned int program, const std::string& block, unsigned int binding) = 0;
+  virtual void set_uniform_int(int location, int value) = 0;
+  virtual void set_uniform_uint(int location, unsigned int value) = 0;
+  // components is 1 - 4
+  virtual void set_uniform_floats(int location, int components, const float* value) = 0;
+  // dimension is 2 - 4, column major
+  virtual void set_uniform_matrix(int location, int dimension, const float* value) = 0;
+
+  // draws
+  // draws index_count unsigned int indices from the bound vao's element buffer
+  virtual void draw_indexed_triangles(unsigned int index_count) = 0;
+  // draws a closed line through the first vertex_count vertices of the bound vao, for debug shapes
+  virtual void draw_line_loop(unsigned int vertex_count) = 0;
+};
+
+class GLRenderBackend : public RenderBackend
+{
+public:
+  void set_viewport(int x, int y, int width, int height) override;
+  void set_clear_colour(const glm::vec4& colour) override;
+  void clear(unsigned int mask) override;
+  void set_enabled(unsigned int cap, bool enabled) override;
+  void set_blend_func(unsigned int src_rgb, unsigned int dst_rgb, unsigned int src_a, unsigned int dst_a) override;
+  void set_depth_func(unsigned int func) override;
+
+  [[nodiscard]] unsigned int create_vertex_array() override;
+  [[nodiscard]] unsigned int create_buffer() override;
+  void delete_vertex_array(unsigned int id) override;
+  void delete_buffer(unsigned int id) override;
+  void bind_vertex_array(unsigned int id) override;
+  void bind_buffer(unsigned int target, unsigned int id) override;
+  void bind_buffer_base(unsigned int target, unsigned int binding, unsigned int id) override;
+  void buffer_data(unsigned int target, size_t bytes, const void* data, unsigned int usage) override;
+  void buffer_sub_data(unsigned int target, size_t offset, size_t bytes, const void* data) override;
+  void vertex_attrib_float(unsigned int index, int components, size_t stride, size_t offset) override;
+
+  void bind_texture(unsigned int target, unsigned int id, int unit) override;
+
+  [[nodiscard]] unsigned int create_program(const std::string& vert_code, const std::string& frag_code) override;
+  // programs are loaded from the shader_cache when the driver accepts the blob
+  [[nodiscard]] std::vector<unsigned int> create_programs(const std::vector<ProgramSource>& sources) override;
+  void delete_program(unsigned int id) override;
+  void use_program(unsigned int id) override;
+  [[nodiscard]] int get_uniform_location(unsigned int program, const std::string& name) override;
+  [[nodiscard]] std::vector<std::string> get_active_uniforms(unsigned int program) override;
+  bool bind_uniform_block(unsigned int program, const std::string& block, unsigned int binding) override;
+  void set_uniform_int(int location, int value) override;
+  void set_uniform_uint(int location, unsigned int value) override;
+  void set_uniform_floats(int location, int components, const float* value) override;
+  void set_uniform_matrix(int location, int dimension, const float* value) override;
+
+  void draw_indexed_triangles(unsigned int index_count) override;
+  void draw_line_loop(unsigned int vertex_count) override;
+
+private:
+  // vendor, renderer and version, part of the program cache key
+  [[nodiscard]] const std::string& get_driver_string();
+  // -1 until first checked
+  int program_binaries_supported = -1;
+  std::string driver;
+};
+
+// the backend used by the renderers, defaults to a GLRenderBackend
+[[nodiscard]] RenderBackend&
+get_render_backend();
+
+// backend is not owned. pass nullptr to go back to the GL backend.
+void
+set_render_backend(RenderBackend* backend);
+
+} // namespace fightingengine
@@ -6,6 +6,9 @@
 #include <GL/glew.h>
 #include <SDL2/SDL.h>
 
+// your project headers
+#include "engine/opengl/render_backend.hpp"
+
 namespace fightingengine {
 
 void
@@ -23,11 +26,12 @@ RenderCommand::init()
   // Enable Multi Sampling
   SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
   SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-  glEnable(GL_MULTISAMPLE);
+  RenderBackend& backend = get_render_backend();
+  backend.set_enabled(GL_MULTISAMPLE, true);
 
-  glEnable(GL_BLEND);
+  backend.set_enabled(GL_BLEND, true);
   // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  backend.set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
   // Enable depth testing
   set_depth_testing(true);
@@ -47,7 +51,7 @@ RenderCommand::init()
   // Enable Faceculling
   // glEnable(GL_CULL_FACE);
   // glDisable(GL_CULL_FACE);
-  glDepthFunc(GL_LESS);
+  backend.set_depth_func(GL_LESS);
 
   // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 }
@@ -55,29 +59,26 @@ RenderCommand::init()
 void
 RenderCommand::set_depth_testing(bool toggle)
 {
-  if (toggle)
-    glEnable(GL_DEPTH_TEST);
-  else
-    glDisable(GL_DEPTH_TEST);
+  get_render_backend().set_enabled(GL_DEPTH_TEST, toggle);
 }
 
 void
 RenderCommand::set_viewport(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
 {
   // printf("(render_command) setting viewport... \n");
-  glViewport(x, y, width, height);
+  get_render_backend().set_viewport(x, y, width, height);
 }
 
 void
 RenderCommand::set_clear_colour(const glm::vec4& color)
 {
-  glClearColor(color.r, color.g, color.b, color.a);
+  get_render_backend().set_clear_colour(color);
 }
 
 void
 RenderCommand::clear()
 {
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  get_render_backend().clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 } // namespace fightingengine
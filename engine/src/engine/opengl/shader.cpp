@@ -1,9 +1,8 @@
-#pragma once
-
 // header
 #include "engine/opengl/shader.hpp"
 
 // c++ standard library headers
+#include <algorithm>
 #include <filesystem> // C++17
 #include <fstream>
 #include <sstream>
@@ -12,13 +11,15 @@
 #include <GL/glew.h>
 
 // your project headers
+#include "engine/opengl/render_backend.hpp"
+#include "engine/opengl/uniform_buffer.hpp"
 #include "engine/opengl/util.hpp"
 
 #define SHADER_ASSET_PATH "assets/"
 
 namespace fightingengine {
 
-void
+bool
 check_compile_errors(unsigned int shader, std::string type)
 {
   GLint success;
@@ -29,6 +30,7 @@ check_compile_errors(unsigned int shader, std::string type)
       glGetShaderInfoLog(shader, 1024, NULL, infoLog);
       std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n"
                 << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+      return false;
     }
   } else {
     glGetProgramiv(shader, GL_LINK_STATUS, &success);
@@ -36,26 +38,41 @@ check_compile_errors(unsigned int shader, std::string type)
       glGetProgramInfoLog(shader, 1024, NULL, infoLog);
       std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n"
                 << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+      return false;
     }
   }
+  return true;
 }
 
 void
-reload_shader_program(unsigned int* id, const std::string& vert_path, const std::string& frag_path)
+reload_shader_program(unsigned int* id,
+                      const std::string& vert_path,
+                      const std::string& frag_path,
+                      const std::vector<std::string>& defines)
 {
   printf("Reloading shader: %s %s \n", vert_path.c_str(), frag_path.c_str());
 
   // Create a new shader program from the given file names. Halt on failure.
-  unsigned int new_id = create_opengl_shader(vert_path, frag_path);
+  unsigned int new_id = create_opengl_shader(vert_path, frag_path, defines);
 
   if (new_id) {
-    glDeleteProgram(*id);
+    get_render_backend().delete_program(*id);
     *id = new_id;
   }
 }
 
 unsigned int
-create_opengl_shader(const std::string& vert_path, const std::string& frag_path)
+create_opengl_shader(const std::string& vert_path, const std::string& frag_path, const std::vector<std::string>& defines)
+{
+  ShaderDesc desc;
+  desc.vert_path = vert_path;
+  desc.frag_path = frag_path;
+  desc.defines = defines;
+  return create_opengl_shaders({ desc })[0];
+}
+
+std::vector<unsigned int>
+create_opengl_shaders(const std::vector<ShaderDesc>& descs)
 {
   // OpenGL ShaderTypes
   // GL_VERTEX_SHADER VERTEX
@@ -63,26 +80,47 @@ create_opengl_shader(const std::string& vert_path, const std::string& frag_path)
   // GL_FRAGMENT_SHADER FRAGMENT
   // GL_GEOMETRY_SHADER VERTEX
 
-  unsigned int vert_shader = load_shader_from_disk(SHADER_ASSET_PATH + vert_path, GL_VERTEX_SHADER, "VERTEX");
-  unsigned int frag_shader = load_shader_from_disk(SHADER_ASSET_PATH + frag_path, GL_FRAGMENT_SHADER, "FRAGMENT");
-
-  unsigned int ID = glCreateProgram();
-  glAttachShader(ID, vert_shader);
-  glAttachShader(ID, frag_shader);
-
-  glLinkProgram(ID);
-  check_compile_errors(ID, "PROGRAM");
+  std::vector<ProgramSource> sources;
+  for (const ShaderDesc& desc : descs) {
+    ProgramSource source;
+    source.vert_code = apply_shader_defines(read_shader_from_disk(SHADER_ASSET_PATH + desc.vert_path), desc.defines);
+    source.frag_code = apply_shader_defines(read_shader_from_disk(SHADER_ASSET_PATH + desc.frag_path), desc.defines);
+    source.defines = desc.defines;
+    sources.push_back(source);
+  }
 
-  glDeleteShader(vert_shader);
-  glDeleteShader(frag_shader);
+  return get_render_backend().create_programs(sources);
+}
 
-  return ID;
+std::string
+apply_shader_defines(const std::string& code, const std::vector<std::string>& defines)
+{
+  if (defines.empty())
+    return code;
+
+  std::string define_lines;
+  for (const std::string& define : defines)
+    define_lines += "#define " + define + "\n";
+
+  // #version has to stay the first statement
+  size_t version = code.find("#version");
+  if (version == std::string::npos)
+    return define_lines + code;
+  size_t line_end = code.find('\n', version);
+  if (line_end == std::string::npos)
+    return code + "\n" + define_lines;
+  return code.substr(0, line_end + 1) + define_lines + code.substr(line_end + 1);
 }
 
 unsigned int
 load_shader_from_disk(const std::string& path, unsigned int gl_shader_type, std::string type)
 {
-  unsigned int shader_id;
+  return compile_shader(read_shader_from_disk(path), gl_shader_type, type);
+}
+
+std::string
+read_shader_from_disk(const std::string& path)
+{
   std::string code;
   {
     const char* compute_shader_path = path.c_str();
@@ -109,9 +147,14 @@ load_shader_from_disk(const std::string& path, unsigned int gl_shader_type, std:
       exit(1);
     }
   }
+  return code;
+}
 
+unsigned int
+compile_shader(const std::string& code, unsigned int gl_shader_type, std::string type)
+{
   const char* csCode = code.c_str();
-  shader_id = glCreateShader(gl_shader_type);
+  unsigned int shader_id = glCreateShader(gl_shader_type);
   glShaderSource(shader_id, 1, &csCode, NULL);
   glCompileShader(shader_id);
   check_compile_errors(shader_id, type);
@@ -123,87 +166,159 @@ load_shader_from_disk(const std::string& path, unsigned int gl_shader_type, std:
 // Shader
 //
 
-Shader::Shader(const std::string& vert_path, const std::string& frag_path)
+Shader::Shader(const std::string& vert_path, const std::string& frag_path, const std::vector<std::string>& defines)
+{
+  ID = create_opengl_shader(vert_path, frag_path, defines);
+  if (ID != 0)
+    reflect();
+}
+
+Shader::Shader(unsigned int id)
+  : ID(id)
+{
+  if (ID != 0)
+    reflect();
+}
+
+void
+Shader::reflect() const
+{
+  RenderBackend& backend = get_render_backend();
+
+  uniform_locations.clear();
+  for (const std::string& uniform : backend.get_active_uniforms(ID)) {
+    UniformLocation entry;
+    entry.hash = hash_uniform_name(uniform.c_str());
+    entry.location = backend.get_uniform_location(ID, uniform);
+    uniform_locations.push_back(entry);
+  }
+  std::sort(uniform_locations.begin(),
+            uniform_locations.end(),
+            [](const UniformLocation& a, const UniformLocation& b) { return a.hash < b.hash; });
+
+  for (size_t i = 1; i < uniform_locations.size(); i++) {
+    if (uniform_locations[i].hash == uniform_locations[i - 1].hash)
+      printf("WARNING: uniform name hash collision in program %u \n", ID);
+  }
+
+  backend.bind_uniform_block(ID, FRAME_DATA_BLOCK, FRAME_DATA_BINDING);
+  backend.bind_uniform_block(ID, BONE_PALETTE_BLOCK, BONE_PALETTE_BINDING);
+  reflected_id = ID;
+}
+
+int
+Shader::get_location(const UniformName& name) const
 {
-  ID = create_opengl_shader(vert_path, frag_path);
+  if (reflected_id != ID)
+    reflect();
+
+  auto it = std::lower_bound(uniform_locations.begin(),
+                             uniform_locations.end(),
+                             name.hash,
+                             [](const UniformLocation& entry, uint32_t hash) { return entry.hash < hash; });
+  if (it != uniform_locations.end() && it->hash == name.hash)
+    return it->location;
+
+  // not reported by reflection, ask once and remember the answer (including -1)
+  UniformLocation entry;
+  entry.hash = name.hash;
+  entry.location = get_render_backend().get_uniform_location(ID, name.name);
+  uniform_locations.insert(it, entry);
+  return entry.location;
 }
 
 void
 Shader::bind()
 {
-  glUseProgram(ID);
+  get_render_backend().use_program(ID);
 }
 
 void
 Shader::unbind()
 {
-  glUseProgram(0);
+  get_render_backend().use_program(0);
 }
 
 void
-Shader::set_bool(const std::string& name, bool value) const
+Shader::set_bool(const UniformName& name, bool value) const
 {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_int(get_location(name), (int)value);
 }
 void
-Shader::set_int(const std::string& name, int value) const
+Shader::set_int(const UniformName& name, int value) const
 {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_int(get_location(name), value);
 }
 void
-Shader::set_uint(const std::string& name, unsigned int value) const
+Shader::set_uint(const UniformName& name, unsigned int value) const
 {
-  glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_uint(get_location(name), value);
 }
 void
-Shader::set_float(const std::string& name, float value) const
+Shader::set_float(const UniformName& name, float value) const
 {
-  glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 1, &value);
 }
 void
-Shader::set_vec2(const std::string& name, const glm::vec2& value) const
+Shader::set_vec2(const UniformName& name, const glm::vec2& value) const
 {
-  glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 2, &value[0]);
 }
 void
-Shader::set_vec2(const std::string& name, float x, float y) const
+Shader::set_vec2(const UniformName& name, float x, float y) const
 {
-  glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+  const float value[2] = { x, y };
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 2, value);
 }
 void
-Shader::set_vec3(const std::string& name, const glm::vec3& value) const
+Shader::set_vec3(const UniformName& name, const glm::vec3& value) const
 {
-  glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 3, &value[0]);
 }
 void
-Shader::set_vec3(const std::string& name, float x, float y, float z) const
+Shader::set_vec3(const UniformName& name, float x, float y, float z) const
 {
-  glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+  const float value[3] = { x, y, z };
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 3, value);
 }
 void
-Shader::set_vec4(const std::string& name, const glm::vec4& value) const
+Shader::set_vec4(const UniformName& name, const glm::vec4& value) const
 {
-  glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 4, &value[0]);
 }
 void
-Shader::set_vec4(const std::string& name, float x, float y, float z, float w)
+Shader::set_vec4(const UniformName& name, float x, float y, float z, float w)
 {
-  glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+  const float value[4] = { x, y, z, w };
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_floats(get_location(name), 4, value);
 }
 void
-Shader::set_mat2(const std::string& name, const glm::mat2& mat) const
+Shader::set_mat2(const UniformName& name, const glm::mat2& mat) const
 {
-  glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_matrix(get_location(name), 2, &mat[0][0]);
 }
 void
-Shader::set_mat3(const std::string& name, const glm::mat3& mat) const
+Shader::set_mat3(const UniformName& name, const glm::mat3& mat) const
 {
-  glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_matrix(get_location(name), 3, &mat[0][0]);
 }
 void
-Shader::set_mat4(const std::string& name, const glm::mat4& mat) const
+Shader::set_mat4(const UniformName& name, const glm::mat4& mat) const
 {
-  glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  RenderBackend& backend = get_render_backend();
+  backend.set_uniform_matrix(get_location(name), 4, &mat[0][0]);
 }
 
 int
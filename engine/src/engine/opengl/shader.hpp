@@ -1,6 +1,7 @@
 #pragma once
 
 // c++ standard library headers
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,48 +11,117 @@
 
 namespace fightingengine {
 
-void
+// returns false if the shader failed to compile, or the program failed to link
+bool
 check_compile_errors(unsigned int shader, std::string type);
 
+struct ShaderDesc
+{
+  std::string vert_path;
+  std::string frag_path;
+  std::vector<std::string> defines; // "NAME" or "NAME VALUE"
+};
+
 void
-reload_shader_program(unsigned int* id, const std::string& vert_path, const std::string& frag_path);
+reload_shader_program(unsigned int* id,
+                      const std::string& vert_path,
+                      const std::string& frag_path,
+                      const std::vector<std::string>& defines = {});
 
 [[nodiscard]] unsigned int
-create_opengl_shader(const std::string& vert_path, const std::string& frag_path);
+create_opengl_shader(const std::string& vert_path,
+                     const std::string& frag_path,
+                     const std::vector<std::string>& defines = {});
+
+// builds the programs as one batch, see RenderBackend::create_programs()
+[[nodiscard]] std::vector<unsigned int>
+create_opengl_shaders(const std::vector<ShaderDesc>& descs);
+
+// inserts a #define for each entry after the #version line
+[[nodiscard]] std::string
+apply_shader_defines(const std::string& code, const std::vector<std::string>& defines);
 
 [[nodiscard]] unsigned int
 load_shader_from_disk(const std::string& path, unsigned int gl_shader_type, std::string type);
 
+[[nodiscard]] std::string
+read_shader_from_disk(const std::string& path);
+
+[[nodiscard]] unsigned int
+compile_shader(const std::string& code, unsigned int gl_shader_type, std::string type);
+
+// fnv-1a, constexpr so literal uniform names hash at compile time
+[[nodiscard]] constexpr uint32_t
+hash_uniform_name(const char* name)
+{
+  uint32_t hash = 2166136261u;
+  for (; *name != '\0'; name++) {
+    hash ^= static_cast<uint8_t>(*name);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// a uniform name and its hash, so lookups don't build a std::string
+struct UniformName
+{
+  uint32_t hash;
+  const char* name;
+
+  constexpr UniformName(const char* n)
+    : hash(hash_uniform_name(n))
+    , name(n){};
+  UniformName(const std::string& n)
+    : hash(hash_uniform_name(n.c_str()))
+    , name(n.c_str()){};
+};
+
+struct UniformLocation
+{
+  uint32_t hash;
+  int location;
+};
+
 class Shader
 {
 public:
   unsigned int ID;
 
-  Shader(const std::string& vert_path, const std::string& frag_path);
+  Shader(const std::string& vert_path, const std::string& frag_path, const std::vector<std::string>& defines = {});
+  // takes ownership of an already linked program
+  explicit Shader(unsigned int id);
 
   void bind();
   void unbind();
 
-  void set_bool(const std::string& name, bool value) const;
-  void set_int(const std::string& name, int value) const;
-  void set_uint(const std::string& name, unsigned int value) const;
-  void set_float(const std::string& name, float value) const;
-  void set_vec2(const std::string& name, const glm::vec2& value) const;
-  void set_vec2(const std::string& name, float x, float y) const;
-  void set_vec3(const std::string& name, const glm::vec3& value) const;
-  void set_vec3(const std::string& name, float x, float y, float z) const;
-  void set_vec4(const std::string& name, const glm::vec4& value) const;
-  void set_vec4(const std::string& name, float x, float y, float z, float w);
-  void set_mat2(const std::string& name, const glm::mat2& mat) const;
-  void set_mat3(const std::string& name, const glm::mat3& mat) const;
-  void set_mat4(const std::string& name, const glm::mat4& mat) const;
+  void set_bool(const UniformName& name, bool value) const;
+  void set_int(const UniformName& name, int value) const;
+  void set_uint(const UniformName& name, unsigned int value) const;
+  void set_float(const UniformName& name, float value) const;
+  void set_vec2(const UniformName& name, const glm::vec2& value) const;
+  void set_vec2(const UniformName& name, float x, float y) const;
+  void set_vec3(const UniformName& name, const glm::vec3& value) const;
+  void set_vec3(const UniformName& name, float x, float y, float z) const;
+  void set_vec4(const UniformName& name, const glm::vec4& value) const;
+  void set_vec4(const UniformName& name, float x, float y, float z, float w);
+  void set_mat2(const UniformName& name, const glm::mat2& mat) const;
+  void set_mat3(const UniformName& name, const glm::mat3& mat) const;
+  void set_mat4(const UniformName& name, const glm::mat4& mat) const;
 
   [[nodiscard]] int get_uniform_binding_location(const std::string& name) const;
 
   [[nodiscard]] int get_compute_buffer_binding_location(const std::string& name) const;
   void set_compute_buffer_bind_location(const std::string& name);
 
+  // location of a uniform, -1 if the program doesn't use it
+  [[nodiscard]] int get_location(const UniformName& name) const;
+
 private:
+  // caches the locations of every active uniform, and binds the shared uniform blocks
+  void reflect() const;
+
+  mutable unsigned int reflected_id = 0; // reload_shader_program() swaps ID
+  mutable std::vector<UniformLocation> uniform_locations; // sorted by hash
 };
 
 } // namespace fightingengine
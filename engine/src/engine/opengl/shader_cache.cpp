@@ -0,0 +1,147 @@
+// header
+#include "engine/opengl/shader_cache.hpp"
+
+// c++ standard library headers
+#include <cstdio>
+#include <cstring>
+#include <filesystem> // C++17
+#include <fstream>
+#include <iostream>
+
+namespace fightingengine {
+
+namespace shader_cache {
+
+//
+// Blob file layout (native endian, it's only read back on the same machine)
+//
+// char[4]   magic "PBIN"
+// uint32_t  version
+// uint64_t  key
+// uint32_t  binary format
+// uint32_t  binary size (bytes), then the binary
+//
+
+static const char binary_magic[4] = { 'P', 'B', 'I', 'N' };
+static const uint32_t binary_version = 1;
+
+static std::string s_directory = "shader_cache/";
+
+template<typename T>
+static void
+write_value(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool
+read_value(std::ifstream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return in.good();
+}
+
+static std::string
+blob_path(uint64_t key)
+{
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(s_directory) / name).string();
+}
+
+// fnv-1a 64, with a separator between fields so "ab"+"c" != "a"+"bc"
+static void
+hash_append(uint64_t& hash, const std::string& s)
+{
+  for (char c : s) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  hash ^= 0xff;
+  hash *= 1099511628211ull;
+}
+
+void
+set_directory(const std::string& directory)
+{
+  s_directory = directory;
+}
+
+const std::string&
+get_directory()
+{
+  return s_directory;
+}
+
+uint64_t
+make_key(const std::string& vert_code,
+         const std::string& frag_code,
+         const std::vector<std::string>& defines,
+         const std::string& driver)
+{
+  uint64_t hash = 14695981039346656037ull;
+  hash_append(hash, vert_code);
+  hash_append(hash, frag_code);
+  for (const std::string& define : defines)
+    hash_append(hash, define);
+  hash_append(hash, driver);
+  return hash;
+}
+
+bool
+load(uint64_t key, ProgramBinary& binary)
+{
+  if (s_directory.empty())
+    return false;
+
+  std::ifstream in(blob_path(key), std::ios::binary);
+  if (!in.is_open())
+    return false;
+
+  char magic[4];
+  uint32_t version = 0;
+  uint64_t file_key = 0;
+  uint32_t format = 0;
+  uint32_t size = 0;
+  in.read(magic, 4);
+  if (!in.good() || std::memcmp(magic, binary_magic, 4) != 0 || !read_value(in, version) ||
+      version != binary_version || !read_value(in, file_key) || file_key != key || !read_value(in, format) ||
+      !read_value(in, size) || size == 0) {
+    std::cerr << "shader cache: ignoring stale blob " << blob_path(key) << std::endl;
+    return false;
+  }
+
+  binary.key = key;
+  binary.format = format;
+  binary.data.resize(size);
+  in.read(binary.data.data(), size);
+  return in.good();
+}
+
+void
+save(const ProgramBinary& binary)
+{
+  if (s_directory.empty() || binary.data.empty())
+    return;
+
+  std::error_code error;
+  std::filesystem::create_directories(s_directory, error);
+
+  std::ofstream out(blob_path(binary.key), std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "shader cache: could not write " << blob_path(binary.key) << std::endl;
+    return;
+  }
+
+  out.write(binary_magic, 4);
+  write_value(out, binary_version);
+  write_value(out, binary.key);
+  write_value(out, binary.format);
+  write_value(out, static_cast<uint32_t>(binary.data.size()));
+  out.write(binary.data.data(), binary.data.size());
+}
+
+} // namespace shader_cache
+
+} // namespace fightingengine
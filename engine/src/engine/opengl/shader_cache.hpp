@@ -0,0 +1,48 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fightingengine {
+
+//
+// On-disk cache of linked program binaries (glGetProgramBinary blobs).
+// Blobs are keyed by a hash of the shader source and the driver string,
+// so editing a shader or updating the driver misses the cache and recompiles.
+//
+
+namespace shader_cache {
+
+struct ProgramBinary
+{
+  uint64_t key = 0;
+  uint32_t format = 0; // driver specific, from glGetProgramBinary
+  std::vector<char> data;
+};
+
+// "" disables the cache
+void
+set_directory(const std::string& directory);
+
+[[nodiscard]] const std::string&
+get_directory();
+
+// defines are hashed as given, in order
+[[nodiscard]] uint64_t
+make_key(const std::string& vert_code,
+         const std::string& frag_code,
+         const std::vector<std::string>& defines,
+         const std::string& driver);
+
+// returns false if there's no (valid) blob for the key
+[[nodiscard]] bool
+load(uint64_t key, ProgramBinary& binary);
+
+void
+save(const ProgramBinary& binary);
+
+} // namespace shader_cache
+
+} // namespace fightingengine
@@ -0,0 +1,383 @@
+// header
+#include "engine/opengl/skinned_model.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cstring>
+#include <filesystem> // C++17
+#include <iostream>
+
+// other library headers
+#include "assimp/Importer.hpp"
+#include "assimp/config.h"
+#include "assimp/postprocess.h"
+#include "assimp/scene.h"
+#include <GL/glew.h>
+#include <glm/gtc/type_ptr.hpp>
+
+// your project headers
+#include "engine/opengl/uniform_buffer.hpp"
+#include "engine/thread_pool.hpp"
+
+namespace fightingengine {
+
+static const unsigned int import_flags =
+  aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcess_LimitBoneWeights;
+
+// assimp matrices are row major
+static glm::mat4
+to_glm(const aiMatrix4x4& m)
+{
+  return glm::transpose(glm::make_mat4(&m.a1));
+}
+
+static void
+add_node(const aiNode* node, int32_t parent, animation::Skeleton& skeleton)
+{
+  aiVector3D scale;
+  aiQuaternion rotation;
+  aiVector3D position;
+  node->mTransformation.Decompose(scale, rotation, position);
+
+  const size_t index = skeleton.names.size();
+  skeleton.names.push_back(node->mName.C_Str());
+  skeleton.parents.push_back(parent);
+  skeleton.bones.push_back(animation::not_a_bone);
+
+  animation::Pose& pose = skeleton.bind_pose;
+  pose.resize(index + 1);
+  pose.tx[index] = position.x;
+  pose.ty[index] = position.y;
+  pose.tz[index] = position.z;
+  pose.rx[index] = rotation.x;
+  pose.ry[index] = rotation.y;
+  pose.rz[index] = rotation.z;
+  pose.rw[index] = rotation.w;
+  pose.sx[index] = scale.x;
+  pose.sy[index] = scale.y;
+  pose.sz[index] = scale.z;
+
+  for (unsigned int i = 0; i < node->mNumChildren; i++)
+    add_node(node->mChildren[i], static_cast<int32_t>(index), skeleton);
+}
+
+// the clip's tracks are matched to the skeleton by node name
+static animation::Clip
+load_clip(const aiAnimation* source, const animation::Skeleton& skeleton, const std::string& name)
+{
+  const double ticks_per_second = source->mTicksPerSecond != 0.0 ? source->mTicksPerSecond : 25.0;
+
+  animation::Clip clip;
+  clip.name = name;
+  clip.duration = static_cast<float>(source->mDuration / ticks_per_second);
+
+  for (unsigned int i = 0; i < source->mNumChannels; i++) {
+    const aiNodeAnim* channel = source->mChannels[i];
+    const int32_t node = skeleton.find_node(channel->mNodeName.C_Str());
+    if (node == animation::node_not_found) {
+      std::cerr << "animation " << name << " has a track for a missing node: " << channel->mNodeName.C_Str()
+                << std::endl;
+      continue;
+    }
+
+    animation::Track track;
+    track.node = static_cast<uint32_t>(node);
+
+    track.first_position = static_cast<uint32_t>(clip.positions.size());
+    track.position_count = channel->mNumPositionKeys;
+    for (unsigned int k = 0; k < channel->mNumPositionKeys; k++) {
+      const aiVectorKey& key = channel->mPositionKeys[k];
+      clip.position_times.push_back(static_cast<float>(key.mTime / ticks_per_second));
+      clip.positions.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+    }
+
+    track.first_rotation = static_cast<uint32_t>(clip.rotations.size());
+    track.rotation_count = channel->mNumRotationKeys;
+    for (unsigned int k = 0; k < channel->mNumRotationKeys; k++) {
+      const aiQuatKey& key = channel->mRotationKeys[k];
+      clip.rotation_times.push_back(static_cast<float>(key.mTime / ticks_per_second));
+      clip.rotations.push_back(glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z));
+    }
+
+    track.first_scale = static_cast<uint32_t>(clip.scales.size());
+    track.scale_count = channel->mNumScalingKeys;
+    for (unsigned int k = 0; k < channel->mNumScalingKeys; k++) {
+      const aiVectorKey& key = channel->mScalingKeys[k];
+      clip.scale_times.push_back(static_cast<float>(key.mTime / ticks_per_second));
+      clip.scales.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+    }
+
+    clip.tracks.push_back(track);
+  }
+
+  return clip;
+}
+
+// files usually hold one clip, named after the file
+static std::string
+clip_name(const std::string& path, const aiAnimation* animation, unsigned int count)
+{
+  std::string name = std::filesystem::path(path).stem().string();
+  if (count > 1)
+    name += std::string("/") + animation->mName.C_Str();
+  return name;
+}
+
+SkinnedModel::SkinnedModel(const std::string& full_path)
+{
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  const size_t palette_size = animation::max_bones * sizeof(glm::mat4);
+  const size_t align = alignment > 0 ? static_cast<size_t>(alignment) : 1;
+  palette_stride = (palette_size + align - 1) / align * align;
+
+  load_model(full_path);
+}
+
+SkinnedModel::~SkinnedModel()
+{
+  glDeleteVertexArrays(1, &vao);
+  glDeleteBuffers(1, &vbo);
+  glDeleteBuffers(1, &ebo);
+  glDeleteBuffers(1, &palette_ubo);
+}
+
+void
+SkinnedModel::load_model(const std::string& path)
+{
+  std::cout << "loading skinned model: " << path << std::endl;
+
+  Assimp::Importer importer;
+  // otherwise fbx pivots become extra nodes, and tracks target those instead of the bones
+  importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
+  const aiScene* scene = importer.ReadFile(path, import_flags);
+
+  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+    std::cerr << "Failed to load scene: " << importer.GetErrorString() << std::endl;
+    return;
+  }
+
+  add_node(scene->mRootNode, animation::no_parent, skeleton);
+  skeleton.global_inverse = glm::inverse(to_glm(scene->mRootNode->mTransformation));
+
+  std::vector<SkinnedVertex> vertices;
+  std::vector<unsigned int> indices;
+
+  for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+    const aiMesh* mesh = scene->mMeshes[m];
+    const unsigned int base_vertex = static_cast<unsigned int>(vertices.size());
+
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+      SkinnedVertex vertex;
+      vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+      vertex.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+      if (mesh->mTextureCoords[0])
+        vertex.tex_coords = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+      vertices.push_back(vertex);
+    }
+
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+      const aiFace& face = mesh->mFaces[i];
+      for (unsigned int j = 0; j < face.mNumIndices; j++)
+        indices.push_back(base_vertex + face.mIndices[j]);
+    }
+
+    // the heaviest bones_per_vertex weights for each vertex
+    std::vector<float> weights(mesh->mNumVertices * animation::bones_per_vertex, 0.0f);
+    for (unsigned int b = 0; b < mesh->mNumBones; b++) {
+      const aiBone* bone = mesh->mBones[b];
+      const int32_t node = skeleton.find_node(bone->mName.C_Str());
+      if (node == animation::node_not_found) {
+        std::cerr << "bone without a node: " << bone->mName.C_Str() << std::endl;
+        continue;
+      }
+
+      // meshes can share bones
+      if (skeleton.bones[node] == animation::not_a_bone) {
+        if (skeleton.get_bone_count() == animation::max_bones) {
+          std::cerr << "more than " << animation::max_bones << " bones, dropping: " << bone->mName.C_Str()
+                    << std::endl;
+          continue;
+        }
+        skeleton.bones[node] = static_cast<int32_t>(skeleton.get_bone_count());
+        skeleton.bone_offsets.push_back(to_glm(bone->mOffsetMatrix));
+      }
+      const uint8_t bone_id = static_cast<uint8_t>(skeleton.bones[node]);
+
+      for (unsigned int w = 0; w < bone->mNumWeights; w++) {
+        const aiVertexWeight& weight = bone->mWeights[w];
+        SkinnedVertex& vertex = vertices[base_vertex + weight.mVertexId];
+        float* slots = &weights[weight.mVertexId * animation::bones_per_vertex];
+
+        // replace the lightest slot
+        uint32_t lightest = 0;
+        for (uint32_t s = 1; s < animation::bones_per_vertex; s++) {
+          if (slots[s] < slots[lightest])
+            lightest = s;
+        }
+        if (weight.mWeight > slots[lightest]) {
+          slots[lightest] = weight.mWeight;
+          vertex.bone_ids[lightest] = bone_id;
+        }
+      }
+    }
+
+    // renormalise what's left, and make the unorm8 weights sum to exactly 255
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+      SkinnedVertex& vertex = vertices[base_vertex + i];
+      const float* slots = &weights[i * animation::bones_per_vertex];
+      float total = 0.0f;
+      for (uint32_t s = 0; s < animation::bones_per_vertex; s++)
+        total += slots[s];
+      if (total <= 0.0f) {
+        vertex.bone_weights[0] = 255; // unskinned, follows bone 0
+        continue;
+      }
+
+      int sum = 0;
+      uint32_t heaviest = 0;
+      for (uint32_t s = 0; s < animation::bones_per_vertex; s++) {
+        vertex.bone_weights[s] = static_cast<uint8_t>(slots[s] / total * 255.0f + 0.5f);
+        sum += vertex.bone_weights[s];
+        if (slots[s] > slots[heaviest])
+          heaviest = s;
+      }
+      vertex.bone_weights[heaviest] = static_cast<uint8_t>(vertex.bone_weights[heaviest] + (255 - sum));
+    }
+  }
+
+  setup_buffers(vertices, indices);
+
+  for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+    clips.push_back(
+      load_clip(scene->mAnimations[i], skeleton, clip_name(path, scene->mAnimations[i], scene->mNumAnimations)));
+
+  std::cout << "Loaded skinned model with vertices: " << vertices.size() << ", indices: " << indices.size()
+            << ", nodes: " << skeleton.names.size() << ", bones: " << skeleton.get_bone_count()
+            << ", animations: " << clips.size() << std::endl;
+}
+
+bool
+SkinnedModel::add_clips(const std::string& full_path)
+{
+  Assimp::Importer importer;
+  importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
+  const aiScene* scene = importer.ReadFile(full_path, import_flags);
+
+  if (!scene || !scene->mRootNode) {
+    std::cerr << "Failed to load animations: " << importer.GetErrorString() << std::endl;
+    return false;
+  }
+
+  for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+    clips.push_back(
+      load_clip(scene->mAnimations[i], skeleton, clip_name(full_path, scene->mAnimations[i], scene->mNumAnimations)));
+  return scene->mNumAnimations > 0;
+}
+
+int
+SkinnedModel::find_clip(const std::string& name) const
+{
+  for (size_t i = 0; i < clips.size(); i++) {
+    if (clips[i].name == name)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+animation::AnimationState
+SkinnedModel::create_state(uint32_t clip) const
+{
+  animation::AnimationState state;
+  state.clip = clip;
+  state.pose = skeleton.bind_pose;
+  state.palette.resize(skeleton.get_bone_count());
+
+  std::vector<glm::mat4> scratch;
+  animation::compute_palette(skeleton, state.pose, scratch, state.palette.data());
+  return state;
+}
+
+void
+SkinnedModel::update(std::vector<animation::AnimationState>& states, float delta_time_s) const
+{
+  animation::update_animations(skeleton, clips, states, delta_time_s, get_thread_pool());
+}
+
+void
+SkinnedModel::setup_buffers(const std::vector<SkinnedVertex>& vertices, const std::vector<unsigned int>& indices)
+{
+  index_count = static_cast<uint32_t>(indices.size());
+
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &vbo);
+  glGenBuffers(1, &ebo);
+  glGenBuffers(1, &palette_ubo);
+
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SkinnedVertex), vertices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+  const GLsizei stride = sizeof(SkinnedVertex);
+  // vertex positions
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SkinnedVertex, position));
+  // vertex normals
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SkinnedVertex, normal));
+  // vertex texture coords
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SkinnedVertex, tex_coords));
+  // bone ids, integers in the shader
+  glEnableVertexAttribArray(3);
+  glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, stride, (void*)offsetof(SkinnedVertex, bone_ids));
+  // bone weights, unorm8
+  glEnableVertexAttribArray(4);
+  glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(SkinnedVertex, bone_weights));
+
+  glBindVertexArray(0);
+}
+
+void
+SkinnedModel::draw(Shader& shader,
+                   const std::vector<animation::AnimationState>& states,
+                   const std::vector<glm::mat4>& models)
+{
+  if (vao == 0 || states.empty())
+    return;
+  if (states.size() != models.size()) {
+    printf("ERROR: skinned model draw with %zu states and %zu models \n", states.size(), models.size());
+    return;
+  }
+
+  // every palette in one upload, orphaning last frame's
+  const size_t palette_bytes = skeleton.get_bone_count() * sizeof(glm::mat4);
+  palette_staging.resize(states.size() * palette_stride);
+  for (size_t i = 0; i < states.size(); i++) {
+    if (states[i].palette.size() == skeleton.get_bone_count())
+      memcpy(&palette_staging[i * palette_stride], states[i].palette.data(), palette_bytes);
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, palette_ubo);
+  if (states.size() > palette_capacity)
+    palette_capacity = std::max(states.size(), palette_capacity * 2);
+  glBufferData(GL_UNIFORM_BUFFER, palette_capacity * palette_stride, nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, palette_staging.size(), palette_staging.data());
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindVertexArray(vao);
+  for (size_t i = 0; i < states.size(); i++) {
+    glBindBufferRange(GL_UNIFORM_BUFFER,
+                      BONE_PALETTE_BINDING,
+                      palette_ubo,
+                      static_cast<GLintptr>(i * palette_stride),
+                      animation::max_bones * sizeof(glm::mat4));
+    shader.set_mat4("model", models[i]);
+    glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
+  }
+  glBindVertexArray(0);
+}
+
+} // namespace fightingengine
@@ -0,0 +1,82 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// other library headers
+#include <glm/glm.hpp>
+
+// your project headers
+#include "engine/animation.hpp"
+#include "engine/opengl/shader.hpp"
+
+namespace fightingengine {
+
+// Vertex, plus the bones that move it
+struct SkinnedVertex
+{
+  glm::vec3 position = glm::vec3(0.0f);
+  glm::vec3 normal = glm::vec3(0.0f);
+  glm::vec2 tex_coords = glm::vec2(0.0f);
+  uint8_t bone_ids[animation::bones_per_vertex] = { 0, 0, 0, 0 };
+  uint8_t bone_weights[animation::bones_per_vertex] = { 0, 0, 0, 0 }; // unorm8, summing to 255
+};
+static_assert(sizeof(SkinnedVertex) == 40, "SkinnedVertex layout changed, update the attributes");
+static_assert(animation::max_bones <= 256, "bone ids are 8 bit");
+
+//
+// A model with a skeleton and its animations, skinned in skinned.vert.
+// Keeps its own buffers rather than going in a GeometryPool, as the vertex format differs.
+// The palettes for every instance drawn go in one uniform buffer, and each draw binds its range.
+//
+
+class SkinnedModel
+{
+public:
+  SkinnedModel(const std::string& full_path);
+  ~SkinnedModel();
+
+  SkinnedModel(const SkinnedModel&) = delete;
+  SkinnedModel& operator=(const SkinnedModel&) = delete;
+
+  // takes the animations from another file with the same skeleton (e.g. mixamo exports one per file).
+  // clips are named after the file, as the exported names are usually all the same.
+  bool add_clips(const std::string& full_path);
+
+  [[nodiscard]] const animation::Skeleton& get_skeleton() const { return skeleton; };
+  [[nodiscard]] const std::vector<animation::Clip>& get_clips() const { return clips; };
+  // -1 if there's no clip with that name
+  [[nodiscard]] int find_clip(const std::string& name) const;
+  // the bind pose until it's first updated
+  [[nodiscard]] animation::AnimationState create_state(uint32_t clip = 0) const;
+
+  // advances and poses every state on the shared thread pool
+  void update(std::vector<animation::AnimationState>& states, float delta_time_s) const;
+
+  // one draw per instance, with models[i] posed by states[i]
+  void draw(Shader& shader,
+            const std::vector<animation::AnimationState>& states,
+            const std::vector<glm::mat4>& models);
+
+private:
+  unsigned int vao = 0;
+  unsigned int vbo = 0;
+  unsigned int ebo = 0;
+  uint32_t index_count = 0;
+
+  unsigned int palette_ubo = 0;
+  size_t palette_stride = 0;   // bytes, max_bones matrices rounded up to the offset alignment
+  size_t palette_capacity = 0; // instances
+  std::vector<uint8_t> palette_staging;
+
+  animation::Skeleton skeleton;
+  std::vector<animation::Clip> clips;
+
+private:
+  void load_model(const std::string& path);
+  void setup_buffers(const std::vector<SkinnedVertex>& vertices, const std::vector<unsigned int>& indices);
+};
+
+} // namespace fightingengine
@@ -6,31 +6,131 @@
 #include <assert.h>
 
 // c++ standard library headers
+#include <algorithm>
+#include <filesystem> // C++17
 #include <iostream>
 
 // other lib headers
 #include <stb_image.h>
 
+// your project headers
+#include "engine/opengl/render_backend.hpp"
+
 namespace fightingengine {
 
+// maps and checks a .tex file, the upload happens later on the gl thread
+static bool
+load_baked_texture(const std::string& path, StbLoadedTexture& result)
+{
+  if (!map_file(path, result.baked_file))
+    return false;
+
+  if (!texture_format::parse(result.baked_file.data, result.baked_file.size, result.baked) ||
+      (result.baked.header->format != texture_format::Format::RGBA8 && !GLEW_EXT_texture_compression_s3tc)) {
+    std::cerr << "Failed to load baked texture: " << path << std::endl;
+    unmap_file(result.baked_file);
+    result.baked = texture_format::TextureView();
+    return false;
+  }
+
+  result.width = static_cast<int>(result.baked.header->width);
+  result.height = static_cast<int>(result.baked.header->height);
+  result.nr_components = 4;
+  return true;
+}
+
 StbLoadedTexture
-load_texture(const int textureUnit, const std::string& path)
+load_texture(const int textureUnit, const std::string& path, const int desired_channels)
 {
+  namespace fs = std::filesystem;
+
+  // baked textures are always rgba
+  if (desired_channels == 0 || desired_channels == 4) {
+    StbLoadedTexture result;
+    result.data = nullptr;
+    result.texture_unit = textureUnit;
+    result.path = path;
+
+    if (fs::path(path).extension() == ".tex") {
+      load_baked_texture(path, result);
+      return result;
+    }
+
+    // prefer a baked file (see tools/texture_cooker) if it's newer than the source
+    fs::path baked = fs::path(path).replace_extension(".tex");
+    std::error_code error;
+    if (fs::exists(baked, error) && fs::last_write_time(baked, error) >= fs::last_write_time(path, error)) {
+      if (load_baked_texture(baked.string(), result))
+        return result;
+    }
+  }
+
   int width, height, nrComponents;
-  unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, 0);
+  unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrComponents, desired_channels);
   StbLoadedTexture result;
   result.width = width;
   result.height = height;
-  result.nr_components = nrComponents;
+  result.nr_components = desired_channels == 0 ? nrComponents : desired_channels;
   result.data = data;
   result.texture_unit = textureUnit;
   result.path = path;
   return result;
 }
 
+// not the srgb formats, so baked textures sample the same as ones uploaded from images
+static GLenum
+get_internal_format(texture_format::Format format)
+{
+  if (format == texture_format::Format::BC1)
+    return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+  if (format == texture_format::Format::BC3)
+    return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+  return GL_RGBA8;
+}
+
+// every level as it was cooked, no glGenerateMipmap
+static void
+bind_baked_texture(StbLoadedTexture& texture)
+{
+  const texture_format::Header& header = *texture.baked.header;
+  std::cout << "binding baked " << texture.path << " to " << texture.texture_unit << std::endl;
+
+  unsigned int texture_id;
+  glGenTextures(1, &texture_id);
+  glActiveTexture(GL_TEXTURE0 + texture.texture_unit);
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  const GLenum internal_format = get_internal_format(header.format);
+
+  for (uint32_t i = 0; i < header.level_count; i++) {
+    const texture_format::Level& level = texture.baked.levels[i];
+    const uint8_t* data = texture.baked.data + level.offset;
+    if (header.format == texture_format::Format::RGBA8)
+      glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    else
+      glCompressedTexImage2D(GL_TEXTURE_2D, i, internal_format, level.width, level.height, 0, level.size, data);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.level_count - 1);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  unmap_file(texture.baked_file);
+  texture.baked = texture_format::TextureView();
+}
+
 void
 bind_stb_loaded_texture(StbLoadedTexture& texture)
 {
+  if (texture.baked.header != nullptr) {
+    bind_baked_texture(texture);
+    return;
+  }
+
   unsigned int textureID;
   glGenTextures(1, &textureID);
   int texture_unit = texture.texture_unit;
@@ -74,6 +174,223 @@ bind_stb_loaded_texture(StbLoadedTexture& texture)
   glBindTexture(GL_TEXTURE_2D, textureID);
 }
 
+// the format every layer was baked in, false if any layer wasn't baked or they differ
+static bool
+get_baked_array_format(const std::vector<StbLoadedTexture>& textures, texture_format::Format& format)
+{
+  for (size_t i = 0; i < textures.size(); i++) {
+    if (textures[i].baked.header == nullptr)
+      return false;
+    if (i > 0 && textures[i].baked.header->format != format)
+      return false;
+    format = textures[i].baked.header->format;
+  }
+  return !textures.empty();
+}
+
+// one level of the array with every layer transparent
+static std::vector<uint8_t>
+make_empty_level(texture_format::Format format, uint32_t width, uint32_t height, int layers)
+{
+  std::vector<uint8_t> level(static_cast<size_t>(texture_format::get_level_size(format, width, height)) * layers, 0);
+
+  // a zeroed bc1 block is opaque black. colours equal, with every index 3, is transparent
+  if (format == texture_format::Format::BC1) {
+    for (size_t block = 0; block < level.size(); block += 8) {
+      for (size_t i = 4; i < 8; i++)
+        level[block + i] = 0xFF;
+    }
+  }
+  return level;
+}
+
+// every level as it was cooked, in the format it was cooked in
+static void
+upload_baked_texture_array(std::vector<StbLoadedTexture>& textures, TextureArray& result, texture_format::Format format)
+{
+  const GLenum internal_format = get_internal_format(format);
+  const bool compressed = format != texture_format::Format::RGBA8;
+  const int layers = static_cast<int>(textures.size());
+
+  uint32_t level_count = 0;
+  for (const StbLoadedTexture& texture : textures)
+    level_count = std::max(level_count, texture.baked.header->level_count);
+
+  // allocate every level of every layer as transparent, so the padding around smaller images is empty
+  for (uint32_t i = 0; i < level_count; i++) {
+    const uint32_t width = std::max(1u, static_cast<uint32_t>(result.width) >> i);
+    const uint32_t height = std::max(1u, static_cast<uint32_t>(result.height) >> i);
+    std::vector<uint8_t> empty = make_empty_level(format, width, height, layers);
+    if (compressed)
+      glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY,
+                             i,
+                             internal_format,
+                             width,
+                             height,
+                             layers,
+                             0,
+                             static_cast<GLsizei>(empty.size()),
+                             empty.data());
+    else
+      glTexImage3D(
+        GL_TEXTURE_2D_ARRAY, i, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, empty.data());
+  }
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+
+  for (int layer = 0; layer < layers; layer++) {
+    StbLoadedTexture& texture = textures[layer];
+    const texture_format::Header& header = *texture.baked.header;
+    std::cout << "  layer " << layer << ": baked " << texture.path << std::endl;
+
+    for (uint32_t i = 0; i < header.level_count; i++) {
+      const texture_format::Level& level = texture.baked.levels[i];
+      const uint8_t* data = texture.baked.data + level.offset;
+      if (!compressed) {
+        glTexSubImage3D(
+          GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        continue;
+      }
+
+      // compressed sub images have to be whole blocks, or reach the edge of the level.
+      // the smallest levels of a smaller layer can be neither, and are left transparent
+      const uint32_t array_width = std::max(1u, static_cast<uint32_t>(result.width) >> i);
+      const uint32_t array_height = std::max(1u, static_cast<uint32_t>(result.height) >> i);
+      if ((level.width % 4 != 0 && level.width != array_width) ||
+          (level.height % 4 != 0 && level.height != array_height))
+        continue;
+      glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+                                i,
+                                0,
+                                0,
+                                layer,
+                                level.width,
+                                level.height,
+                                1,
+                                internal_format,
+                                level.size,
+                                data);
+    }
+
+    result.layer_uv_scale.push_back(glm::vec2(static_cast<float>(texture.width) / result.width,
+                                              static_cast<float>(texture.height) / result.height));
+
+    unmap_file(texture.baked_file);
+    texture.baked = texture_format::TextureView();
+  }
+}
+
+// level 0 of every layer as rgba8, the driver generates the mips
+static void
+upload_texture_array(std::vector<StbLoadedTexture>& textures, TextureArray& result)
+{
+  const int layers = static_cast<int>(textures.size());
+
+  // allocate every layer as transparent, so the padding around smaller images is empty
+  std::vector<unsigned char> empty(static_cast<size_t>(result.width) * result.height * layers * 4, 0);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY,
+               0,
+               GL_RGBA8,
+               result.width,
+               result.height,
+               layers,
+               0,
+               GL_RGBA,
+               GL_UNSIGNED_BYTE,
+               empty.data());
+
+  for (int layer = 0; layer < layers; layer++) {
+    StbLoadedTexture& texture = textures[layer];
+    std::cout << "  layer " << layer << ": " << texture.path << std::endl;
+
+    // a baked rgba8 layer's first level is the image
+    const unsigned char* data = texture.data;
+    if (texture.baked.header != nullptr)
+      data = texture.baked.data + texture.baked.levels[0].offset;
+
+    glTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, texture.width, texture.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+    result.layer_uv_scale.push_back(glm::vec2(static_cast<float>(texture.width) / result.width,
+                                              static_cast<float>(texture.height) / result.height));
+
+    if (texture.baked.header != nullptr) {
+      unmap_file(texture.baked_file);
+      texture.baked = texture_format::TextureView();
+    } else {
+      stbi_image_free(texture.data);
+      texture.data = nullptr;
+    }
+  }
+
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+TextureArray
+bind_stb_loaded_texture_array(std::vector<StbLoadedTexture>& textures, const int texture_unit, const int max_layers)
+{
+  TextureArray result;
+  result.texture_unit = texture_unit;
+
+  int gl_max_layers = 0;
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &gl_max_layers);
+  if (textures.size() > static_cast<size_t>(max_layers) || textures.size() > static_cast<size_t>(gl_max_layers)) {
+    std::cerr << "TOO MANY TEXTURES FOR ARRAY: " << textures.size() << ", the shaders index " << max_layers
+              << " layers and GL_MAX_ARRAY_TEXTURE_LAYERS is " << gl_max_layers << std::endl;
+    exit(1); // note, probs shouldn't do this - fine for dev for myself
+  }
+
+  // the layers share one format, so baked mips are only used if every layer has them in the same one.
+  // otherwise block compressed layers go back to their source image
+  texture_format::Format baked_format = texture_format::Format::RGBA8;
+  const bool baked = get_baked_array_format(textures, baked_format);
+  for (StbLoadedTexture& texture : textures) {
+    if (baked || texture.baked.header == nullptr || texture.baked.header->format == texture_format::Format::RGBA8)
+      continue;
+    unmap_file(texture.baked_file);
+    texture.baked = texture_format::TextureView();
+    if (std::filesystem::path(texture.path).extension() == ".tex") {
+      std::cerr << "baked layers differ in format, and " << texture.path << " has no image to fall back to"
+                << std::endl;
+      continue;
+    }
+    int channels_in_file = 0;
+    texture.data = stbi_load(texture.path.c_str(), &texture.width, &texture.height, &channels_in_file, 4);
+  }
+
+  // Check Stb textures loaded correctly
+  for (StbLoadedTexture& texture : textures) {
+    if ((!texture.data && texture.baked.header == nullptr) || texture.nr_components != 4) {
+      std::cout << "FAILED TO LOAD TEXTURE FOR ARRAY: " << texture.path << std::endl;
+      std::cerr << stbi_failure_reason() << std::endl;
+      exit(1); // note, probs shouldn't do this - fine for dev for myself
+    }
+    result.width = texture.width > result.width ? texture.width : result.width;
+    result.height = texture.height > result.height ? texture.height : result.height;
+  }
+
+  const int layers = static_cast<int>(textures.size());
+  std::cout << "binding texture array (" << layers << " layers, " << result.width << "x" << result.height << ") to "
+            << texture_unit << std::endl;
+
+  glGenTextures(1, &result.id);
+  glActiveTexture(GL_TEXTURE0 + texture_unit);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, result.id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (baked)
+    upload_baked_texture_array(textures, result, baked_format);
+  else
+    upload_texture_array(textures, result);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  return result;
+}
+
 //
 // Util Functions
 //
@@ -81,15 +398,19 @@ bind_stb_loaded_texture(StbLoadedTexture& texture)
 void
 bind_tex(const int id, const int unit)
 {
-  if (unit >= 0)
-    glActiveTexture(GL_TEXTURE0 + unit);
-  glBindTexture(GL_TEXTURE_2D, id);
+  get_render_backend().bind_texture(GL_TEXTURE_2D, id, unit);
 }
 
 void
 unbind_tex()
 {
-  glBindTexture(GL_TEXTURE_2D, 0);
+  get_render_backend().bind_texture(GL_TEXTURE_2D, 0, -1);
+}
+
+void
+bind_tex_array(const int id, const int unit)
+{
+  get_render_backend().bind_texture(GL_TEXTURE_2D_ARRAY, id, unit);
 }
 
 } // namespace fightingengine
\ No newline at end of file
@@ -2,9 +2,15 @@
 
 // c++ standard library headers
 #include <string>
+#include <vector>
 
 // other library headers
 #include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// your project headers
+#include "engine/mapped_file.hpp"
+#include "engine/texture_format.hpp"
 
 namespace fightingengine {
 
@@ -24,15 +30,45 @@ struct StbLoadedTexture
   int texture_unit;
   std::string path;
   unsigned char* data;
+
+  // set instead of data when a baked .tex file was loaded (see tools/texture_cooker)
+  MappedFile baked_file;
+  texture_format::TextureView baked;
+};
+
+// A GL_TEXTURE_2D_ARRAY built from several images.
+// Every layer is the size of the largest image. Smaller images
+// sit in the top-left of their layer and only cover uv_scale of it.
+struct TextureArray
+{
+  unsigned int id = 0;
+  int texture_unit = 0;
+  int width = 0;
+  int height = 0;
+  std::vector<glm::vec2> layer_uv_scale;
 };
 
 // Note: this IS thread safe
+// desired_channels of 0 keeps the channels in the file.
+// with desired_channels of 0 or 4 a baked .tex file (always rgba) is loaded in place of the image,
+// if it's given or there's an up to date one next to it.
 StbLoadedTexture
-load_texture(const int textureUnit, const std::string& path);
+load_texture(const int textureUnit, const std::string& path, const int desired_channels = 0);
 
+// uploads and frees the image. baked textures upload their stored mips as they are,
+// images have theirs generated by the driver.
 void
 bind_stb_loaded_texture(StbLoadedTexture& texture);
 
+// expects every texture to be loaded with 4 channels (RGBA).
+// layer i of the array is textures[i], the texture_unit on each texture is ignored.
+// if every layer is baked in the same format the array is that format, with the baked mips.
+// otherwise the array is rgba8 with driver generated mips.
+// max_layers is how many layers the shaders sampling the array can index;
+// more textures than that, or than GL_MAX_ARRAY_TEXTURE_LAYERS, exits.
+[[nodiscard]] TextureArray
+bind_stb_loaded_texture_array(std::vector<StbLoadedTexture>& textures, const int texture_unit, const int max_layers);
+
 // Texture util functions
 void
 bind_tex(const int id, const int unit = -1);
@@ -40,4 +76,7 @@ bind_tex(const int id, const int unit = -1);
 void
 unbind_tex();
 
+void
+bind_tex_array(const int id, const int unit = -1);
+
 } // namespace fightingengine
@@ -0,0 +1,54 @@
+// header
+#include "engine/opengl/uniform_buffer.hpp"
+
+// c++ standard library headers
+#include <cstdio>
+
+// other library headers
+#include <GL/glew.h>
+
+// your project headers
+#include "engine/opengl/render_backend.hpp"
+
+namespace fightingengine {
+
+UniformBuffer
+create_uniform_buffer(size_t size, unsigned int binding)
+{
+  RenderBackend& backend = get_render_backend();
+
+  UniformBuffer buffer;
+  buffer.id = backend.create_buffer();
+  buffer.binding = binding;
+  buffer.size = size;
+
+  backend.bind_buffer(GL_UNIFORM_BUFFER, buffer.id);
+  backend.buffer_data(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+  backend.bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+  backend.bind_buffer_base(GL_UNIFORM_BUFFER, binding, buffer.id);
+  return buffer;
+}
+
+void
+update_uniform_buffer(const UniformBuffer& buffer, const void* data, size_t size)
+{
+  if (size > buffer.size) {
+    printf("ERROR: uniform buffer update of %zu bytes, buffer is %zu bytes \n", size, buffer.size);
+    return;
+  }
+
+  RenderBackend& backend = get_render_backend();
+  backend.bind_buffer(GL_UNIFORM_BUFFER, buffer.id);
+  backend.buffer_sub_data(GL_UNIFORM_BUFFER, 0, size, data);
+  backend.bind_buffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void
+delete_uniform_buffer(UniformBuffer& buffer)
+{
+  get_render_backend().delete_buffer(buffer.id);
+  buffer = UniformBuffer();
+}
+
+} // namespace fightingengine
@@ -0,0 +1,51 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+
+// other library headers
+#include <glm/glm.hpp>
+
+namespace fightingengine {
+
+//
+// Uniform blocks shared by every program.
+// Shaders declare the block with layout(std140), and the Shader
+// binds it to the matching binding point when the program is linked.
+//
+
+static const unsigned int FRAME_DATA_BINDING = 0;
+static const char* const FRAME_DATA_BLOCK = "FrameData";
+
+// std140: mat4 (64), float (4), bool as int (4), vec2 (8, aligned to 8)
+struct FrameData
+{
+  glm::mat4 projection = glm::mat4(1.0f);
+  float time = 0.0f;
+  int shake = 0;
+  glm::vec2 screen_size = glm::vec2(0.0f);
+};
+static_assert(sizeof(FrameData) == 80, "FrameData must match the std140 layout of the FrameData block");
+
+// mat4 bones[animation::max_bones], one range per skinned instance (see SkinnedModel)
+static const unsigned int BONE_PALETTE_BINDING = 1;
+static const char* const BONE_PALETTE_BLOCK = "BonePalette";
+
+struct UniformBuffer
+{
+  unsigned int id = 0;
+  unsigned int binding = 0;
+  size_t size = 0;
+};
+
+// allocates the buffer and binds it to the binding point
+[[nodiscard]] UniformBuffer
+create_uniform_buffer(size_t size, unsigned int binding);
+
+void
+update_uniform_buffer(const UniformBuffer& buffer, const void* data, size_t size);
+
+void
+delete_uniform_buffer(UniformBuffer& buffer);
+
+} // namespace fightingengine
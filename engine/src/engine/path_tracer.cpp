@@ -0,0 +1,332 @@
+// header
+#include "engine/path_tracer.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cmath>
+
+// your project headers
+#include "engine/maths_core.hpp"
+#include "engine/simd.hpp"
+#include "engine/thread_pool.hpp"
+#include "engine/tools/profiler.hpp"
+
+namespace fightingengine {
+
+namespace path_tracer {
+
+static const float epsilon = 0.0001f;   // EPSILON in raytraced.glsl
+static const float large_float = 1e10f; // LARGE_FLOAT
+
+// 4 rays, one per lane
+struct Packet
+{
+  float4 ox, oy, oz;
+  float4 dx, dy, dz;
+  float4 ix, iy, iz; // 1 / direction, for the slab test
+};
+
+static Packet
+make_packet(const glm::vec3 origins[4], const glm::vec3 directions[4])
+{
+  Packet p;
+  p.ox = float4(origins[0].x, origins[1].x, origins[2].x, origins[3].x);
+  p.oy = float4(origins[0].y, origins[1].y, origins[2].y, origins[3].y);
+  p.oz = float4(origins[0].z, origins[1].z, origins[2].z, origins[3].z);
+  p.dx = float4(directions[0].x, directions[1].x, directions[2].x, directions[3].x);
+  p.dy = float4(directions[0].y, directions[1].y, directions[2].y, directions[3].y);
+  p.dz = float4(directions[0].z, directions[1].z, directions[2].z, directions[3].z);
+  const float4 one(1.0f);
+  p.ix = one / p.dx;
+  p.iy = one / p.dy;
+  p.iz = one / p.dz;
+  return p;
+}
+
+// a mask with the lanes set in bits
+static float4
+lane_mask(int bits)
+{
+  return float4(bits & 1 ? 1.0f : 0.0f, bits & 2 ? 1.0f : 0.0f, bits & 4 ? 1.0f : 0.0f, bits & 8 ? 1.0f : 0.0f) >
+         float4(0.0f);
+}
+
+// the lanes that enter the box before their closest hit so far
+static float4
+intersect_box(const bvh::Node& node, const Packet& p, float4 closest)
+{
+  const float4 t0x = (float4(node.min.x) - p.ox) * p.ix;
+  const float4 t1x = (float4(node.max.x) - p.ox) * p.ix;
+  const float4 t0y = (float4(node.min.y) - p.oy) * p.iy;
+  const float4 t1y = (float4(node.max.y) - p.oy) * p.iy;
+  const float4 t0z = (float4(node.min.z) - p.oz) * p.iz;
+  const float4 t1z = (float4(node.max.z) - p.oz) * p.iz;
+  const float4 near = max(max(min(t0x, t1x), min(t0y, t1y)), min(t0z, t1z));
+  const float4 far = min(min(max(t0x, t1x), max(t0y, t1y)), max(t0z, t1z));
+  return (far >= max(near, float4(0.0f))) & (near < closest);
+}
+
+// bvh::intersect_triangle() for 4 rays
+static float4
+intersect_triangle(const bvh::Triangle& triangle, const Packet& p, float4& t)
+{
+  const glm::vec3 e1 = triangle.v1 - triangle.v0;
+  const glm::vec3 e2 = triangle.v2 - triangle.v0;
+  const float4 e1x(e1.x), e1y(e1.y), e1z(e1.z);
+  const float4 e2x(e2.x), e2y(e2.y), e2z(e2.z);
+
+  const float4 px = p.dy * e2z - p.dz * e2y;
+  const float4 py = p.dz * e2x - p.dx * e2z;
+  const float4 pz = p.dx * e2y - p.dy * e2x;
+  const float4 det = e1x * px + e1y * py + e1z * pz;
+  float4 mask = abs(det) >= float4(epsilon);
+  const float4 inv_det = float4(1.0f) / det;
+
+  const float4 tx = p.ox - float4(triangle.v0.x);
+  const float4 ty = p.oy - float4(triangle.v0.y);
+  const float4 tz = p.oz - float4(triangle.v0.z);
+  const float4 u = (tx * px + ty * py + tz * pz) * inv_det;
+  mask = mask & (u >= float4(0.0f)) & (u <= float4(1.0f));
+
+  const float4 qx = ty * e1z - tz * e1y;
+  const float4 qy = tz * e1x - tx * e1z;
+  const float4 qz = tx * e1y - ty * e1x;
+  const float4 v = (p.dx * qx + p.dy * qy + p.dz * qz) * inv_det;
+  mask = mask & (v >= float4(0.0f)) & (u + v <= float4(1.0f));
+
+  t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+  return mask & (t > float4(epsilon));
+}
+
+// hit_sphere() in raytraced.glsl only counts rays entering the sphere, which is always the near root
+static float4
+intersect_sphere(const Sphere& sphere, const Packet& p, float4& t)
+{
+  const float4 ocx = p.ox - float4(sphere.position.x);
+  const float4 ocy = p.oy - float4(sphere.position.y);
+  const float4 ocz = p.oz - float4(sphere.position.z);
+  const float4 a = p.dx * p.dx + p.dy * p.dy + p.dz * p.dz;
+  const float4 half_b = ocx * p.dx + ocy * p.dy + ocz * p.dz;
+  const float4 c = ocx * ocx + ocy * ocy + ocz * ocz - float4(sphere.radius * sphere.radius);
+  const float4 discriminant = half_b * half_b - a * c;
+
+  t = (float4(0.0f) - half_b - sqrt(max(discriminant, float4(0.0f)))) / a;
+  return (discriminant > float4(0.0f)) & (t > float4(epsilon));
+}
+
+void
+intersect_packet(const Scene& scene, const glm::vec3 origins[4], const glm::vec3 directions[4], int active, PacketHit& hit)
+{
+  hit = PacketHit();
+  const Packet p = make_packet(origins, directions);
+  const float4 active_lanes = lane_mask(active);
+  float4 closest(large_float);
+
+  for (size_t s = 0; s < scene.spheres.size(); s++) {
+    float4 t;
+    const float4 hits = intersect_sphere(scene.spheres[s], p, t);
+    const float4 mask = hits & active_lanes & (t < closest);
+    const int bits = movemask(mask);
+    if (bits == 0)
+      continue;
+    closest = select(mask, t, closest);
+    for (int lane = 0; lane < 4; lane++) {
+      if (bits & (1 << lane)) {
+        hit.sphere[lane] = static_cast<int>(s);
+        hit.triangle[lane] = -1;
+      }
+    }
+  }
+
+  // the same stackless walk as bvh::intersect(), into a node if any lane wants it
+  const std::vector<bvh::Node>& nodes = scene.tree.nodes;
+  const uint32_t node_count = static_cast<uint32_t>(nodes.size());
+  uint32_t i = 0;
+  while (i < node_count) {
+    const bvh::Node& node = nodes[i];
+    const bool leaf = node.count > 0;
+
+    if (movemask(intersect_box(node, p, closest) & active_lanes) == 0) {
+      i = leaf ? i + 1 : node.index;
+      continue;
+    }
+
+    if (leaf) {
+      for (uint32_t j = node.index; j < node.index + node.count; j++) {
+        const uint32_t triangle = scene.tree.indices[j];
+        float4 t;
+        const float4 hits = intersect_triangle(scene.triangles[triangle], p, t);
+        const float4 mask = hits & active_lanes & (t < closest);
+        const int bits = movemask(mask);
+        if (bits == 0)
+          continue;
+        closest = select(mask, t, closest);
+        for (int lane = 0; lane < 4; lane++) {
+          if (bits & (1 << lane)) {
+            hit.triangle[lane] = static_cast<int>(triangle);
+            hit.sphere[lane] = -1;
+          }
+        }
+      }
+    }
+    i += 1;
+  }
+
+  for (int lane = 0; lane < 4; lane++)
+    hit.distance[lane] = (hit.sphere[lane] >= 0 || hit.triangle[lane] >= 0) ? closest[lane] : 0.0f;
+}
+
+void
+build_scene(Scene& scene, ThreadPool& pool)
+{
+  scene.tree = bvh::build(scene.triangles, pool);
+  scene.triangle_materials.resize(scene.triangles.size());
+}
+
+void
+reset_film(Film& film, int width, int height)
+{
+  film.width = width;
+  film.height = height;
+  film.samples = 0;
+  film.accumulated.assign(static_cast<size_t>(width) * height, glm::vec3(0.0f));
+}
+
+static glm::vec3
+sky_colour(const glm::vec3& direction)
+{
+  const float t = 0.5f * (glm::normalize(direction).y + 1.0f);
+  return (1.0f - t) * glm::vec3(1.0f, 1.0f, 1.0f) + t * glm::vec3(0.5f, 0.7f, 1.0f);
+}
+
+// traces the 2x2 pixels with their top left at x, y
+static void
+trace_quad(const Scene& scene, const View& view, const Settings& settings, Film& film, int x, int y, RandomState& rnd)
+{
+  glm::vec3 origins[4];
+  glm::vec3 directions[4];
+  glm::vec3 throughput[4];
+  glm::vec3 radiance[4];
+  size_t pixels[4] = { 0, 0, 0, 0 };
+  int active = 0;
+
+  for (int lane = 0; lane < 4; lane++) {
+    const int px = x + (lane & 1);
+    const int py = y + (lane >> 1);
+    origins[lane] = view.eye;
+    directions[lane] = glm::vec3(0.0f, 0.0f, -1.0f);
+    throughput[lane] = glm::vec3(1.0f);
+    radiance[lane] = glm::vec3(0.0f);
+    if (px >= film.width || py >= film.height)
+      continue;
+
+    // jittered within the pixel, so the samples antialias
+    const float jitter_x = rand_det_s(rnd.rng, 0.0f, 1.0f);
+    const float jitter_y = rand_det_s(rnd.rng, 0.0f, 1.0f);
+    const glm::vec2 p = glm::vec2(px + jitter_x, py + jitter_y) / glm::vec2(film.width, film.height);
+    directions[lane] = glm::mix(glm::mix(view.ray00, view.ray01, p.y), glm::mix(view.ray10, view.ray11, p.y), p.x);
+    pixels[lane] = static_cast<size_t>(py) * film.width + px;
+    active |= 1 << lane;
+  }
+  const int pixels_active = active;
+
+  for (int bounce = 0; bounce < settings.max_bounces && active != 0; bounce++) {
+    PacketHit hit;
+    intersect_packet(scene, origins, directions, active, hit);
+
+    for (int lane = 0; lane < 4; lane++) {
+      if ((active & (1 << lane)) == 0)
+        continue;
+
+      if (hit.sphere[lane] < 0 && hit.triangle[lane] < 0) {
+        radiance[lane] += throughput[lane] * sky_colour(directions[lane]);
+        active &= ~(1 << lane);
+        continue;
+      }
+
+      const glm::vec3 point = origins[lane] + directions[lane] * hit.distance[lane];
+      glm::vec3 normal;
+      Material material;
+      if (hit.sphere[lane] >= 0) {
+        const Sphere& sphere = scene.spheres[hit.sphere[lane]];
+        normal = (point - sphere.position) / sphere.radius;
+        material = sphere.material;
+      } else {
+        const bvh::Triangle& triangle = scene.triangles[hit.triangle[lane]];
+        normal = glm::normalize(glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0));
+        // triangles are two sided
+        if (glm::dot(normal, directions[lane]) > 0.0f)
+          normal = -normal;
+        material = scene.triangle_materials[hit.triangle[lane]];
+      }
+
+      glm::vec3 scattered;
+      if (material.type == MaterialType::Metal) {
+        const glm::vec3 d = glm::normalize(directions[lane]);
+        scattered = d - 2.0f * glm::dot(d, normal) * normal + material.metal_fuzz * rand_unit_vector(rnd);
+        if (glm::dot(scattered, normal) <= 0.0f) {
+          active &= ~(1 << lane); // absorbed
+          continue;
+        }
+      } else {
+        scattered = normal + rand_unit_vector(rnd);
+      }
+
+      throughput[lane] *= material.albedo_colour;
+      origins[lane] = point;
+      directions[lane] = scattered;
+    }
+  }
+  // anything still bouncing after max_bounces stays black, as in raytraced.glsl
+
+  for (int lane = 0; lane < 4; lane++) {
+    if (pixels_active & (1 << lane))
+      film.accumulated[pixels[lane]] += radiance[lane];
+  }
+}
+
+void
+render_sample(const Scene& scene, const View& view, const Settings& settings, Film& film, ThreadPool& pool)
+{
+  const int tile_size = std::max(2, settings.tile_size & ~1);
+  const int tiles_x = (film.width + tile_size - 1) / tile_size;
+  const int tiles_y = (film.height + tile_size - 1) / tile_size;
+
+  // each tile owns its pixels, so the film is written without locks
+  pool.parallel_for(static_cast<size_t>(tiles_x) * tiles_y, 1, [&](size_t begin, size_t end) {
+    for (size_t tile = begin; tile < end; tile++) {
+      PROFILE_ZONE("path_tracer tile");
+      // seeded by tile and sample, so the image doesn't depend on which thread ran what
+      RandomState rnd;
+      rnd.rng.seed(static_cast<uint32_t>(tile * 7919 + film.samples * 104729 + 1));
+
+      const int x0 = static_cast<int>(tile % tiles_x) * tile_size;
+      const int y0 = static_cast<int>(tile / tiles_x) * tile_size;
+      const int x1 = std::min(x0 + tile_size, film.width);
+      const int y1 = std::min(y0 + tile_size, film.height);
+      for (int y = y0; y < y1; y += 2) {
+        for (int x = x0; x < x1; x += 2)
+          trace_quad(scene, view, settings, film, x, y, rnd);
+      }
+    }
+  });
+
+  film.samples += 1;
+}
+
+void
+resolve_film(const Film& film, std::vector<uint8_t>& rgba)
+{
+  rgba.resize(film.accumulated.size() * 4);
+  const float scale = film.samples > 0 ? 1.0f / film.samples : 0.0f;
+  for (size_t i = 0; i < film.accumulated.size(); i++) {
+    const glm::vec3 colour = film.accumulated[i] * scale;
+    for (int c = 0; c < 3; c++)
+      rgba[i * 4 + c] = static_cast<uint8_t>(glm::clamp(std::sqrt(colour[c]), 0.0f, 1.0f) * 255.0f + 0.5f);
+    rgba[i * 4 + 3] = 255;
+  }
+}
+
+} // namespace path_tracer
+
+} // namespace fightingengine
@@ -0,0 +1,109 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstdint>
+#include <vector>
+
+// other library headers
+#include <glm/glm.hpp>
+
+// your project headers
+#include "engine/bvh.hpp"
+
+namespace fightingengine {
+
+class ThreadPool;
+
+//
+// Reference path tracer on the cpu, the same scene model as raytraced.glsl:
+// diffuse and metal spheres, and diffuse triangles in a bvh, lit by the sky.
+// Rays are traced 4 at a time (2x2 pixels, see float4) and the image is split in to
+// tiles across the thread pool. Each render_sample() adds one more sample per pixel
+// to the film, so the image converges the longer it runs.
+//
+
+namespace path_tracer {
+
+enum class MaterialType
+{
+  Diffuse, // MATERIAL_DIFFUSE
+  Metal,   // MATERIAL_METAL
+};
+
+struct Material
+{
+  MaterialType type = MaterialType::Diffuse;
+  glm::vec3 albedo_colour = glm::vec3(0.9f, 0.2f, 0.2f);
+  float metal_fuzz = 0.0f;
+};
+
+struct Sphere
+{
+  glm::vec3 position = glm::vec3(0.0f);
+  float radius = 1.0f;
+  Material material;
+};
+
+struct Scene
+{
+  std::vector<Sphere> spheres;
+  std::vector<bvh::Triangle> triangles;
+  std::vector<Material> triangle_materials; // one per triangle
+  bvh::Tree tree;                           // over triangles, see build_scene()
+};
+
+// builds the triangles' bvh, call again after changing them
+void
+build_scene(Scene& scene, ThreadPool& pool);
+
+// the same frustum corner rays the compute shader takes (see Camera::get_eye_ray())
+struct View
+{
+  glm::vec3 eye = glm::vec3(0.0f);
+  glm::vec3 ray00 = glm::vec3(-1.0f, -1.0f, -1.0f);
+  glm::vec3 ray01 = glm::vec3(-1.0f, 1.0f, -1.0f);
+  glm::vec3 ray10 = glm::vec3(1.0f, -1.0f, -1.0f);
+  glm::vec3 ray11 = glm::vec3(1.0f, 1.0f, -1.0f);
+};
+
+struct Settings
+{
+  int tile_size = 32; // pixels, even
+  int max_bounces = 8;
+};
+
+// accumulated radiance, reset when the view or scene changes
+struct Film
+{
+  int width = 0;
+  int height = 0;
+  uint32_t samples = 0; // per pixel
+  std::vector<glm::vec3> accumulated;
+};
+
+void
+reset_film(Film& film, int width, int height);
+
+// adds one sample to every pixel
+void
+render_sample(const Scene& scene, const View& view, const Settings& settings, Film& film, ThreadPool& pool);
+
+// the average so far, gamma corrected (gamma 2, as raytraced.glsl) to rgba8, bottom row first
+void
+resolve_film(const Film& film, std::vector<uint8_t>& rgba);
+
+// the closest hit for each of 4 rays, in lanes where active is set.
+// distance is 0 where nothing was hit. exposed for tests and bakers.
+struct PacketHit
+{
+  float distance[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  int sphere[4] = { -1, -1, -1, -1 };   // index in to Scene::spheres
+  int triangle[4] = { -1, -1, -1, -1 }; // index in to Scene::triangles
+};
+
+void
+intersect_packet(const Scene& scene, const glm::vec3 origins[4], const glm::vec3 directions[4], int active, PacketHit& hit);
+
+} // namespace path_tracer
+
+} // namespace fightingengine
@@ -0,0 +1,305 @@
+#pragma once
+
+// c++ standard library headers
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIGHTINGENGINE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace fightingengine {
+
+//
+// Four floats operated on together, one per lane.
+// SSE where it's available, otherwise plain loops the compiler can vectorise.
+// Comparisons return a mask (all bits set in the lanes where it's true).
+//
+
+#ifdef FIGHTINGENGINE_SSE
+
+struct float4
+{
+  __m128 v;
+
+  float4() = default;
+  float4(__m128 v)
+    : v(v){};
+  explicit float4(float s)
+    : v(_mm_set1_ps(s)){};
+  float4(float a, float b, float c, float d)
+    : v(_mm_setr_ps(a, b, c, d)){};
+
+  [[nodiscard]] float operator[](int lane) const
+  {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return lanes[lane];
+  };
+};
+
+inline float4
+operator+(float4 a, float4 b)
+{
+  return _mm_add_ps(a.v, b.v);
+}
+
+inline float4
+operator-(float4 a, float4 b)
+{
+  return _mm_sub_ps(a.v, b.v);
+}
+
+inline float4
+operator*(float4 a, float4 b)
+{
+  return _mm_mul_ps(a.v, b.v);
+}
+
+inline float4
+operator/(float4 a, float4 b)
+{
+  return _mm_div_ps(a.v, b.v);
+}
+
+inline float4
+operator&(float4 a, float4 b)
+{
+  return _mm_and_ps(a.v, b.v);
+}
+
+inline float4
+operator|(float4 a, float4 b)
+{
+  return _mm_or_ps(a.v, b.v);
+}
+
+inline float4
+operator<(float4 a, float4 b)
+{
+  return _mm_cmplt_ps(a.v, b.v);
+}
+
+inline float4
+operator<=(float4 a, float4 b)
+{
+  return _mm_cmple_ps(a.v, b.v);
+}
+
+inline float4
+operator>(float4 a, float4 b)
+{
+  return _mm_cmpgt_ps(a.v, b.v);
+}
+
+inline float4
+operator>=(float4 a, float4 b)
+{
+  return _mm_cmpge_ps(a.v, b.v);
+}
+
+inline float4
+min(float4 a, float4 b)
+{
+  return _mm_min_ps(a.v, b.v);
+}
+
+inline float4
+max(float4 a, float4 b)
+{
+  return _mm_max_ps(a.v, b.v);
+}
+
+inline float4
+abs(float4 a)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v);
+}
+
+inline float4
+sqrt(float4 a)
+{
+  return _mm_sqrt_ps(a.v);
+}
+
+// mask ? a : b
+inline float4
+select(float4 mask, float4 a, float4 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+
+// bit n set for lane n
+inline int
+movemask(float4 mask)
+{
+  return _mm_movemask_ps(mask.v);
+}
+
+#else
+
+struct float4
+{
+  float v[4];
+
+  float4() = default;
+  explicit float4(float s)
+    : v{ s, s, s, s } {};
+  float4(float a, float b, float c, float d)
+    : v{ a, b, c, d } {};
+
+  [[nodiscard]] float operator[](int lane) const { return v[lane]; };
+};
+
+namespace simd_detail {
+
+template<typename F>
+inline float4
+map(float4 a, float4 b, F f)
+{
+  return float4(f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3]));
+}
+
+// the bits of mask lanes go through memcpy, reading another union member is undefined in c++
+
+// a float with every bit set, for masks
+inline float
+all_bits(bool set)
+{
+  const uint32_t bits = set ? 0xFFFFFFFFu : 0u;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+inline bool
+is_set(float lane)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &lane, sizeof(bits));
+  return (bits & 0x80000000u) != 0;
+}
+
+inline float
+bitwise(float a, float b, bool is_and)
+{
+  uint32_t x;
+  uint32_t y;
+  std::memcpy(&x, &a, sizeof(x));
+  std::memcpy(&y, &b, sizeof(y));
+  x = is_and ? (x & y) : (x | y);
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+} // namespace simd_detail
+
+inline float4
+operator+(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x + y; });
+}
+
+inline float4
+operator-(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x - y; });
+}
+
+inline float4
+operator*(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x * y; });
+}
+
+inline float4
+operator/(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x / y; });
+}
+
+inline float4
+operator&(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::bitwise(x, y, true); });
+}
+
+inline float4
+operator|(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::bitwise(x, y, false); });
+}
+
+inline float4
+operator<(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::all_bits(x < y); });
+}
+
+inline float4
+operator<=(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::all_bits(x <= y); });
+}
+
+inline float4
+operator>(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::all_bits(x > y); });
+}
+
+inline float4
+operator>=(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return simd_detail::all_bits(x >= y); });
+}
+
+// like minps/maxps, the second operand wins when either is nan
+inline float4
+min(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x < y ? x : y; });
+}
+
+inline float4
+max(float4 a, float4 b)
+{
+  return simd_detail::map(a, b, [](float x, float y) { return x > y ? x : y; });
+}
+
+inline float4
+abs(float4 a)
+{
+  return float4(std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3]));
+}
+
+inline float4
+sqrt(float4 a)
+{
+  return float4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]));
+}
+
+inline float4
+select(float4 mask, float4 a, float4 b)
+{
+  float4 out;
+  for (int i = 0; i < 4; i++)
+    out.v[i] = simd_detail::is_set(mask.v[i]) ? a.v[i] : b.v[i];
+  return out;
+}
+
+inline int
+movemask(float4 mask)
+{
+  int bits = 0;
+  for (int i = 0; i < 4; i++)
+    bits |= simd_detail::is_set(mask.v[i]) ? (1 << i) : 0;
+  return bits;
+}
+
+#endif
+
+} // namespace fightingengine
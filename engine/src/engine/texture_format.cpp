@@ -0,0 +1,236 @@
+// header
+#include "engine/texture_format.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace fightingengine {
+
+namespace texture_format {
+
+static uint32_t
+align_16(uint32_t offset)
+{
+  return (offset + 15u) & ~15u;
+}
+
+uint32_t
+get_level_size(Format format, uint32_t width, uint32_t height)
+{
+  const uint32_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+  switch (format) {
+    case Format::BC1:
+      return blocks * 8;
+    case Format::BC3:
+      return blocks * 16;
+    case Format::RGBA8:
+    default:
+      return width * height * 4;
+  }
+}
+
+uint32_t
+get_level_count(uint32_t width, uint32_t height)
+{
+  uint32_t count = 1;
+  while (width > 1 || height > 1) {
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+    count += 1;
+  }
+  return count;
+}
+
+//
+// Mips
+//
+
+static float
+srgb_to_linear(float c)
+{
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float
+linear_to_srgb(float c)
+{
+  return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static uint8_t
+to_unorm8(float value)
+{
+  return static_cast<uint8_t>(std::lround(std::max(0.0f, std::min(1.0f, value)) * 255.0f));
+}
+
+// each texel of the smaller image covers [x * w / dw, (x + 1) * w / dw) of the larger,
+// so odd sizes fold their last row and column in to the edge texels instead of dropping them
+static Image
+downsample(const Image& source, bool srgb, const float to_linear[256])
+{
+  Image result;
+  result.width = std::max(1u, source.width / 2);
+  result.height = std::max(1u, source.height / 2);
+  result.rgba.resize(static_cast<size_t>(result.width) * result.height * 4);
+
+  for (uint32_t y = 0; y < result.height; y++) {
+    const uint32_t y0 = y * source.height / result.height;
+    const uint32_t y1 = (y + 1) * source.height / result.height;
+    for (uint32_t x = 0; x < result.width; x++) {
+      const uint32_t x0 = x * source.width / result.width;
+      const uint32_t x1 = (x + 1) * source.width / result.width;
+
+      float colour[3] = { 0.0f, 0.0f, 0.0f };
+      float weighted[3] = { 0.0f, 0.0f, 0.0f };
+      float alpha = 0.0f;
+      for (uint32_t sy = y0; sy < y1; sy++) {
+        for (uint32_t sx = x0; sx < x1; sx++) {
+          const uint8_t* texel = &source.rgba[(static_cast<size_t>(sy) * source.width + sx) * 4];
+          const float a = texel[3] / 255.0f;
+          for (int c = 0; c < 3; c++) {
+            const float value = srgb ? to_linear[texel[c]] : texel[c] / 255.0f;
+            colour[c] += value;
+            weighted[c] += value * a;
+          }
+          alpha += a;
+        }
+      }
+
+      const float texels = static_cast<float>((x1 - x0) * (y1 - y0));
+      uint8_t* out = &result.rgba[(static_cast<size_t>(y) * result.width + x) * 4];
+      for (int c = 0; c < 3; c++) {
+        // fully transparent areas keep their plain average, there's nothing to weight by
+        const float value = alpha > 0.0f ? weighted[c] / alpha : colour[c] / texels;
+        out[c] = to_unorm8(srgb ? linear_to_srgb(value) : value);
+      }
+      out[3] = to_unorm8(alpha / texels);
+    }
+  }
+  return result;
+}
+
+std::vector<Image>
+generate_mips(const Image& base, bool srgb)
+{
+  float to_linear[256];
+  for (int i = 0; i < 256; i++)
+    to_linear[i] = srgb_to_linear(i / 255.0f);
+
+  std::vector<Image> levels;
+  levels.reserve(get_level_count(base.width, base.height));
+  levels.push_back(base);
+  while (levels.back().width > 1 || levels.back().height > 1)
+    levels.push_back(downsample(levels.back(), srgb, to_linear));
+  return levels;
+}
+
+//
+// Files
+//
+
+bool
+write(const std::string& path, const TextureData& texture)
+{
+  Header header;
+  std::memcpy(header.magic, magic, 4);
+  header.version = version;
+  header.format = texture.format;
+  header.width = texture.width;
+  header.height = texture.height;
+  header.level_count = static_cast<uint32_t>(texture.levels.size());
+
+  std::vector<Level> levels(texture.levels.size());
+  uint32_t offset = align_16(sizeof(Header) + header.level_count * sizeof(Level));
+  uint32_t width = texture.width;
+  uint32_t height = texture.height;
+  for (size_t i = 0; i < levels.size(); i++) {
+    levels[i].offset = offset;
+    levels[i].size = static_cast<uint32_t>(texture.levels[i].size());
+    levels[i].width = width;
+    levels[i].height = height;
+    if (levels[i].size != get_level_size(texture.format, width, height)) {
+      std::cerr << "texture: level " << i << " is the wrong size for " << width << "x" << height << std::endl;
+      return false;
+    }
+    offset = align_16(offset + levels[i].size);
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "texture: could not write " << path << std::endl;
+    return false;
+  }
+
+  const char padding[16] = {};
+  auto pad_to = [&](uint32_t offset) {
+    size_t at = static_cast<size_t>(out.tellp());
+    out.write(padding, offset - at);
+  };
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(Level));
+  for (size_t i = 0; i < levels.size(); i++) {
+    pad_to(levels[i].offset);
+    out.write(reinterpret_cast<const char*>(texture.levels[i].data()), texture.levels[i].size());
+  }
+
+  return out.good();
+}
+
+bool
+parse(const uint8_t* data, size_t size, TextureView& view)
+{
+  if (data == nullptr || size < sizeof(Header))
+    return false;
+
+  const Header* header = reinterpret_cast<const Header*>(data);
+  if (std::memcmp(header->magic, magic, 4) != 0 || header->version != version) {
+    std::cerr << "texture: not a v" << version << " texture file" << std::endl;
+    return false;
+  }
+  if (header->format != Format::RGBA8 && header->format != Format::BC1 && header->format != Format::BC3) {
+    std::cerr << "texture: unknown format" << std::endl;
+    return false;
+  }
+  if (header->width == 0 || header->height == 0 || header->level_count == 0 ||
+      header->level_count > get_level_count(header->width, header->height)) {
+    std::cerr << "texture: bad size or level count" << std::endl;
+    return false;
+  }
+  if (sizeof(Header) + uint64_t(header->level_count) * sizeof(Level) > size) {
+    std::cerr << "texture: file is truncated" << std::endl;
+    return false;
+  }
+
+  view.header = header;
+  view.levels = reinterpret_cast<const Level*>(data + sizeof(Header));
+  view.data = data;
+
+  uint32_t width = header->width;
+  uint32_t height = header->height;
+  for (uint32_t i = 0; i < header->level_count; i++) {
+    const Level& level = view.levels[i];
+    if (level.width != width || level.height != height ||
+        level.size != get_level_size(header->format, width, height)) {
+      std::cerr << "texture: level " << i << " has the wrong size" << std::endl;
+      return false;
+    }
+    if (level.offset % 4 != 0 || uint64_t(level.offset) + level.size > size) {
+      std::cerr << "texture: file is truncated" << std::endl;
+      return false;
+    }
+    width = std::max(1u, width / 2);
+    height = std::max(1u, height / 2);
+  }
+  return true;
+}
+
+} // namespace texture_format
+
+} // namespace fightingengine
@@ -0,0 +1,103 @@
+#pragma once
+
+// c++ standard library headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fightingengine {
+
+//
+// Baked texture files (.tex), written offline by tools/texture_cooker.
+// Like .mesh files the file is the gpu upload: the whole mip chain,
+// already filtered and optionally block compressed, one blob per level.
+//
+// Layout (little endian, levels 16 byte aligned)
+//
+// Header
+// Level[level_count]   at sizeof(Header)
+// level data           at each Level::offset, largest level first
+//
+
+namespace texture_format {
+
+static const char magic[4] = { 'T', 'E', 'X', ' ' };
+static const uint32_t version = 1;
+
+enum class Format : uint32_t
+{
+  RGBA8 = 0, // uncompressed
+  BC1 = 1,   // DXT1, 8 bytes per 4x4 block, rgb with 1 bit alpha
+  BC3 = 2,   // DXT5, 16 bytes per 4x4 block, rgba
+};
+
+struct Header
+{
+  char magic[4];
+  uint32_t version = 0;
+  Format format = Format::RGBA8;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t level_count = 0;
+  uint32_t reserved[2] = { 0, 0 };
+};
+static_assert(sizeof(Header) == 32, "texture header layout changed, bump the version");
+
+struct Level
+{
+  uint32_t offset = 0; // bytes from the start of the file
+  uint32_t size = 0;   // bytes
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+static_assert(sizeof(Level) == 16, "texture level layout changed, bump the version");
+
+// an uncompressed rgba8 image
+struct Image
+{
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<uint8_t> rgba;
+};
+
+struct TextureData
+{
+  Format format = Format::RGBA8;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<std::vector<uint8_t>> levels; // already in format, largest first
+};
+
+// pointers in to a file's bytes, valid while the bytes are
+struct TextureView
+{
+  const Header* header = nullptr;
+  const Level* levels = nullptr;
+  const uint8_t* data = nullptr; // the start of the file, add Level::offset
+};
+
+// bytes for one level of a width x height image
+[[nodiscard]] uint32_t
+get_level_size(Format format, uint32_t width, uint32_t height);
+
+[[nodiscard]] uint32_t
+get_level_count(uint32_t width, uint32_t height);
+
+// the full mip chain down to 1x1, starting with a copy of base.
+// each level is a box filter of the one above, weighted by alpha so transparent
+// texels don't bleed in to the colour. srgb averages in linear space, use
+// false for data such as normal maps.
+[[nodiscard]] std::vector<Image>
+generate_mips(const Image& base, bool srgb);
+
+[[nodiscard]] bool
+write(const std::string& path, const TextureData& texture);
+
+// checks the header, and that every level is inside the file and the right size
+[[nodiscard]] bool
+parse(const uint8_t* data, size_t size, TextureView& view);
+
+} // namespace texture_format
+
+} // namespace fightingengine
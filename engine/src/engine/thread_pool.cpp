@@ -0,0 +1,127 @@
+// header
+#include "engine/thread_pool.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+// your project headers
+#include "engine/tools/profiler.hpp"
+
+namespace fightingengine {
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+  workers.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; i++)
+    workers.emplace_back([this, i]() {
+      profiler::set_thread_name("worker " + std::to_string(i));
+      worker_loop();
+    });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  job_ready.notify_all();
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+size_t
+ThreadPool::default_worker_count()
+{
+  const size_t cores = std::thread::hardware_concurrency();
+  return cores > 1 ? cores - 1 : 0;
+}
+
+bool
+ThreadPool::run_next_chunk()
+{
+  size_t begin = 0;
+  size_t end = 0;
+  const std::function<void(size_t, size_t)>* fn = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (job == nullptr || next_chunk >= job_count)
+      return false;
+    begin = next_chunk;
+    end = std::min(begin + job_chunk_size, job_count);
+    next_chunk = end;
+    fn = job;
+  }
+
+  (*fn)(begin, end);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    chunks_left -= 1;
+    if (chunks_left == 0)
+      job_done.notify_all();
+  }
+  return true;
+}
+
+void
+ThreadPool::worker_loop()
+{
+  size_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_ready.wait(lock, [&]() { return stopping || job_generation != seen_generation; });
+      if (stopping)
+        return;
+      seen_generation = job_generation;
+    }
+    while (run_next_chunk()) {
+    }
+  }
+}
+
+void
+ThreadPool::parallel_for(size_t count, size_t chunk_size, const std::function<void(size_t begin, size_t end)>& fn)
+{
+  if (count == 0)
+    return;
+  chunk_size = std::max<size_t>(chunk_size, 1);
+
+  // not worth waking anyone for
+  if (workers.empty() || count <= chunk_size) {
+    fn(0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // a second job would overwrite the one being run, nested or from another thread
+    assert(job == nullptr && "ThreadPool::parallel_for() is not reentrant or thread safe");
+    job = &fn;
+    job_count = count;
+    job_chunk_size = chunk_size;
+    next_chunk = 0;
+    chunks_left = (count + chunk_size - 1) / chunk_size;
+    job_generation += 1;
+  }
+  job_ready.notify_all();
+
+  while (run_next_chunk()) {
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  job_done.wait(lock, [&]() { return chunks_left == 0; });
+  job = nullptr;
+}
+
+ThreadPool&
+get_thread_pool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+} // namespace fightingengine
@@ -0,0 +1,64 @@
+#pragma once
+
+// c++ standard library headers
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fightingengine {
+
+//
+// A fixed set of worker threads for splitting a loop across cores.
+// parallel_for() blocks until every chunk is done, and the calling thread
+// works on chunks too, so a pool of 0 workers just runs the loop inline.
+//
+// A pool runs one job at a time. parallel_for() is not reentrant (fn can't call it on the same pool),
+// and only one thread at a time may call it. Both are asserted in debug builds.
+//
+
+class ThreadPool
+{
+public:
+  // defaults to one worker per core, minus the calling thread
+  explicit ThreadPool(size_t workers = default_worker_count());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // calls fn(begin, end) over [0, count) in chunks of at most chunk_size.
+  // not reentrant, and not safe to call from two threads at once, see above
+  void parallel_for(size_t count, size_t chunk_size, const std::function<void(size_t begin, size_t end)>& fn);
+
+  [[nodiscard]] size_t get_worker_count() const { return workers.size(); };
+
+  [[nodiscard]] static size_t default_worker_count();
+
+private:
+  void worker_loop();
+  // returns false once there are no chunks left in the current job
+  bool run_next_chunk();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable job_ready;
+  std::condition_variable job_done;
+  bool stopping = false;
+
+  // the current job
+  const std::function<void(size_t, size_t)>* job = nullptr;
+  size_t job_count = 0;
+  size_t job_chunk_size = 1;
+  size_t next_chunk = 0; // next begin index handed out
+  size_t chunks_left = 0;
+  size_t job_generation = 0;
+};
+
+// shared by the engine's systems, created on first use
+[[nodiscard]] ThreadPool&
+get_thread_pool();
+
+} // namespace fightingengine
@@ -0,0 +1,198 @@
+
+// header
+#include "engine/tools/metrics.hpp"
+
+// c++ standard library headers
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace fightingengine {
+
+namespace metrics {
+
+struct metrics_data
+{
+  std::vector<Metric> metrics;
+  uint64_t frame = 0;
+  uint32_t history_frames = metrics::history_frames;
+  uint64_t dropped_frames = 0; // frames before this were lost to a smaller history, growing it doesn't bring them back
+};
+static metrics_data s_data;
+
+static Id
+register_metric(const std::string& name, Kind kind)
+{
+  for (Id id = 0; id < s_data.metrics.size(); id++) {
+    if (s_data.metrics[id].name == name) {
+      if (s_data.metrics[id].kind != kind)
+        std::cerr << "metrics: " << name << " registered as both a counter and a gauge" << std::endl;
+      return id;
+    }
+  }
+
+  Metric metric;
+  metric.name = name;
+  metric.kind = kind;
+  metric.first_frame = s_data.frame;
+  metric.samples.resize(s_data.history_frames, 0.0f);
+  s_data.metrics.push_back(std::move(metric));
+  return static_cast<Id>(s_data.metrics.size() - 1);
+}
+
+Id
+register_counter(const std::string& name)
+{
+  return register_metric(name, Kind::Counter);
+}
+
+Id
+register_gauge(const std::string& name)
+{
+  return register_metric(name, Kind::Gauge);
+}
+
+void
+add(Id id, double amount)
+{
+  s_data.metrics[id].value += amount;
+}
+
+void
+set(Id id, double value)
+{
+  s_data.metrics[id].value = value;
+}
+
+// the oldest frame still in every ring
+static uint64_t
+get_first_kept_frame()
+{
+  const uint64_t ring_start = s_data.frame > s_data.history_frames ? s_data.frame - s_data.history_frames : 0;
+  return std::max(ring_start, s_data.dropped_frames);
+}
+
+void
+set_history_frames(uint32_t frames)
+{
+  frames = std::max(frames, 1u);
+  const uint64_t first_kept = std::max(get_first_kept_frame(), s_data.frame > frames ? s_data.frame - frames : 0);
+  for (Metric& metric : s_data.metrics) {
+    std::vector<float> samples(frames, 0.0f);
+    for (uint64_t f = std::max(first_kept, metric.first_frame); f < s_data.frame; f++)
+      samples[f % frames] = metric.samples[f % s_data.history_frames];
+    metric.samples = std::move(samples);
+  }
+  s_data.history_frames = frames;
+  s_data.dropped_frames = first_kept;
+}
+
+uint32_t
+get_history_frames()
+{
+  return s_data.history_frames;
+}
+
+void
+new_frame()
+{
+  const uint32_t slot = static_cast<uint32_t>(s_data.frame % s_data.history_frames);
+  for (Metric& metric : s_data.metrics) {
+    metric.samples[slot] = static_cast<float>(metric.value);
+    if (metric.kind == Kind::Counter)
+      metric.value = 0.0;
+  }
+  s_data.frame += 1;
+}
+
+uint64_t
+get_frame_count()
+{
+  return s_data.frame;
+}
+
+const std::vector<Metric>&
+get_metrics()
+{
+  return s_data.metrics;
+}
+
+float
+get_last(Id id)
+{
+  const Metric& metric = s_data.metrics[id];
+  if (s_data.frame == 0 || s_data.frame <= metric.first_frame)
+    return 0.0f;
+  return metric.samples[(s_data.frame - 1) % s_data.history_frames];
+}
+
+void
+get_samples(Id id, std::vector<float>& out)
+{
+  const Metric& metric = s_data.metrics[id];
+  out.clear();
+  for (uint64_t f = std::max(get_first_kept_frame(), metric.first_frame); f < s_data.frame; f++)
+    out.push_back(metric.samples[f % s_data.history_frames]);
+}
+
+bool
+write_csv(const std::string& path)
+{
+  std::ofstream out(path, std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "metrics: could not write " << path << std::endl;
+    return false;
+  }
+
+  out << "frame";
+  for (const Metric& metric : s_data.metrics)
+    out << "," << metric.name;
+  out << "\n";
+
+  for (uint64_t f = get_first_kept_frame(); f < s_data.frame; f++) {
+    out << f;
+    for (const Metric& metric : s_data.metrics) {
+      out << ",";
+      if (f >= metric.first_frame)
+        out << metric.samples[f % s_data.history_frames];
+    }
+    out << "\n";
+  }
+  return out.good();
+}
+
+bool
+write_json(const std::string& path)
+{
+  std::ofstream out(path, std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "metrics: could not write " << path << std::endl;
+    return false;
+  }
+
+  // names are chosen in code, so aren't escaped
+  std::vector<float> samples;
+  out << "{\"first_frame\":" << get_first_kept_frame() << ",\"metrics\":{";
+  for (Id id = 0; id < s_data.metrics.size(); id++) {
+    const Metric& metric = s_data.metrics[id];
+    out << (id == 0 ? "" : ",") << "\"" << metric.name << "\":{\"kind\":\""
+        << (metric.kind == Kind::Counter ? "counter" : "gauge")
+        << "\",\"first_frame\":" << std::max(get_first_kept_frame(), metric.first_frame) << ",\"samples\":[";
+    get_samples(id, samples);
+    for (size_t i = 0; i < samples.size(); i++)
+      out << (i == 0 ? "" : ",") << samples[i];
+    out << "]}";
+  }
+  out << "}}\n";
+  return out.good();
+}
+
+void
+clear()
+{
+  s_data = metrics_data();
+}
+
+} // namespace metrics
+
+} // namespace fightingengine
@@ -0,0 +1,95 @@
+#pragma once
+
+// c system headers
+#include <cstdint>
+
+// c++ standard library headers
+#include <string>
+#include <vector>
+
+namespace fightingengine {
+
+namespace metrics {
+
+//
+// Named counters and gauges, sampled once a frame in to fixed size rings,
+// so load (draw calls, entities, collision pairs) can be lined up with frame times.
+// A counter is added to during the frame and goes back to 0 when sampled,
+// a gauge keeps the last value it was set to.
+// Not thread safe, everything here is for the main thread.
+//
+
+enum class Kind : uint8_t
+{
+  Counter,
+  Gauge,
+};
+
+// frames each metric keeps, unless set_history_frames() is called
+static constexpr uint32_t history_frames = 600;
+
+using Id = uint32_t;
+
+struct Metric
+{
+  std::string name;
+  Kind kind = Kind::Counter;
+  double value = 0.0;         // this frame so far
+  uint64_t first_frame = 0;   // the frame it was registered in
+  std::vector<float> samples; // get_history_frames() long, frame f is at f % get_history_frames()
+};
+
+// registering a name that's already registered returns the same id
+[[nodiscard]] Id
+register_counter(const std::string& name);
+[[nodiscard]] Id
+register_gauge(const std::string& name);
+
+void
+add(Id id, double amount = 1.0);
+void
+set(Id id, double value);
+
+// resizes every ring, keeping the newest samples that still fit.
+// e.g. a headless run keeps every frame, so its export covers the whole run
+void
+set_history_frames(uint32_t frames);
+[[nodiscard]] uint32_t
+get_history_frames();
+
+// samples every metric for the frame that's ending
+void
+new_frame();
+
+// frames sampled so far
+[[nodiscard]] uint64_t
+get_frame_count();
+
+[[nodiscard]] const std::vector<Metric>&
+get_metrics();
+
+// the last sampled value, 0 before the first sample
+[[nodiscard]] float
+get_last(Id id);
+
+// the samples still in the ring, oldest first
+void
+get_samples(Id id, std::vector<float>& out);
+
+// one row per frame still in the rings, one column per metric.
+// frames from before a metric was registered are left empty.
+[[nodiscard]] bool
+write_csv(const std::string& path);
+
+// { "first_frame": n, "metrics": { "name": { "kind": "counter", "samples": [...] }, ... } }
+[[nodiscard]] bool
+write_json(const std::string& path);
+
+// forgets every metric, ids from before are no longer valid.
+// the history goes back to history_frames
+void
+clear();
+
+} // namespace metrics
+
+} // namespace fightingengine
@@ -6,10 +6,268 @@
 #include <cassert>
 
 // c++ standard library headers
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
 
 namespace fightingengine {
 
+namespace profiler {
+
+// a single producer, single consumer ring: the owning thread moves head, collect_zones() moves tail
+struct ThreadBuffer
+{
+  uint32_t thread = 0;
+  std::unique_ptr<Zone[]> zones = std::make_unique<Zone[]>(zones_per_thread);
+  std::atomic<uint64_t> head{ 0 };
+  std::atomic<uint64_t> tail{ 0 };
+  std::atomic<uint64_t> dropped{ 0 };
+  std::atomic<bool> retired{ false }; // the thread has exited, free once drained
+};
+
+// the lock is only taken when a thread writes its first zone, and when collecting
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  uint32_t next_thread = 0;
+  uint64_t dropped = 0; // from buffers already freed
+  std::map<uint32_t, std::string> thread_names; // kept after the threads exit
+  std::vector<CounterSample> counters;
+};
+
+// never destroyed, threads can outlive static destructors
+static Registry&
+get_registry()
+{
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+struct ThreadState
+{
+  ThreadBuffer* buffer = nullptr;
+  uint32_t depth = 0;
+
+  ~ThreadState()
+  {
+    if (buffer != nullptr)
+      buffer->retired.store(true, std::memory_order_release);
+  }
+};
+static thread_local ThreadState thread_state;
+
+// plain counters, constant initialized, so operator new can use them before main() and while threads exit
+struct AllocationCounters
+{
+  std::atomic<uint64_t> allocations{ 0 };
+  std::atomic<uint64_t> frees{ 0 };
+  std::atomic<uint64_t> allocated_bytes{ 0 };
+  std::atomic<uint64_t> freed_bytes{ 0 };
+  std::atomic<uint64_t> peak_live_bytes{ 0 };
+};
+static AllocationCounters allocation_counters;
+
+struct ThreadAllocations
+{
+  uint64_t allocations;
+  uint64_t allocated_bytes;
+};
+static thread_local ThreadAllocations thread_allocations;
+
+#ifdef FIGHTINGENGINE_TRACK_ALLOCATIONS
+static void
+record_allocation(size_t size)
+{
+  thread_allocations.allocations += 1;
+  thread_allocations.allocated_bytes += size;
+  allocation_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+  const uint64_t allocated = allocation_counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  const uint64_t live = allocated - allocation_counters.freed_bytes.load(std::memory_order_relaxed);
+
+  uint64_t peak = allocation_counters.peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !allocation_counters.peak_live_bytes.compare_exchange_weak(peak, live))
+    ;
+}
+
+static void
+record_free(size_t size)
+{
+  allocation_counters.frees.fetch_add(1, std::memory_order_relaxed);
+  allocation_counters.freed_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+#endif
+
+static ThreadBuffer&
+get_thread_buffer()
+{
+  if (thread_state.buffer == nullptr) {
+    Registry& registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+    thread_state.buffer = registry.buffers.back().get();
+    thread_state.buffer->thread = registry.next_thread++;
+  }
+  return *thread_state.buffer;
+}
+
+uint64_t
+now_ns()
+{
+  static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+uint32_t
+get_thread_id()
+{
+  return get_thread_buffer().thread;
+}
+
+ScopedZone::ScopedZone(const char* name)
+  : name(name)
+  , start_ns(now_ns())
+  , depth(thread_state.depth++)
+  , start_allocations(thread_allocations.allocations)
+  , start_allocated_bytes(thread_allocations.allocated_bytes)
+{
+}
+
+ScopedZone::~ScopedZone()
+{
+  const uint64_t end_ns = now_ns();
+  thread_state.depth -= 1;
+
+  ThreadBuffer& buffer = get_thread_buffer();
+  const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  if (head - buffer.tail.load(std::memory_order_acquire) >= zones_per_thread) {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Zone& zone = buffer.zones[head % zones_per_thread];
+  zone.name = name;
+  zone.start_ns = start_ns;
+  zone.end_ns = end_ns;
+  zone.thread = buffer.thread;
+  zone.depth = depth;
+  zone.allocations = static_cast<uint32_t>(thread_allocations.allocations - start_allocations);
+  zone.allocated_bytes = thread_allocations.allocated_bytes - start_allocated_bytes;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void
+collect_zones(std::vector<Zone>& out)
+{
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  for (size_t i = 0; i < registry.buffers.size();) {
+    ThreadBuffer& buffer = *registry.buffers[i];
+    // read before head, so a retired thread's last zones are visible
+    const bool retired = buffer.retired.load(std::memory_order_acquire);
+
+    const uint64_t head = buffer.head.load(std::memory_order_acquire);
+    const uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+    for (uint64_t z = tail; z < head; z++)
+      out.push_back(buffer.zones[z % zones_per_thread]);
+    buffer.tail.store(head, std::memory_order_release);
+
+    if (retired) {
+      registry.dropped += buffer.dropped.load(std::memory_order_relaxed);
+      registry.buffers.erase(registry.buffers.begin() + i);
+      continue;
+    }
+    i++;
+  }
+}
+
+uint64_t
+take_dropped_zone_count()
+{
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+
+  uint64_t dropped = registry.dropped;
+  registry.dropped = 0;
+  for (std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+    dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+  return dropped;
+}
+
+void
+set_thread_name(const std::string& name)
+{
+  const uint32_t thread = get_thread_id();
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.thread_names[thread] = name;
+}
+
+std::map<uint32_t, std::string>
+get_thread_names()
+{
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.thread_names;
+}
+
+void
+record_counter(const char* name, double value)
+{
+  CounterSample sample;
+  sample.name = name;
+  sample.time_ns = now_ns();
+  sample.value = value;
+
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.counters.push_back(sample);
+}
+
+void
+collect_counters(std::vector<CounterSample>& out)
+{
+  Registry& registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  out.insert(out.end(), registry.counters.begin(), registry.counters.end());
+  registry.counters.clear();
+}
+
+AllocationStats
+get_allocation_stats()
+{
+  AllocationStats stats;
+  stats.allocations = allocation_counters.allocations.load(std::memory_order_relaxed);
+  stats.frees = allocation_counters.frees.load(std::memory_order_relaxed);
+  // freed before allocated, so a free racing with this can't make live_bytes wrap
+  stats.freed_bytes = allocation_counters.freed_bytes.load(std::memory_order_relaxed);
+  stats.allocated_bytes = allocation_counters.allocated_bytes.load(std::memory_order_relaxed);
+  stats.live_bytes = stats.allocated_bytes > stats.freed_bytes ? stats.allocated_bytes - stats.freed_bytes : 0;
+  stats.peak_live_bytes =
+    std::max(stats.live_bytes, allocation_counters.peak_live_bytes.load(std::memory_order_relaxed));
+  return stats;
+}
+
+void
+reset_peak_live_bytes()
+{
+  const uint64_t freed = allocation_counters.freed_bytes.load(std::memory_order_relaxed);
+  const uint64_t allocated = allocation_counters.allocated_bytes.load(std::memory_order_relaxed);
+  allocation_counters.peak_live_bytes.store(allocated > freed ? allocated - freed : 0, std::memory_order_relaxed);
+}
+
+} // namespace profiler
+
 uint8_t
 Profiler::get_entry_index(int8_t offset) const
 {
@@ -21,22 +279,243 @@ Profiler::new_frame()
 {
   auto& prevEntry = entries[current_entry];
   current_entry = (current_entry + 1) % frames_data_live;
-  prevEntry.frame_end = entries[current_entry].frame_start = std::chrono::system_clock::now();
+  prevEntry.frame_end = entries[current_entry].frame_start = time_source();
+
+  // the entry is reused, stages that don't run this frame shouldn't show the times from last time
+  for (DeltaTime& stage : entries[current_entry].stages)
+    stage = DeltaTime();
+
+  // every thread's zones from the frame that just ended, grouped by thread for drawing
+  prevEntry.zones.clear();
+  profiler::collect_zones(prevEntry.zones);
+  std::sort(prevEntry.zones.begin(), prevEntry.zones.end(), [](const profiler::Zone& a, const profiler::Zone& b) {
+    if (a.thread != b.thread)
+      return a.thread < b.thread;
+    return a.start_ns != b.start_ns ? a.start_ns < b.start_ns : a.depth < b.depth;
+  });
+
+  if (profiler::allocation_tracking) {
+    const profiler::AllocationStats stats = profiler::get_allocation_stats();
+    profiler::reset_peak_live_bytes();
+    FrameAllocations& allocations = prevEntry.allocations;
+    allocations.allocations = stats.allocations - last_allocation_stats.allocations;
+    allocations.frees = stats.frees - last_allocation_stats.frees;
+    allocations.allocated_bytes = stats.allocated_bytes - last_allocation_stats.allocated_bytes;
+    allocations.live_bytes = stats.live_bytes;
+    allocations.peak_live_bytes = stats.peak_live_bytes;
+    last_allocation_stats = stats;
+    if (frame_count > 0) {
+      profiler::record_counter("allocations", static_cast<double>(allocations.allocations));
+      profiler::record_counter("live bytes", static_cast<double>(allocations.live_bytes));
+    }
+  }
+
+  std::vector<profiler::CounterSample> counters;
+  frame_count += 1;
+  if (frame_count > 1) {
+    // the first call only starts the first frame
+    FrameTimes times;
+    times.frame_ms = std::chrono::duration<float, std::milli>(prevEntry.frame_end - prevEntry.frame_start).count();
+    for (size_t i = 0; i < times.stage_ms.size(); i++) {
+      const DeltaTime& stage = prevEntry.stages[i];
+      const std::chrono::duration<float, std::milli> ms = stage._end - stage._start;
+      times.stage_ms[i] = stage.scope_time_finalized ? ms.count() : -1.0f;
+    }
+    add_history(times);
+    profiler::record_counter("frame ms", times.frame_ms);
+
+    if (hitch_threshold_ms > 0.0f && times.frame_ms > hitch_threshold_ms) {
+      Hitch hitch;
+      hitch.frame = frame_count - 1;
+      hitch.frame_ms = times.frame_ms;
+      hitch.stage_ms = times.stage_ms;
+      hitch.zones = prevEntry.zones;
+      hitches.push_back(std::move(hitch));
+      if (hitches.size() > max_hitches)
+        hitches.pop_front();
+    }
+  }
+  profiler::collect_counters(counters);
+  if (trace_window_s <= 0.0f)
+    return;
+
+  trace_zones.insert(trace_zones.end(), prevEntry.zones.begin(), prevEntry.zones.end());
+  trace_counters.insert(trace_counters.end(), counters.begin(), counters.end());
+
+  const uint64_t window_ns = static_cast<uint64_t>(trace_window_s * 1e9);
+  const uint64_t now = profiler::now_ns();
+  const uint64_t cutoff = now > window_ns ? now - window_ns : 0;
+  while (!trace_zones.empty() && trace_zones.front().end_ns < cutoff)
+    trace_zones.pop_front();
+  while (!trace_counters.empty() && trace_counters.front().time_ns < cutoff)
+    trace_counters.pop_front();
 }
 
-float
-Profiler::get_time(const Stage& request) const
+void
+Profiler::set_trace_window(float seconds)
+{
+  trace_window_s = seconds;
+  if (trace_window_s <= 0.0f) {
+    trace_zones.clear();
+    trace_counters.clear();
+  }
+}
+
+// names are usually identifiers, but they go in to json strings so escape them anyway
+static void
+write_json_string(std::ofstream& out, const char* text)
+{
+  out << '"';
+  for (const char* c = text; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\')
+      out << '\\' << *c;
+    else if (static_cast<unsigned char>(*c) < 0x20)
+      out << ' ';
+    else
+      out << *c;
+  }
+  out << '"';
+}
+
+bool
+Profiler::write_trace(const std::string& path) const
+{
+  std::ofstream out(path, std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "profiler: could not write " << path << std::endl;
+    return false;
+  }
+
+  // complete ("X") events for zones, "C" for counters and "M" to name the threads.
+  // timestamps are in microseconds
+  char number[64];
+  auto microseconds = [&number](uint64_t ns) {
+    std::snprintf(number, sizeof(number), "%.3f", ns / 1000.0);
+    return number;
+  };
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  auto separator = [&out, &first]() {
+    if (!first)
+      out << ",\n";
+    first = false;
+  };
+
+  for (const auto& [thread, name] : profiler::get_thread_names()) {
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":";
+    write_json_string(out, name.c_str());
+    out << "}}";
+  }
+
+  for (const profiler::Zone& zone : trace_zones) {
+    separator();
+    out << "{\"name\":";
+    write_json_string(out, zone.name);
+    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread << ",\"ts\":" << microseconds(zone.start_ns);
+    out << ",\"dur\":" << microseconds(zone.end_ns - zone.start_ns);
+    if (profiler::allocation_tracking)
+      out << ",\"args\":{\"allocations\":" << zone.allocations << ",\"bytes\":" << zone.allocated_bytes << "}";
+    out << "}";
+  }
+
+  for (const profiler::CounterSample& counter : trace_counters) {
+    separator();
+    out << "{\"name\":";
+    write_json_string(out, counter.name);
+    out << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << microseconds(counter.time_ns) << ",\"args\":{\"value\":";
+    std::snprintf(number, sizeof(number), "%.17g", counter.value);
+    out << number << "}}";
+  }
+
+  out << "\n]}\n";
+  return out.good();
+}
+
+const std::vector<profiler::Zone>&
+Profiler::get_zones() const
+{
+  return entries[get_entry_index(-1)].zones;
+}
+
+const Profiler::FrameAllocations&
+Profiler::get_allocations() const
 {
-  auto& entry = entries[get_entry_index(-1)];
-  auto& stage = entry.stages[(int)request];
+  return entries[get_entry_index(-1)].allocations;
+}
+
+void
+Profiler::add_history(const FrameTimes& times)
+{
+  auto bucket = [](float ms) { return std::min(histogram_buckets - 1, static_cast<uint32_t>(std::max(0.0f, ms))); };
+
+  if (history.size() < history_frames) {
+    history.push_back(times);
+  } else {
+    histogram[bucket(history[history_next].frame_ms)] -= 1;
+    history[history_next] = times;
+  }
+  history_next = (history_next + 1) % history_frames;
+  histogram[bucket(times.frame_ms)] += 1;
+}
+
+Profiler::Stats
+Profiler::compute_stats(int stage) const
+{
+  std::vector<float> samples;
+  samples.reserve(history.size());
+  for (const FrameTimes& times : history) {
+    const float ms = stage < 0 ? times.frame_ms : times.stage_ms[stage];
+    if (ms >= 0.0f)
+      samples.push_back(ms);
+  }
+  return stats_from(samples);
+}
+
+Profiler::Stats
+Profiler::stats_from(std::vector<float>& samples)
+{
+  Stats stats;
+  if (samples.empty())
+    return stats;
+  std::sort(samples.begin(), samples.end());
+
+  // nearest rank
+  auto percentile = [&samples](float p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+    return samples[std::max<size_t>(rank, 1) - 1];
+  };
+  stats.samples = static_cast<uint32_t>(samples.size());
+  stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
+  stats.p50 = percentile(0.50f);
+  stats.p95 = percentile(0.95f);
+  stats.p99 = percentile(0.99f);
+  stats.max = samples.back();
+  return stats;
+}
 
-  std::chrono::duration<float, std::milli> fltStart = stage._start - entry.frame_start;
-  float startTimestamp = fltStart.count();
+Profiler::Stats
+Profiler::get_stats(const Stage& request) const
+{
+  return compute_stats(static_cast<int>(request));
+}
+
+Profiler::Stats
+Profiler::get_frame_stats() const
+{
+  return compute_stats(-1);
+}
 
-  std::chrono::duration<float, std::milli> fltEnd = stage._end - entry.frame_end;
-  float endTimestamp = fltEnd.count();
+float
+Profiler::get_time(const Stage& request) const
+{
+  auto& stage = entries[get_entry_index(-1)].stages[(int)request];
+  if (!stage.scope_time_finalized)
+    return 0.0f;
 
-  return endTimestamp - startTimestamp;
+  std::chrono::duration<float, std::milli> time = stage._end - stage._start;
+  return time.count();
 }
 
 float
@@ -47,20 +526,12 @@ Profiler::get_average_time(const Stage& request) const
 
   for (auto& entry : entries) {
     auto& delta_time = entry.stages[(int)request];
-
-    std::chrono::duration<float, std::milli> fltStart = delta_time._start - entry.frame_start;
-    float startTimestamp = fltStart.count();
-
-    std::chrono::duration<float, std::milli> fltEnd = delta_time._end - entry.frame_start;
-    float endTimestamp = fltEnd.count();
-
-    float time = endTimestamp - startTimestamp;
-
-    if (time <= 0.0f) {
+    if (!delta_time.scope_time_finalized)
       continue;
-    }
 
-    average += time;
+    std::chrono::duration<float, std::milli> time = delta_time._end - delta_time._start;
+
+    average += time.count();
     valid_entries++;
   }
 
@@ -76,7 +547,7 @@ Profiler::begin(const Stage& stage)
   assert(frames_data_live < 255);
   auto& delta_time = entries[current_entry].stages[static_cast<uint8_t>(stage)];
 
-  delta_time._start = std::chrono::system_clock::now();
+  delta_time._start = time_source();
   delta_time.scope_time_finalized = false;
 }
 
@@ -86,8 +557,188 @@ Profiler::end(const Stage& stage)
   auto& delta_time = entries[current_entry].stages[static_cast<uint8_t>(stage)];
   assert(!delta_time.scope_time_finalized);
 
-  delta_time._end = std::chrono::system_clock::now();
+  delta_time._end = time_source();
   delta_time.scope_time_finalized = true;
 }
 
-} // namespace fightingengine
\ No newline at end of file
+} // namespace fightingengine
+#ifdef FIGHTINGENGINE_TRACK_ALLOCATIONS
+
+//
+// The replaced global operator new/delete. Every block gets a header in front
+// of it with its size (for the unsized deletes) and what malloc returned
+// (for over-aligned blocks), so every delete can go through one path.
+//
+
+namespace {
+
+struct AllocationHeader
+{
+  void* base;
+  size_t size;
+};
+
+void*
+tracked_allocate(size_t size, size_t alignment) noexcept
+{
+  alignment = std::max(alignment, alignof(std::max_align_t));
+  void* base = std::malloc(size + sizeof(AllocationHeader) + alignment);
+  if (base == nullptr)
+    return nullptr;
+
+  const uintptr_t block =
+    (reinterpret_cast<uintptr_t>(base) + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+  AllocationHeader* header = reinterpret_cast<AllocationHeader*>(block) - 1;
+  header->base = base;
+  header->size = size;
+  fightingengine::profiler::record_allocation(size);
+  return reinterpret_cast<void*>(block);
+}
+
+void*
+tracked_allocate_or_throw(size_t size, size_t alignment)
+{
+  void* block = tracked_allocate(size, alignment);
+  while (block == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr)
+      throw std::bad_alloc();
+    handler();
+    block = tracked_allocate(size, alignment);
+  }
+  return block;
+}
+
+void
+tracked_free(void* block) noexcept
+{
+  if (block == nullptr)
+    return;
+  const AllocationHeader* header = static_cast<AllocationHeader*>(block) - 1;
+  fightingengine::profiler::record_free(header->size);
+  std::free(header->base);
+}
+
+} // namespace
+
+void*
+operator new(size_t size)
+{
+  return tracked_allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void*
+operator new[](size_t size)
+{
+  return tracked_allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+  return tracked_allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment)
+{
+  return tracked_allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void*
+operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return tracked_allocate(size, alignof(std::max_align_t));
+}
+
+void*
+operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return tracked_allocate(size, alignof(std::max_align_t));
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  return tracked_allocate(size, static_cast<size_t>(alignment));
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  return tracked_allocate(size, static_cast<size_t>(alignment));
+}
+
+void
+operator delete(void* block) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete(void* block, size_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block, size_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete(void* block, std::align_val_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block, std::align_val_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete(void* block, size_t, std::align_val_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block, size_t, std::align_val_t) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete(void* block, const std::nothrow_t&) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block, const std::nothrow_t&) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  tracked_free(block);
+}
+
+void
+operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  tracked_free(block);
+}
+
+#endif
@@ -6,10 +6,134 @@
 // c++ standard library header
 #include <array>
 #include <chrono>
+#include <deque>
 #include <map>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace fightingengine {
+
+//
+// Zones: named scopes timed on any thread, which can nest.
+// PROFILE_ZONE("name") times the rest of the enclosing scope. The name is
+// kept as a pointer, so it has to be a string literal (or live as long).
+// Each thread writes finished zones to its own ring buffer without locking,
+// and Profiler::new_frame() collects them from every thread.
+// Define FIGHTINGENGINE_NO_PROFILER to compile the zones out.
+//
+// Allocations: define FIGHTINGENGINE_TRACK_ALLOCATIONS (the cmake option of
+// the same name) to replace the global operator new/delete with versions that
+// count every allocation. Zones then carry what was allocated inside them,
+// and the profiler what was allocated each frame. Off, everything reads 0.
+//
+
+namespace profiler {
+
+struct Zone
+{
+  const char* name = nullptr;
+  uint64_t start_ns = 0; // see now_ns()
+  uint64_t end_ns = 0;
+  uint32_t thread = 0;      // see get_thread_id()
+  uint32_t depth = 0;       // 0 for zones not inside another zone on their thread
+  uint32_t allocations = 0; // on this thread while the zone was open, including in nested zones
+  uint64_t allocated_bytes = 0;
+};
+
+// zones a thread can have finished before they're collected, any more are dropped
+static constexpr uint32_t zones_per_thread = 1 << 14;
+
+// nanoseconds on the steady clock, since the first call
+[[nodiscard]] uint64_t
+now_ns();
+
+// a small number for the calling thread, 0 for the first thread to ask (usually the main thread)
+[[nodiscard]] uint32_t
+get_thread_id();
+
+#ifdef FIGHTINGENGINE_TRACK_ALLOCATIONS
+static constexpr bool allocation_tracking = true;
+#else
+static constexpr bool allocation_tracking = false;
+#endif
+
+// every thread's allocations since the program started
+struct AllocationStats
+{
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t allocated_bytes = 0;
+  uint64_t freed_bytes = 0;
+  uint64_t live_bytes = 0;
+  uint64_t peak_live_bytes = 0; // since the last reset_peak_live_bytes()
+};
+
+[[nodiscard]] AllocationStats
+get_allocation_stats();
+
+void
+reset_peak_live_bytes();
+
+class ScopedZone
+{
+public:
+  explicit ScopedZone(const char* name);
+  ~ScopedZone();
+
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+  const char* name;
+  uint64_t start_ns;
+  uint32_t depth;
+  uint64_t start_allocations;
+  uint64_t start_allocated_bytes;
+};
+
+// appends the zones every thread has finished since the last call, each thread's in the order they ended
+void
+collect_zones(std::vector<Zone>& out);
+
+// zones lost to full buffers since the last call
+[[nodiscard]] uint64_t
+take_dropped_zone_count();
+
+// shown in exported traces, a thread without a name shows as its id
+void
+set_thread_name(const std::string& name);
+
+[[nodiscard]] std::map<uint32_t, std::string>
+get_thread_names();
+
+// a value over time (memory, entity counts, ...), shown as a graph in exported traces.
+// takes a lock, so it's for values sampled every frame or so rather than in hot loops.
+struct CounterSample
+{
+  const char* name = nullptr; // a string literal, as with zones
+  uint64_t time_ns = 0;
+  double value = 0.0;
+};
+
+void
+record_counter(const char* name, double value);
+
+// appends the samples recorded since the last call
+void
+collect_counters(std::vector<CounterSample>& out);
+
+} // namespace profiler
+
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+#ifdef FIGHTINGENGINE_NO_PROFILER
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) ::fightingengine::profiler::ScopedZone PROFILE_ZONE_CONCAT(profile_zone_, __LINE__)(name)
+#endif
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
 class Profiler
 {
 public:
@@ -27,13 +151,17 @@ public:
   };
 
 public:
+  // monotonic, so frame times can't go negative or jump when the wall clock is changed
+  using Clock = std::chrono::steady_clock;
+  using TimeSource = Clock::time_point (*)();
+
   // Each "DeltaTime" has to belong to an "Entry"
   // It represents the time elapsed between calling
   // profiler.begin(STAGE) and profiler.end(STAGE)
   struct DeltaTime
   {
-    std::chrono::system_clock::time_point _start;
-    std::chrono::system_clock::time_point _end;
+    Clock::time_point _start;
+    Clock::time_point _end;
     bool scope_time_finalized = false;
   };
 
@@ -41,28 +169,101 @@ public:
     "Physics", "SDL Input", "Game Tick", "Render", "GUI Loop", "Frame End", "Update Loop"
   };
 
+  // everything allocated between two new_frame() calls, on any thread
+  struct FrameAllocations
+  {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t live_bytes = 0; // at the end of the frame
+    uint64_t peak_live_bytes = 0;
+  };
+
   // Each "Entry" contains a "DeltaTime" value
   // for each "Stage" for the profiler, so that
   // every frame for the application has one "Entry".
   struct Entry
   {
-    std::chrono::system_clock::time_point frame_start;
-    std::chrono::system_clock::time_point frame_end;
+    Clock::time_point frame_start;
+    Clock::time_point frame_end;
     std::array<DeltaTime, static_cast<uint8_t>(Stage::_count)> stages;
+    std::vector<profiler::Zone> zones; // sorted by thread, then start
+    FrameAllocations allocations;
+  };
+
+  // over the last history_frames frames, in milliseconds
+  struct Stats
+  {
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    uint32_t samples = 0; // frames the stage ran in
+  };
+
+  // a frame over the hitch threshold, kept with everything that was timed in it
+  struct Hitch
+  {
+    uint64_t frame = 0;
+    float frame_ms = 0.0f;
+    std::array<float, static_cast<uint8_t>(Stage::_count)> stage_ms; // negative if the stage didn't run
+    std::vector<profiler::Zone> zones;
   };
 
+  static constexpr uint32_t history_frames = 600;
+  // frame times in 1ms buckets, the last bucket also counts every longer frame
+  static constexpr uint32_t histogram_buckets = 50;
+  static constexpr uint32_t max_hitches = 16;
+
   void new_frame();
   void begin(const Stage& stage);
   void end(const Stage& stage);
 
-  // returns milliseconds the profiler stage took this frame
+  // where new_frame(), begin() and end() read the time, Clock::now unless a test sets its own clock
+  void set_time_source(TimeSource source) { time_source = source; };
+
+  // returns milliseconds the profiler stage took last frame, 0 if it didn't run
   [[nodiscard]] float get_time(const Stage& request) const;
   // returns average milliseconds the the last "frames_data_live" frames took
   [[nodiscard]] float get_average_time(const Stage& request) const;
 
+  [[nodiscard]] Stats get_stats(const Stage& request) const;
+  // new_frame() to new_frame()
+  [[nodiscard]] Stats get_frame_stats() const;
+  // the same stats over any set of times, for runs longer than history_frames. sorts samples
+  [[nodiscard]] static Stats stats_from(std::vector<float>& samples_ms);
+  [[nodiscard]] const std::array<uint32_t, histogram_buckets>& get_frame_histogram() const { return histogram; };
+
+  // frames longer than this are kept, see get_hitches(). 0 (the default) turns it off
+  void set_hitch_threshold(float ms) { hitch_threshold_ms = ms; };
+  [[nodiscard]] float get_hitch_threshold() const { return hitch_threshold_ms; };
+  // the last max_hitches, oldest first
+  [[nodiscard]] const std::deque<Hitch>& get_hitches() const { return hitches; };
+
+  // the zones that finished during the last frame, from every thread
+  [[nodiscard]] const std::vector<profiler::Zone>& get_zones() const;
+  // all 0 without FIGHTINGENGINE_TRACK_ALLOCATIONS
+  [[nodiscard]] const FrameAllocations& get_allocations() const;
+
+  // keeps the zones and counters from the last seconds for write_trace(), 0 (the default) keeps none
+  void set_trace_window(float seconds);
+  [[nodiscard]] float get_trace_window() const { return trace_window_s; };
+
+  // writes the trace window as chrome trace event json, which chrome://tracing and ui.perfetto.dev open
+  [[nodiscard]] bool write_trace(const std::string& path) const;
+
 private:
   uint8_t get_entry_index(int8_t offset) const;
 
+  struct FrameTimes
+  {
+    float frame_ms = 0.0f;
+    std::array<float, static_cast<uint8_t>(Stage::_count)> stage_ms; // negative if the stage didn't run
+  };
+  void add_history(const FrameTimes& times);
+  [[nodiscard]] Stats compute_stats(int stage) const; // -1 for the whole frame
+
   // a buffer for the profiler entries
   // i.e. how many frames to keep the data
   // Currently storing 60 frames so the "average" function
@@ -70,7 +271,21 @@ private:
   static constexpr uint8_t frames_data_live = 60;
   std::array<Entry, frames_data_live> entries;
 
+  TimeSource time_source = &Clock::now;
   uint8_t current_entry = frames_data_live - 1;
+  uint64_t frame_count = 0;
+  profiler::AllocationStats last_allocation_stats;
+
+  std::vector<FrameTimes> history; // a ring of up to history_frames
+  uint32_t history_next = 0;
+  std::array<uint32_t, histogram_buckets> histogram = {};
+
+  float hitch_threshold_ms = 0.0f;
+  std::deque<Hitch> hitches;
+
+  float trace_window_s = 0.0f;
+  std::deque<profiler::Zone> trace_zones; // in the order frames were collected
+  std::deque<profiler::CounterSample> trace_counters;
 };
 
 } // namespace fightingengine
\ No newline at end of file
@@ -4,7 +4,11 @@
 
 // standard lib headers
 // clang-format off
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
 #include <string>
+#include <vector>
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
 #include "windows.h"
 #include "psapi.h"
@@ -14,6 +18,9 @@
 // other library headers
 #include <imgui.h>
 
+// engine headers
+#include "engine/tools/metrics.hpp"
+
 using namespace fightingengine;
 
 namespace fightingengine {
@@ -68,6 +75,185 @@ public:
   }
 };
 
+// zones with the same name at the same depth on a thread are summed, in the order they first ran
+struct ZoneRow
+{
+  const char* name;
+  uint32_t depth;
+  uint32_t count;
+  uint64_t total_ns;
+  uint64_t allocations;
+  uint64_t allocated_bytes;
+};
+
+static void
+draw_zones(const std::vector<profiler::Zone>& zones)
+{
+  if (!ImGui::CollapsingHeader("Zones"))
+    return;
+
+  size_t i = 0;
+  while (i < zones.size()) {
+    const uint32_t thread = zones[i].thread;
+    std::vector<ZoneRow> rows;
+    for (; i < zones.size() && zones[i].thread == thread; i++) {
+      const profiler::Zone& zone = zones[i];
+      auto row = std::find_if(rows.begin(), rows.end(), [&zone](const ZoneRow& r) {
+        return r.depth == zone.depth && std::string_view(r.name) == zone.name;
+      });
+      if (row == rows.end()) {
+        rows.push_back({ zone.name, zone.depth, 0, 0, 0, 0 });
+        row = rows.end() - 1;
+      }
+      row->count += 1;
+      row->total_ns += zone.end_ns - zone.start_ns;
+      row->allocations += zone.allocations;
+      row->allocated_bytes += zone.allocated_bytes;
+    }
+
+    ImGui::Text("thread %u", thread);
+    for (const ZoneRow& row : rows) {
+      const int indent = static_cast<int>(row.depth + 1) * 2;
+      if (profiler::allocation_tracking)
+        ImGui::Text("%*s%s x%u %f ms, %llu allocs %.1f kb",
+                    indent,
+                    "",
+                    row.name,
+                    row.count,
+                    row.total_ns / 1e6,
+                    static_cast<unsigned long long>(row.allocations),
+                    row.allocated_bytes / 1024.0);
+      else
+        ImGui::Text("%*s%s x%u %f ms", indent, "", row.name, row.count, row.total_ns / 1e6);
+    }
+  }
+}
+
+// the last frame, from every thread. zones show where they came from
+static void
+draw_allocations(const Profiler& profiler)
+{
+  if (!profiler::allocation_tracking || !ImGui::CollapsingHeader("Allocations"))
+    return;
+
+  const Profiler::FrameAllocations& allocations = profiler.get_allocations();
+  static AnimatedProfilerEntry per_frame;
+  per_frame.scale_max = 1000.0f;
+  per_frame.draw(static_cast<float>(allocations.allocations));
+  ImGui::Text("allocations: %llu (%.1f kb), frees: %llu",
+              static_cast<unsigned long long>(allocations.allocations),
+              allocations.allocated_bytes / 1024.0,
+              static_cast<unsigned long long>(allocations.frees));
+  ImGui::Text("live: %.2f mb, peak this frame: %.2f mb",
+              allocations.live_bytes / (1024.0 * 1024.0),
+              allocations.peak_live_bytes / (1024.0 * 1024.0));
+}
+
+// every registered metric over the frames its ring still keeps
+static void
+draw_metrics()
+{
+  const std::vector<metrics::Metric>& all = metrics::get_metrics();
+  if (all.empty() || !ImGui::CollapsingHeader("Metrics"))
+    return;
+
+  std::vector<float> samples;
+  for (metrics::Id id = 0; id < all.size(); id++) {
+    metrics::get_samples(id, samples);
+    if (samples.empty())
+      continue;
+    const float highest = *std::max_element(samples.begin(), samples.end());
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "%s: %g (max %g)", all[id].name.c_str(), samples.back(), highest);
+    ImGui::PushID(static_cast<int>(id));
+    ImGui::PlotLines("##metric",
+                     samples.data(),
+                     static_cast<int>(samples.size()),
+                     0,
+                     overlay,
+                     0.0f,
+                     std::max(highest * 1.1f, 1.0f),
+                     ImVec2(0, 40.0f));
+    ImGui::PopID();
+  }
+
+  static const char* csv_path = "metrics.csv";
+  static const char* json_path = "metrics.json";
+  if (ImGui::Button("Save csv") && metrics::write_csv(csv_path))
+    std::cout << "metrics: wrote " << csv_path << std::endl;
+  ImGui::SameLine();
+  if (ImGui::Button("Save json") && metrics::write_json(json_path))
+    std::cout << "metrics: wrote " << json_path << std::endl;
+}
+
+static void
+draw_stats_row(const char* name, const Profiler::Stats& stats)
+{
+  ImGui::Text("%s", name);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f", stats.p50);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f", stats.p95);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f", stats.p99);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f", stats.max);
+  ImGui::NextColumn();
+}
+
+// percentiles over the profiler's history, averages hide the frames that stutter
+static void
+draw_stats(const Profiler& profiler)
+{
+  if (!ImGui::CollapsingHeader("Frame Stats"))
+    return;
+
+  const Profiler::Stats frame = profiler.get_frame_stats();
+  ImGui::Text("last %u frames, ms", frame.samples);
+  ImGui::Columns(5, "stats");
+  for (const char* heading : { "", "p50", "p95", "p99", "max" }) {
+    ImGui::Text("%s", heading);
+    ImGui::NextColumn();
+  }
+  ImGui::Separator();
+  draw_stats_row("Frame", frame);
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Profiler::Stage::_count); i++) {
+    const Profiler::Stats stats = profiler.get_stats(static_cast<Profiler::Stage>(i));
+    if (stats.samples > 0)
+      draw_stats_row(profiler.stageNames[i].data(), stats);
+  }
+  ImGui::Columns(1);
+
+  // the histogram counts whole frames, so convert to floats for imgui
+  const auto& histogram = profiler.get_frame_histogram();
+  float buckets[Profiler::histogram_buckets];
+  float highest = 0.0f;
+  for (uint32_t i = 0; i < Profiler::histogram_buckets; i++) {
+    buckets[i] = static_cast<float>(histogram[i]);
+    highest = std::max(highest, buckets[i]);
+  }
+  ImGui::PlotHistogram(
+    "##frame_ms", buckets, Profiler::histogram_buckets, 0, "frame ms, 1ms buckets", 0.0f, highest, ImVec2(0, 60.0f));
+
+  const auto& hitches = profiler.get_hitches();
+  if (profiler.get_hitch_threshold() <= 0.0f || hitches.empty())
+    return;
+  ImGui::Text("frames over %.1f ms", profiler.get_hitch_threshold());
+  for (auto hitch = hitches.rbegin(); hitch != hitches.rend(); hitch++) {
+    ImGui::PushID(static_cast<int>(hitch->frame));
+    const unsigned long long frame = hitch->frame;
+    if (ImGui::TreeNode("hitch", "frame %llu: %.2f ms", frame, hitch->frame_ms)) {
+      for (uint8_t i = 0; i < static_cast<uint8_t>(Profiler::Stage::_count); i++) {
+        if (hitch->stage_ms[i] >= 0.0f)
+          ImGui::Text("%s %.2f ms", profiler.stageNames[i].data(), hitch->stage_ms[i]);
+      }
+      draw_zones(hitch->zones);
+      ImGui::TreePop();
+    }
+    ImGui::PopID();
+  }
+}
+
 void
 draw(const Profiler& profiler, const float delta_time_s)
 {
@@ -115,6 +301,27 @@ draw(const Profiler& profiler, const float delta_time_s)
   ImGui::Text("~~ %s %f ms ~~", profiler.stageNames[(uint8_t)Profiler::Stage::UpdateLoop].data(), (time));
   ImGui::Separator();
 
+  draw_stats(profiler);
+  draw_allocations(profiler);
+  draw_metrics();
+  ImGui::Separator();
+
+  //
+  // Zones, last frame
+  //
+
+  draw_zones(profiler.get_zones());
+  if (profiler.get_trace_window() > 0.0f) {
+    static const char* trace_path = "profile_trace.json";
+    if (ImGui::Button("Save trace")) {
+      if (profiler.write_trace(trace_path))
+        std::cout << "profiler: wrote the last " << profiler.get_trace_window() << "s to " << trace_path << std::endl;
+    }
+    ImGui::SameLine();
+    ImGui::Text("last %.0fs, open in ui.perfetto.dev", profiler.get_trace_window());
+  }
+  ImGui::Separator();
+
   //
   // Memory Usage Info
   //
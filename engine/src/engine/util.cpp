@@ -10,13 +10,14 @@
 
 // engine header
 #include "engine/opengl/texture.hpp"
+#include "engine/tools/profiler.hpp"
 
 namespace fightingengine {
 
 void
-log_time_since(const std::string& label, std::chrono::time_point<std::chrono::high_resolution_clock> start)
+log_time_since(const std::string& label, std::chrono::steady_clock::time_point start)
 {
-  const auto x = std::chrono::high_resolution_clock::now();
+  const auto x = std::chrono::steady_clock::now();
   const auto y = std::chrono::duration_cast<std::chrono::milliseconds>(x - start).count();
   std::cout << label << y << "ms" << std::endl;
 }
@@ -33,6 +34,7 @@ load_textures_threaded(std::vector<std::pair<int, std::string>>& textures_to_loa
     for (int i = 0; i < textures_to_load.size(); ++i) {
       const std::pair<int, std::string>& tex_to_load = textures_to_load[i];
       threads.emplace_back([&tex_to_load, i, &loaded_textures]() {
+        PROFILE_ZONE("load_texture");
         loaded_textures[i] = load_texture(tex_to_load.first, tex_to_load.second);
       });
     }
@@ -46,6 +48,31 @@ load_textures_threaded(std::vector<std::pair<int, std::string>>& textures_to_loa
   log_time_since("(End Threaded) textures loaded ", app_start);
 }
 
+TextureArray
+load_texture_array_threaded(const int texture_unit,
+                            const int max_layers,
+                            const std::vector<std::string>& paths,
+                            const std::chrono::steady_clock::time_point& app_start)
+{
+  log_time_since("(Threaded) loading texture array... ", app_start);
+  std::vector<std::thread> threads;
+  std::vector<StbLoadedTexture> loaded_textures(paths.size());
+
+  for (int i = 0; i < paths.size(); ++i) {
+    const std::string& path = paths[i];
+    threads.emplace_back([&path, i, texture_unit, &loaded_textures]() {
+      PROFILE_ZONE("load_texture");
+      loaded_textures[i] = load_texture(texture_unit, path, 4); // array layers are always rgba
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  TextureArray result = bind_stb_loaded_texture_array(loaded_textures, texture_unit, max_layers);
+  log_time_since("(End Threaded) texture array loaded ", app_start);
+  return result;
+}
+
 void
 hide_console()
 {
@@ -5,15 +5,26 @@
 #include <thread>
 #include <vector>
 
+// engine headers
+#include "engine/opengl/texture.hpp"
+
 namespace fightingengine {
 
 void
-log_time_since(const std::string& label, std::chrono::time_point<std::chrono::high_resolution_clock> start);
+log_time_since(const std::string& label, std::chrono::steady_clock::time_point start);
 
 void
 load_textures_threaded(std::vector<std::pair<int, std::string>>& textures_to_load,
                        const std::chrono::steady_clock::time_point& app_start);
 
+// loads every path on its own thread, then packs them in to one texture array.
+// layer i of the array is paths[i]. see bind_stb_loaded_texture_array() for max_layers.
+[[nodiscard]] TextureArray
+load_texture_array_threaded(const int texture_unit,
+                            const int max_layers,
+                            const std::vector<std::string>& paths,
+                            const std::chrono::steady_clock::time_point& app_start);
+
 void
 hide_console();
 
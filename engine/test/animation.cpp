@@ -0,0 +1,128 @@
+
+#include <gtest/gtest.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/animation.hpp"
+#include "engine/thread_pool.hpp"
+
+using namespace fightingengine;
+
+// a chain of nodes, each one a bone, with a different transform each
+static animation::Skeleton
+make_chain(size_t nodes)
+{
+  animation::Skeleton skeleton;
+  skeleton.bind_pose.resize(nodes);
+  for (size_t i = 0; i < nodes; i++) {
+    skeleton.names.push_back("node" + std::to_string(i));
+    skeleton.parents.push_back(static_cast<int32_t>(i) - 1);
+    skeleton.bones.push_back(static_cast<int32_t>(i));
+    skeleton.bone_offsets.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f * i, 0.0f)));
+
+    glm::quat rotation = glm::angleAxis(0.3f * i, glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f * i)));
+    animation::Pose& pose = skeleton.bind_pose;
+    pose.tx[i] = 0.1f * i;
+    pose.ty[i] = 1.0f;
+    pose.tz[i] = -0.2f * i;
+    pose.rx[i] = rotation.x;
+    pose.ry[i] = rotation.y;
+    pose.rz[i] = rotation.z;
+    pose.rw[i] = rotation.w;
+    pose.sx[i] = 1.0f + 0.1f * i;
+    pose.sy[i] = 1.0f;
+    pose.sz[i] = 0.5f;
+  }
+  skeleton.global_inverse = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+  return skeleton;
+}
+
+static animation::Clip
+make_slide(uint32_t node)
+{
+  animation::Clip clip;
+  clip.duration = 1.0f;
+  animation::Track track;
+  track.node = node;
+  track.position_count = 2;
+  clip.position_times = { 0.0f, 1.0f };
+  clip.positions = { glm::vec3(0.0f), glm::vec3(2.0f, 0.0f, 0.0f) };
+  clip.tracks.push_back(track);
+  return clip;
+}
+
+TEST(Animation, SamplesBetweenKeys)
+{
+  animation::Skeleton skeleton = make_chain(2);
+  animation::Clip clip = make_slide(1);
+
+  animation::Pose pose;
+  animation::sample_clip(skeleton, clip, 0.5f, pose);
+  ASSERT_FLOAT_EQ(pose.tx[1], 1.0f);
+  ASSERT_FLOAT_EQ(pose.ty[1], 0.0f);
+  // no track, so still the bind pose
+  ASSERT_FLOAT_EQ(pose.ty[0], 1.0f);
+  ASSERT_FLOAT_EQ(pose.rw[1], skeleton.bind_pose.rw[1]);
+
+  // clamped past the last key
+  animation::sample_clip(skeleton, clip, 2.0f, pose);
+  ASSERT_FLOAT_EQ(pose.tx[1], 2.0f);
+}
+
+TEST(Animation, PaletteMatchesMatrixMaths)
+{
+  // 4 nodes a lane at a time, then 2 left over
+  const size_t nodes = 6;
+  animation::Skeleton skeleton = make_chain(nodes);
+  const animation::Pose& pose = skeleton.bind_pose;
+
+  std::vector<glm::mat4> scratch;
+  std::vector<glm::mat4> palette(nodes);
+  animation::compute_palette(skeleton, pose, scratch, palette.data());
+
+  glm::mat4 global = glm::mat4(1.0f);
+  for (size_t i = 0; i < nodes; i++) {
+    glm::quat rotation(pose.rw[i], pose.rx[i], pose.ry[i], pose.rz[i]);
+    glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(pose.tx[i], pose.ty[i], pose.tz[i])) *
+                      glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), glm::vec3(pose.sx[i], pose.sy[i], pose.sz[i]));
+    global = global * local;
+    glm::mat4 expected = skeleton.global_inverse * global * skeleton.bone_offsets[i];
+
+    for (int c = 0; c < 4; c++) {
+      for (int r = 0; r < 4; r++)
+        ASSERT_NEAR(palette[i][c][r], expected[c][r], 1e-4f);
+    }
+  }
+}
+
+TEST(Animation, UpdatesEveryStateOnThePool)
+{
+  animation::Skeleton skeleton = make_chain(3);
+  std::vector<animation::Clip> clips = { make_slide(2) };
+
+  std::vector<animation::AnimationState> states(10);
+  for (size_t i = 0; i < states.size(); i++)
+    states[i].time = 0.05f * i;
+
+  ThreadPool pool(2);
+  animation::update_animations(skeleton, clips, states, 0.5f, pool);
+
+  for (size_t i = 0; i < states.size(); i++) {
+    const animation::AnimationState& state = states[i];
+    ASSERT_NEAR(state.time, 0.5f + 0.05f * i, 1e-5f);
+    ASSERT_NEAR(state.pose.tx[2], 2.0f * state.time, 1e-5f);
+    ASSERT_EQ(state.palette.size(), 3);
+  }
+
+  // loops back round
+  animation::update_animations(skeleton, clips, states, 0.75f, pool);
+  ASSERT_NEAR(states[0].time, 0.25f, 1e-5f);
+}
+
+TEST(Animation, FindNodeReportsMissingNodes)
+{
+  animation::Skeleton skeleton = make_chain(3);
+  ASSERT_EQ(skeleton.find_node("node0"), 0);
+  ASSERT_EQ(skeleton.find_node("node2"), 2);
+  ASSERT_EQ(skeleton.find_node("not a node"), animation::node_not_found);
+}
@@ -0,0 +1,84 @@
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "engine/bvh.hpp"
+#include "engine/thread_pool.hpp"
+
+using namespace fightingengine;
+
+static std::vector<bvh::Triangle>
+random_triangles(std::mt19937& rng, size_t count)
+{
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+  std::vector<bvh::Triangle> triangles(count);
+  for (bvh::Triangle& triangle : triangles) {
+    triangle.v0 = glm::vec3(position(rng), position(rng), position(rng));
+    triangle.v1 = triangle.v0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+    triangle.v2 = triangle.v0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+  }
+  return triangles;
+}
+
+TEST(Bvh, EveryTriangleIsInOneLeaf)
+{
+  std::mt19937 rng(1);
+  std::vector<bvh::Triangle> triangles = random_triangles(rng, 20000);
+
+  ThreadPool pool(3);
+  bvh::Tree tree = bvh::build(triangles, pool);
+
+  std::vector<int> seen(triangles.size(), 0);
+  for (size_t i = 0; i < tree.nodes.size(); i++) {
+    const bvh::Node& node = tree.nodes[i];
+    if (node.count == 0) {
+      // skip links only ever go forwards, which is what keeps the walk finite
+      ASSERT_GT(node.index, i + 1);
+      ASSERT_LE(node.index, tree.nodes.size());
+      continue;
+    }
+    ASSERT_LE(node.count, bvh::max_leaf_size);
+    for (uint32_t j = node.index; j < node.index + node.count; j++)
+      seen[tree.indices[j]] += 1;
+  }
+  for (int count : seen)
+    ASSERT_EQ(count, 1);
+}
+
+TEST(Bvh, HitsMatchTestingEveryTriangle)
+{
+  std::mt19937 rng(2);
+  std::vector<bvh::Triangle> triangles = random_triangles(rng, 2000);
+
+  ThreadPool pool(2);
+  bvh::Tree tree = bvh::build(triangles, pool);
+
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  int hits = 0;
+  for (int r = 0; r < 2000; r++) {
+    glm::vec3 origin = glm::vec3(unit(rng), unit(rng), unit(rng)) * 15.0f;
+    glm::vec3 direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+
+    bool expected = false;
+    float closest = 1e30f;
+    for (const bvh::Triangle& triangle : triangles) {
+      bvh::Hit candidate;
+      if (bvh::intersect_triangle(triangle, origin, direction, candidate) && candidate.t < closest) {
+        closest = candidate.t;
+        expected = true;
+      }
+    }
+
+    bvh::Hit hit;
+    ASSERT_EQ(bvh::intersect(tree, triangles, origin, direction, hit), expected);
+    if (expected) {
+      ASSERT_FLOAT_EQ(hit.t, closest);
+      hits += 1;
+    }
+  }
+  // or the test isn't testing much
+  ASSERT_GT(hits, 100);
+}
@@ -0,0 +1,97 @@
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "2d_culling.hpp"
+
+using namespace game2d;
+
+static std::vector<uint32_t>
+visible_ids(culling::CullGrid& grid, const GameObject2D& camera)
+{
+  std::vector<std::reference_wrapper<GameObject2D>> visible;
+  culling::query_visible(grid, camera, { 1280, 720 }, visible);
+
+  std::vector<uint32_t> ids;
+  for (auto& obj : visible)
+    ids.push_back(obj.get().id);
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(Culling, GridFollowsSpawnsMovesAndErases)
+{
+  culling::CullGrid grid;
+  GameObject2D camera;
+  camera.pos = { 0.0f, 0.0f };
+
+  std::vector<GameObject2D> objs(3);
+  objs[0].pos = { 100.0f, 100.0f };
+  objs[1].pos = { 5000.0f, 100.0f }; // off screen
+  objs[2].pos = { 600.0f, 300.0f };
+  culling::sync(grid, objs);
+  culling::compact(grid);
+  ASSERT_EQ(grid.objects, 3);
+  ASSERT_EQ(visible_ids(grid, camera), std::vector<uint32_t>({ objs[0].id, objs[2].id }));
+
+  // the vector reallocates, and one object walks on screen
+  for (int i = 0; i < 100; i++)
+    objs.emplace_back().pos = { 10000.0f + i * 300.0f, 0.0f };
+  objs[1].pos = { 700.0f, 100.0f };
+  culling::sync(grid, objs);
+  culling::compact(grid);
+  ASSERT_EQ(grid.objects, 103);
+  ASSERT_EQ(visible_ids(grid, camera), std::vector<uint32_t>({ objs[0].id, objs[1].id, objs[2].id }));
+
+  // erased objects leave the grid, and the ones after them shift down
+  const uint32_t erased = objs[0].id;
+  objs[0].flag_for_delete = true;
+  culling::remove_flagged(grid, objs);
+  objs.erase(objs.begin());
+  culling::sync(grid, objs);
+  culling::compact(grid);
+  ASSERT_EQ(grid.objects, 102);
+  std::vector<uint32_t> ids = visible_ids(grid, camera);
+  ASSERT_TRUE(std::find(ids.begin(), ids.end(), erased) == ids.end());
+  ASSERT_EQ(ids.size(), 2u);
+
+  // static and hidden objects aren't culled here
+  objs[0].do_render_static = true;
+  objs[1].do_render = false;
+  culling::sync(grid, objs);
+  culling::compact(grid);
+  ASSERT_EQ(grid.objects, 100);
+  ASSERT_TRUE(visible_ids(grid, camera).empty());
+
+  // empty cells are freed, not kept around forever
+  for (GameObject2D& obj : objs)
+    culling::remove(grid, obj);
+  culling::compact(grid);
+  ASSERT_EQ(grid.objects, 0);
+  ASSERT_TRUE(grid.cell_index.empty());
+  ASSERT_EQ(grid.free_cells.size(), grid.cells.size());
+}
+
+TEST(Culling, OnlyCellsUnderTheCameraAreVisited)
+{
+  culling::CullGrid grid;
+  GameObject2D camera;
+  camera.pos = { 0.0f, 0.0f };
+
+  // a 100x100 cell world, one object in each
+  std::vector<GameObject2D> objs(100 * 100);
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++)
+      objs[y * 100 + x].pos = glm::vec2(x, y) * static_cast<float>(grid.grid_size) + glm::vec2(10.0f);
+  }
+  culling::sync(grid, objs);
+  culling::compact(grid);
+
+  std::vector<std::reference_wrapper<GameObject2D>> visible;
+  culling::query_visible(grid, camera, { 1280, 720 }, visible);
+  ASSERT_LT(grid.cells_visited, 100);
+  ASSERT_LT(grid.objects_tested, 100);
+  ASSERT_GT(grid.objects_visible, 0);
+}
@@ -0,0 +1,59 @@
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "engine/maths_core.hpp"
+
+using namespace fightingengine;
+
+// one bit at a time, what morton_encode_2d() has to match
+static uint64_t
+interleave_bits(uint32_t x, uint32_t y)
+{
+  uint64_t code = 0;
+  for (int i = 0; i < 32; i++) {
+    code |= static_cast<uint64_t>((x >> i) & 1) << (2 * i);
+    code |= static_cast<uint64_t>((y >> i) & 1) << (2 * i + 1);
+  }
+  return code;
+}
+
+TEST(Morton, EncodeAndDecodeMatchTheBitLoop)
+{
+  ASSERT_EQ(morton_encode_2d(0u, 0u), 0u);
+  ASSERT_EQ(morton_encode_2d(1u, 0u), 1u);
+  ASSERT_EQ(morton_encode_2d(0u, 1u), 2u);
+  ASSERT_EQ(morton_encode_2d(3u, 5u), 0b100111u);
+  ASSERT_EQ(morton_encode_2d(0xFFFFFFFFu, 0xFFFFFFFFu), 0xFFFFFFFFFFFFFFFFull);
+
+  std::mt19937 rng(1);
+  for (int i = 0; i < 10000; i++) {
+    const uint32_t x = rng();
+    const uint32_t y = rng();
+    const uint64_t code = morton_encode_2d(x, y);
+    ASSERT_EQ(code, interleave_bits(x, y));
+
+    uint32_t decoded_x = 0;
+    uint32_t decoded_y = 0;
+    morton_decode_2d(code, decoded_x, decoded_y);
+    ASSERT_EQ(decoded_x, x);
+    ASSERT_EQ(decoded_y, y);
+  }
+}
+
+TEST(Morton, PairKeysIgnoreOrder)
+{
+  ASSERT_EQ(encode_cantor_pairing_function(12, 7), encode_cantor_pairing_function(7, 12));
+  ASSERT_NE(encode_cantor_pairing_function(7, 12), encode_cantor_pairing_function(7, 13));
+
+  uint32_t x = 0;
+  uint32_t y = 0;
+  decode_cantor_pairing_function(encode_cantor_pairing_function(12, 7), x, y);
+  ASSERT_EQ(x, 7u);
+  ASSERT_EQ(y, 12u);
+
+  // negative cells sort before positive ones
+  ASSERT_LT(morton_encode_2d(glm::ivec2(-1, -1)), morton_encode_2d(glm::ivec2(0, 0)));
+  ASSERT_LT(morton_encode_2d(glm::ivec2(0, 0)), morton_encode_2d(glm::ivec2(1, 1)));
+}
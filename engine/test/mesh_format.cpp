@@ -0,0 +1,152 @@
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+
+#include "engine/mapped_file.hpp"
+#include "engine/mesh_format.hpp"
+
+using namespace fightingengine;
+
+TEST(MeshFormat, WritesAndMapsMeshes)
+{
+  mesh_format::MeshData mesh;
+  for (int i = 0; i < 3; i++) {
+    mesh_format::Vertex vertex = {};
+    vertex.position[0] = static_cast<float>(i);
+    vertex.position[1] = static_cast<float>(-i);
+    mesh.vertices.push_back(vertex);
+  }
+  mesh.indices = { 0, 1, 2, 0, 2, 1 };
+  mesh_format::Submesh first;
+  first.index_count = 3;
+  first.vertex_count = 3;
+  mesh_format::Submesh second = first;
+  second.first_index = 3;
+  mesh.submeshes = { first, second };
+  mesh.bounds = mesh_format::compute_bounds(mesh.vertices.data(), mesh.vertices.size());
+  ASSERT_EQ(mesh.bounds.max[0], 2.0f);
+  ASSERT_EQ(mesh.bounds.min[1], -2.0f);
+
+  std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test.mesh").string();
+  ASSERT_TRUE(mesh_format::write(path, mesh));
+
+  MappedFile file;
+  ASSERT_TRUE(map_file(path, file));
+
+  mesh_format::MeshView view;
+  ASSERT_TRUE(mesh_format::parse(file.data, file.size, view));
+  ASSERT_EQ(view.header->vertex_count, 3);
+  ASSERT_EQ(view.header->index_count, 6);
+  ASSERT_EQ(view.header->submesh_count, 2);
+  ASSERT_EQ(view.header->vertex_offset % 16, 0);
+  ASSERT_EQ(view.header->index_size, 4);
+  ASSERT_EQ(reinterpret_cast<const mesh_format::Vertex*>(view.vertex_data)[2].position[0], 2.0f);
+  ASSERT_EQ(reinterpret_cast<const uint32_t*>(view.index_data)[4], 2);
+  ASSERT_EQ(view.submeshes[1].first_index, 3);
+
+  // a truncated file is rejected, not read past the end
+  ASSERT_FALSE(mesh_format::parse(file.data, file.size - 8, view));
+
+  unmap_file(file);
+  ASSERT_EQ(file.data, nullptr);
+  std::filesystem::remove(path);
+}
+
+TEST(MeshFormat, QuantizedVerticesRoundTrip)
+{
+  mesh_format::Bounds bounds;
+  bounds.min[0] = bounds.min[1] = bounds.min[2] = -10.0f;
+  bounds.max[0] = bounds.max[1] = bounds.max[2] = 10.0f;
+
+  mesh_format::Vertex vertex = {};
+  vertex.position[0] = 3.25f;
+  vertex.position[1] = -9.5f;
+  vertex.position[2] = 0.1f;
+  vertex.normal[0] = 0.0f;
+  vertex.normal[1] = -0.6f;
+  vertex.normal[2] = -0.8f;
+  vertex.tex_coords[0] = 0.5f;
+  vertex.tex_coords[1] = 0.123f;
+
+  mesh_format::Vertex decoded = mesh_format::dequantize_vertex(mesh_format::quantize_vertex(vertex, bounds), bounds);
+  for (int axis = 0; axis < 3; axis++) {
+    ASSERT_NEAR(decoded.position[axis], vertex.position[axis], 20.0f / 65535.0f);
+    ASSERT_NEAR(decoded.normal[axis], vertex.normal[axis], 0.001f);
+  }
+  ASSERT_EQ(decoded.tex_coords[0], 0.5f);
+  ASSERT_NEAR(decoded.tex_coords[1], 0.123f, 0.0001f);
+}
+
+TEST(MeshFormat, HalfFloats)
+{
+  ASSERT_EQ(mesh_format::float_to_half(1.0f), 0x3c00);
+  ASSERT_EQ(mesh_format::float_to_half(-2.0f), 0xc000);
+  ASSERT_EQ(mesh_format::float_to_half(0.0f), 0x0000);
+  ASSERT_EQ(mesh_format::float_to_half(1e6f), 0x7c00); // inf
+  ASSERT_EQ(mesh_format::half_to_float(0x3555), mesh_format::half_to_float(mesh_format::float_to_half(0.333333f)));
+  ASSERT_EQ(mesh_format::half_to_float(0x0001), 5.9604645e-8f); // smallest subnormal
+  ASSERT_EQ(mesh_format::float_to_half(5.9604645e-8f), 0x0001);
+}
+
+TEST(MeshFormat, BakedLayoutIsConvertedToTheOneAskedFor)
+{
+  // cooked with the default float layout, loaded by a renderer built for quantized vertices
+  mesh_format::MeshData mesh;
+  for (int i = 0; i < 4; i++) {
+    mesh_format::Vertex vertex = {};
+    vertex.position[0] = static_cast<float>(i) * 2.5f;
+    vertex.position[1] = -static_cast<float>(i);
+    vertex.position[2] = 1.0f;
+    vertex.normal[2] = 1.0f;
+    vertex.tex_coords[0] = 0.25f * i;
+    mesh.vertices.push_back(vertex);
+  }
+  mesh.indices = { 0, 1, 2, 0, 2, 3 };
+  mesh_format::Submesh submesh;
+  submesh.index_count = 6;
+  submesh.vertex_count = 4;
+  mesh.submeshes = { submesh };
+  mesh.bounds = mesh_format::compute_bounds(mesh.vertices.data(), mesh.vertices.size());
+
+  std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test_layout.mesh").string();
+  ASSERT_TRUE(mesh_format::write(path, mesh));
+  MappedFile file;
+  ASSERT_TRUE(map_file(path, file));
+  mesh_format::MeshView view;
+  ASSERT_TRUE(mesh_format::parse(file.data, file.size, view));
+  ASSERT_EQ(view.header->vertex_layout, mesh_format::VertexLayout::Float);
+
+  std::vector<uint8_t> quantized = mesh_format::convert_vertices(view, mesh_format::VertexLayout::Quantized);
+  ASSERT_EQ(quantized.size(), mesh.vertices.size() * sizeof(mesh_format::QuantizedVertex));
+  const auto* q = reinterpret_cast<const mesh_format::QuantizedVertex*>(quantized.data());
+  for (size_t i = 0; i < mesh.vertices.size(); i++) {
+    mesh_format::Vertex decoded = mesh_format::dequantize_vertex(q[i], view.header->bounds);
+    for (int axis = 0; axis < 3; axis++)
+      ASSERT_NEAR(decoded.position[axis], mesh.vertices[i].position[axis], 0.001f);
+    ASSERT_EQ(decoded.tex_coords[0], mesh.vertices[i].tex_coords[0]);
+  }
+
+  // the same layout is a plain copy
+  std::vector<uint8_t> same = mesh_format::convert_vertices(view, mesh_format::VertexLayout::Float);
+  ASSERT_EQ(same.size(), mesh.vertices.size() * sizeof(mesh_format::Vertex));
+  ASSERT_EQ(std::memcmp(same.data(), view.vertex_data, same.size()), 0);
+
+  unmap_file(file);
+  std::filesystem::remove(path);
+
+  // and back, a quantized bake loaded as floats
+  mesh.layout = mesh_format::VertexLayout::Quantized;
+  ASSERT_TRUE(mesh_format::write(path, mesh));
+  ASSERT_TRUE(map_file(path, file));
+  ASSERT_TRUE(mesh_format::parse(file.data, file.size, view));
+  std::vector<uint8_t> floats = mesh_format::convert_vertices(view, mesh_format::VertexLayout::Float);
+  const auto* f = reinterpret_cast<const mesh_format::Vertex*>(floats.data());
+  for (size_t i = 0; i < mesh.vertices.size(); i++) {
+    for (int axis = 0; axis < 3; axis++)
+      ASSERT_NEAR(f[i].position[axis], mesh.vertices[i].position[axis], 0.001f);
+  }
+  unmap_file(file);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,115 @@
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "engine/tools/metrics.hpp"
+
+using namespace fightingengine;
+
+static std::string
+read_file(const std::string& path)
+{
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+TEST(Metrics, CountersResetAndGaugesHold)
+{
+  metrics::clear();
+  const metrics::Id hits = metrics::register_counter("hits");
+  const metrics::Id entities = metrics::register_gauge("entities");
+  ASSERT_EQ(metrics::register_counter("hits"), hits);
+
+  metrics::add(hits);
+  metrics::add(hits, 2.0);
+  metrics::set(entities, 10.0);
+  metrics::new_frame();
+  ASSERT_EQ(metrics::get_last(hits), 3.0f);
+  ASSERT_EQ(metrics::get_last(entities), 10.0f);
+
+  metrics::new_frame();
+  ASSERT_EQ(metrics::get_last(hits), 0.0f);
+  ASSERT_EQ(metrics::get_last(entities), 10.0f);
+
+  std::vector<float> samples;
+  metrics::get_samples(hits, samples);
+  ASSERT_EQ(samples, std::vector<float>({ 3.0f, 0.0f }));
+
+  // the ring keeps the last history_frames, oldest first
+  for (uint32_t frame = 0; frame < metrics::history_frames + 5; frame++) {
+    metrics::set(entities, frame);
+    metrics::new_frame();
+  }
+  metrics::get_samples(entities, samples);
+  ASSERT_EQ(samples.size(), metrics::history_frames);
+  ASSERT_EQ(samples.front(), 5.0f);
+  ASSERT_EQ(samples.back(), metrics::history_frames + 4.0f);
+  metrics::clear();
+}
+
+TEST(Metrics, ExportsCsvAndJson)
+{
+  metrics::clear();
+  const metrics::Id draw_calls = metrics::register_gauge("draw calls");
+  metrics::set(draw_calls, 4.0);
+  metrics::new_frame();
+
+  // registered a frame late, so it has no sample for frame 0
+  const metrics::Id pairs = metrics::register_counter("collision pairs");
+  metrics::add(pairs, 7.0);
+  metrics::new_frame();
+
+  const std::string csv_path = (std::filesystem::temp_directory_path() / "fightingengine_metrics.csv").string();
+  ASSERT_TRUE(metrics::write_csv(csv_path));
+  ASSERT_EQ(read_file(csv_path), "frame,draw calls,collision pairs\n0,4,\n1,4,7\n");
+  std::filesystem::remove(csv_path);
+
+  const std::string json_path = (std::filesystem::temp_directory_path() / "fightingengine_metrics.json").string();
+  ASSERT_TRUE(metrics::write_json(json_path));
+  const std::string json = read_file(json_path);
+  ASSERT_NE(json.find("\"draw calls\":{\"kind\":\"gauge\",\"first_frame\":0,\"samples\":[4,4]}"), std::string::npos);
+  ASSERT_NE(json.find("\"collision pairs\":{\"kind\":\"counter\",\"first_frame\":1,\"samples\":[7]}"),
+            std::string::npos);
+  std::filesystem::remove(json_path);
+  metrics::clear();
+}
+
+TEST(Metrics, HistoryCanBeSizedToTheRun)
+{
+  metrics::clear();
+  metrics::Id ticks = metrics::register_gauge("ticks");
+
+  // sized up front, like a headless run, every frame is kept
+  const uint32_t frames = metrics::history_frames * 5;
+  metrics::set_history_frames(frames);
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    metrics::set(ticks, frame);
+    metrics::new_frame();
+  }
+  std::vector<float> samples;
+  metrics::get_samples(ticks, samples);
+  ASSERT_EQ(samples.size(), frames);
+  ASSERT_EQ(samples.front(), 0.0f);
+  ASSERT_EQ(samples.back(), frames - 1.0f);
+
+  // shrinking keeps the newest
+  metrics::set_history_frames(10);
+  metrics::get_samples(ticks, samples);
+  ASSERT_EQ(samples.size(), 10);
+  ASSERT_EQ(samples.front(), frames - 10.0f);
+  ASSERT_EQ(samples.back(), frames - 1.0f);
+
+  // growing again doesn't bring back what was dropped
+  metrics::set_history_frames(frames);
+  metrics::get_samples(ticks, samples);
+  ASSERT_EQ(samples.size(), 10);
+  ASSERT_EQ(samples.front(), frames - 10.0f);
+
+  metrics::clear();
+  ASSERT_EQ(metrics::get_history_frames(), metrics::history_frames);
+}
@@ -0,0 +1,144 @@
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "engine/path_tracer.hpp"
+#include "engine/thread_pool.hpp"
+
+using namespace fightingengine;
+
+static path_tracer::Scene
+random_scene(std::mt19937& rng)
+{
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+  path_tracer::Scene scene;
+  scene.triangles.resize(3000);
+  for (bvh::Triangle& triangle : scene.triangles) {
+    triangle.v0 = glm::vec3(position(rng), position(rng), position(rng));
+    triangle.v1 = triangle.v0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+    triangle.v2 = triangle.v0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+  }
+  for (int i = 0; i < 8; i++) {
+    path_tracer::Sphere sphere;
+    sphere.position = glm::vec3(position(rng), position(rng), position(rng));
+    sphere.radius = 1.5f;
+    scene.spheres.push_back(sphere);
+  }
+  return scene;
+}
+
+TEST(PathTracer, PacketHitsMatchSingleRays)
+{
+  std::mt19937 rng(3);
+  path_tracer::Scene scene = random_scene(rng);
+  ThreadPool pool(2);
+  path_tracer::build_scene(scene, pool);
+
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  int triangle_hits = 0;
+  int sphere_hits = 0;
+  for (int packet = 0; packet < 500; packet++) {
+    glm::vec3 origins[4];
+    glm::vec3 directions[4];
+    for (int lane = 0; lane < 4; lane++) {
+      origins[lane] = glm::vec3(unit(rng), unit(rng), unit(rng)) * 15.0f;
+      directions[lane] = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+    }
+    // leave a lane out now and then
+    const int active = packet % 5 == 0 ? 0xB : 0xF;
+
+    path_tracer::PacketHit hit;
+    path_tracer::intersect_packet(scene, origins, directions, active, hit);
+
+    for (int lane = 0; lane < 4; lane++) {
+      if ((active & (1 << lane)) == 0) {
+        ASSERT_EQ(hit.triangle[lane], -1);
+        ASSERT_EQ(hit.sphere[lane], -1);
+        continue;
+      }
+
+      float closest = 1e10f;
+      bvh::Hit triangle;
+      const bool found_triangle = bvh::intersect(scene.tree, scene.triangles, origins[lane], directions[lane], triangle);
+      if (found_triangle)
+        closest = triangle.t;
+
+      int sphere = -1;
+      for (size_t s = 0; s < scene.spheres.size(); s++) {
+        const glm::vec3 oc = origins[lane] - scene.spheres[s].position;
+        const float half_b = glm::dot(oc, directions[lane]);
+        const float c = glm::dot(oc, oc) - scene.spheres[s].radius * scene.spheres[s].radius;
+        const float discriminant = half_b * half_b - c;
+        if (discriminant <= 0.0f)
+          continue;
+        const float t = -half_b - std::sqrt(discriminant);
+        if (t > 0.0001f && t < closest) {
+          closest = t;
+          sphere = static_cast<int>(s);
+        }
+      }
+
+      if (sphere >= 0) {
+        ASSERT_EQ(hit.sphere[lane], sphere);
+        ASSERT_NEAR(hit.distance[lane], closest, 1e-3f);
+        sphere_hits += 1;
+      } else if (found_triangle) {
+        ASSERT_EQ(hit.triangle[lane], static_cast<int>(triangle.triangle));
+        ASSERT_NEAR(hit.distance[lane], closest, 1e-3f);
+        triangle_hits += 1;
+      } else {
+        ASSERT_EQ(hit.triangle[lane], -1);
+        ASSERT_EQ(hit.sphere[lane], -1);
+      }
+    }
+  }
+  ASSERT_GT(triangle_hits, 50);
+  ASSERT_GT(sphere_hits, 20);
+}
+
+TEST(PathTracer, SamplesAccumulateTheSameOnAnyThreadCount)
+{
+  path_tracer::Scene scene;
+  path_tracer::Sphere sphere;
+  sphere.position = glm::vec3(0.0f, 0.0f, -3.0f);
+  scene.spheres.push_back(sphere);
+  sphere.position = glm::vec3(0.0f, -101.0f, -3.0f);
+  sphere.radius = 100.0f;
+  sphere.material.type = path_tracer::MaterialType::Metal;
+  scene.spheres.push_back(sphere);
+
+  path_tracer::View view;
+  path_tracer::Settings settings;
+  settings.tile_size = 8; // odd sized film, so some packets are partly off the edge
+
+  ThreadPool serial(0);
+  ThreadPool parallel(3);
+  path_tracer::build_scene(scene, serial);
+
+  path_tracer::Film a;
+  path_tracer::Film b;
+  path_tracer::reset_film(a, 21, 15);
+  path_tracer::reset_film(b, 21, 15);
+  for (int i = 0; i < 3; i++) {
+    path_tracer::render_sample(scene, view, settings, a, serial);
+    path_tracer::render_sample(scene, view, settings, b, parallel);
+  }
+  ASSERT_EQ(a.samples, 3u);
+  ASSERT_EQ(b.samples, 3u);
+  for (size_t i = 0; i < a.accumulated.size(); i++) {
+    ASSERT_EQ(a.accumulated[i], b.accumulated[i]);
+    ASSERT_GT(a.accumulated[i].b, 0.0f); // every pixel was written
+  }
+
+  std::vector<uint8_t> rgba;
+  path_tracer::resolve_film(a, rgba);
+  ASSERT_EQ(rgba.size(), size_t(21 * 15 * 4));
+  // the red sphere is in the middle of the view, the sky is blue at the top
+  const uint8_t* middle = &rgba[(7 * 21 + 10) * 4];
+  const uint8_t* top = &rgba[(14 * 21 + 10) * 4];
+  ASSERT_GT(middle[0], middle[2]);
+  ASSERT_GT(top[2], top[0]);
+}
@@ -0,0 +1,270 @@
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "engine/thread_pool.hpp"
+#include "engine/tools/profiler.hpp"
+
+using namespace fightingengine;
+
+static size_t
+count_named(const std::vector<profiler::Zone>& zones, const char* name)
+{
+  size_t count = 0;
+  for (const profiler::Zone& zone : zones)
+    count += std::strcmp(zone.name, name) == 0 ? 1 : 0;
+  return count;
+}
+
+TEST(Profiler, ZonesNestAndComeFromEveryThread)
+{
+  std::vector<profiler::Zone> zones;
+  profiler::collect_zones(zones); // anything left over from other tests
+  zones.clear();
+
+  {
+    PROFILE_ZONE("outer");
+    {
+      PROFILE_ZONE("inner");
+    }
+  }
+
+  // a thread that has exited still has its zones collected
+  std::thread thread([]() { PROFILE_ZONE("short lived thread"); });
+  thread.join();
+
+  ThreadPool pool(3);
+  pool.parallel_for(64, 1, [](size_t begin, size_t end) { PROFILE_ZONE("chunk"); });
+
+  profiler::collect_zones(zones);
+  ASSERT_EQ(count_named(zones, "chunk"), 64);
+  ASSERT_EQ(count_named(zones, "short lived thread"), 1);
+
+  // inner ends first, so it's written first
+  const uint32_t main_thread = profiler::get_thread_id();
+  const profiler::Zone* inner = nullptr;
+  const profiler::Zone* outer = nullptr;
+  for (const profiler::Zone& zone : zones) {
+    if (std::strcmp(zone.name, "inner") == 0)
+      inner = &zone;
+    if (std::strcmp(zone.name, "outer") == 0)
+      outer = &zone;
+  }
+  ASSERT_NE(inner, nullptr);
+  ASSERT_NE(outer, nullptr);
+  ASSERT_LT(inner, outer);
+  ASSERT_EQ(outer->depth, 0);
+  ASSERT_EQ(inner->depth, 1);
+  ASSERT_EQ(inner->thread, main_thread);
+  ASSERT_LE(outer->start_ns, inner->start_ns);
+  ASSERT_GE(outer->end_ns, inner->end_ns);
+
+  // collected zones aren't handed out twice
+  zones.clear();
+  profiler::collect_zones(zones);
+  ASSERT_EQ(count_named(zones, "chunk"), 0);
+}
+
+TEST(Profiler, FullBuffersDropZones)
+{
+  std::vector<profiler::Zone> zones;
+  profiler::collect_zones(zones);
+  (void)profiler::take_dropped_zone_count();
+  zones.clear();
+
+  for (uint32_t i = 0; i < profiler::zones_per_thread + 10; i++) {
+    PROFILE_ZONE("spam");
+  }
+  ASSERT_EQ(profiler::take_dropped_zone_count(), 10);
+
+  profiler::collect_zones(zones);
+  ASSERT_EQ(count_named(zones, "spam"), profiler::zones_per_thread);
+
+  // and there's room again once collected
+  {
+    PROFILE_ZONE("spam");
+  }
+  zones.clear();
+  profiler::collect_zones(zones);
+  ASSERT_EQ(zones.size(), 1);
+  ASSERT_EQ(profiler::take_dropped_zone_count(), 0);
+}
+
+TEST(Profiler, WritesTheTraceWindow)
+{
+  Profiler profiler;
+  profiler.set_trace_window(60.0f);
+  profiler::set_thread_name("test \"main\"");
+
+  profiler.new_frame();
+  {
+    PROFILE_ZONE("traced zone");
+  }
+  profiler::record_counter("traced counter", 42.5);
+  profiler.new_frame();
+
+  std::string path = (std::filesystem::temp_directory_path() / "fightingengine_trace.json").string();
+  ASSERT_TRUE(profiler.write_trace(path));
+
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string json = contents.str();
+  ASSERT_NE(json.find("\"traceEvents\""), std::string::npos);
+  ASSERT_NE(json.find("{\"name\":\"traced zone\",\"ph\":\"X\""), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"traced counter\",\"ph\":\"C\""), std::string::npos);
+  ASSERT_NE(json.find("\"value\":42.5}"), std::string::npos);
+  ASSERT_NE(json.find("\"name\":\"test \\\"main\\\"\""), std::string::npos);
+
+  // outside the window, zones are let go of
+  profiler.set_trace_window(0.001f);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  profiler.new_frame();
+  ASSERT_TRUE(profiler.write_trace(path));
+  std::ifstream trimmed(path);
+  contents.str("");
+  contents << trimmed.rdbuf();
+  ASSERT_EQ(contents.str().find("traced zone"), std::string::npos);
+
+  std::filesystem::remove(path);
+}
+
+// the profiler's clock in the tests, only moves when advance() is called
+static Profiler::Clock::time_point fake_time;
+
+static Profiler::Clock::time_point
+fake_clock()
+{
+  return fake_time;
+}
+
+static void
+advance(int ms)
+{
+  fake_time += std::chrono::milliseconds(ms);
+}
+
+TEST(Profiler, StageTimesAndPercentiles)
+{
+  Profiler profiler;
+  profiler.set_time_source(&fake_clock);
+  profiler.set_hitch_threshold(15.0f);
+  profiler.new_frame();
+
+  // 19 frames of 2ms with a 1ms tick, then one of 21ms with a 20ms tick
+  for (int frame = 0; frame < 20; frame++) {
+    profiler.begin(Profiler::Stage::GameTick);
+    advance(frame == 19 ? 20 : 1);
+    profiler.end(Profiler::Stage::GameTick);
+    {
+      PROFILE_ZONE("slow frame zone");
+    }
+    advance(1);
+    profiler.new_frame();
+  }
+
+  // get_time() is the stage's own time, and stages that didn't run are 0
+  ASSERT_FLOAT_EQ(profiler.get_time(Profiler::Stage::GameTick), 20.0f);
+  ASSERT_EQ(profiler.get_time(Profiler::Stage::Render), 0.0f);
+
+  const Profiler::Stats tick = profiler.get_stats(Profiler::Stage::GameTick);
+  ASSERT_EQ(tick.samples, 20);
+  ASSERT_FLOAT_EQ(tick.p50, 1.0f);
+  ASSERT_FLOAT_EQ(tick.p95, 1.0f); // nearest rank: the 19th of 20
+  ASSERT_FLOAT_EQ(tick.p99, 20.0f);
+  ASSERT_FLOAT_EQ(tick.max, 20.0f);
+  ASSERT_FLOAT_EQ(tick.mean, 39.0f / 20.0f);
+  ASSERT_EQ(profiler.get_stats(Profiler::Stage::Render).samples, 0);
+
+  const Profiler::Stats frame = profiler.get_frame_stats();
+  ASSERT_EQ(frame.samples, 20);
+  ASSERT_FLOAT_EQ(frame.p50, 2.0f);
+  ASSERT_FLOAT_EQ(frame.max, 21.0f);
+
+  // 1ms buckets
+  const auto& histogram = profiler.get_frame_histogram();
+  ASSERT_EQ(histogram[2], 19);
+  ASSERT_EQ(histogram[21], 1);
+  uint32_t histogram_frames = 0;
+  for (uint32_t count : histogram)
+    histogram_frames += count;
+  ASSERT_EQ(histogram_frames, 20);
+
+  // only the slow frame is kept, with its zones
+  ASSERT_EQ(profiler.get_hitches().size(), 1);
+  const Profiler::Hitch& hitch = profiler.get_hitches().front();
+  ASSERT_EQ(hitch.frame, 20);
+  ASSERT_FLOAT_EQ(hitch.frame_ms, 21.0f);
+  ASSERT_FLOAT_EQ(hitch.stage_ms[static_cast<uint8_t>(Profiler::Stage::GameTick)], 20.0f);
+  ASSERT_LT(hitch.stage_ms[static_cast<uint8_t>(Profiler::Stage::Render)], 0.0f);
+  ASSERT_EQ(count_named(hitch.zones, "slow frame zone"), 1);
+}
+
+TEST(Profiler, HistogramOnlyCountsTheHistory)
+{
+  Profiler profiler;
+  profiler.new_frame();
+  for (uint32_t frame = 0; frame < Profiler::history_frames + 10; frame++)
+    profiler.new_frame();
+
+  uint32_t histogram_frames = 0;
+  for (uint32_t count : profiler.get_frame_histogram())
+    histogram_frames += count;
+  ASSERT_EQ(histogram_frames, Profiler::history_frames);
+  ASSERT_EQ(profiler.get_frame_stats().samples, Profiler::history_frames);
+  ASSERT_TRUE(profiler.get_hitches().empty());
+}
+
+TEST(Profiler, ZonesCountTheirAllocations)
+{
+  if (!profiler::allocation_tracking)
+    GTEST_SKIP() << "built without FIGHTINGENGINE_TRACK_ALLOCATIONS";
+
+  std::vector<profiler::Zone> zones;
+  profiler::collect_zones(zones);
+  zones.clear();
+
+  Profiler profiler;
+  profiler.new_frame();
+  const profiler::AllocationStats before = profiler::get_allocation_stats();
+  {
+    PROFILE_ZONE("allocating");
+    std::vector<int> numbers(1000);
+    {
+      PROFILE_ZONE("allocating more");
+      std::unique_ptr<int[]> more = std::make_unique<int[]>(500);
+    }
+  }
+  const profiler::AllocationStats after = profiler::get_allocation_stats();
+  ASSERT_GE(after.allocations - before.allocations, 2);
+  ASSERT_GE(after.frees - before.frees, 2);
+  ASSERT_GE(after.peak_live_bytes, before.live_bytes + 1500 * sizeof(int));
+
+  profiler.new_frame();
+  const Profiler::FrameAllocations& frame = profiler.get_allocations();
+  ASSERT_GE(frame.allocations, 2);
+  ASSERT_GE(frame.allocated_bytes, 1500 * sizeof(int));
+  ASSERT_GE(frame.peak_live_bytes, frame.live_bytes);
+
+  // nested zones count in their parents too
+  const profiler::Zone* outer = nullptr;
+  const profiler::Zone* inner = nullptr;
+  for (const profiler::Zone& zone : profiler.get_zones()) {
+    if (std::strcmp(zone.name, "allocating") == 0)
+      outer = &zone;
+    if (std::strcmp(zone.name, "allocating more") == 0)
+      inner = &zone;
+  }
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  ASSERT_EQ(inner->allocations, 1);
+  ASSERT_EQ(inner->allocated_bytes, 500 * sizeof(int));
+  ASSERT_GE(outer->allocations, 2);
+  ASSERT_GE(outer->allocated_bytes, 1500 * sizeof(int));
+}
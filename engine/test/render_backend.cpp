@@ -0,0 +1,76 @@
+
+#include <gtest/gtest.h>
+
+#include "engine/opengl/recording_backend.hpp"
+#include "engine/opengl/render_backend.hpp"
+#include "engine/opengl/render_command.hpp"
+#include "engine/opengl/shader.hpp"
+#include "engine/opengl/texture.hpp"
+
+using namespace fightingengine;
+
+TEST(RecordingRenderBackend, RecordsRenderCommands)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+
+  RenderCommand::set_viewport(0, 0, 1280, 720);
+  RenderCommand::set_clear_colour(glm::vec4(1.0f));
+  RenderCommand::clear();
+  bind_tex_array(3, 0);
+
+  set_render_backend(nullptr);
+
+  ASSERT_EQ(recording.commands.size(), 4);
+  ASSERT_EQ(recording.commands[2].type, RecordedCommandType::Clear);
+  ASSERT_EQ(recording.stats.texture_binds, 1);
+  ASSERT_EQ(recording.stats.draw_calls, 0);
+}
+
+TEST(RecordingRenderBackend, CountsUploadsAndDraws)
+{
+  RecordingRenderBackend recording;
+
+  unsigned int vao = recording.create_vertex_array();
+  unsigned int vbo = recording.create_buffer();
+  ASSERT_NE(vao, vbo);
+
+  float vertices[16] = {};
+  recording.buffer_data(0, sizeof(vertices), nullptr, 0); // allocation only
+  recording.buffer_sub_data(0, 0, sizeof(vertices), vertices);
+  recording.bind_vertex_array(vao);
+  recording.draw_indexed_triangles(6);
+  recording.draw_indexed_triangles(12);
+
+  ASSERT_EQ(recording.stats.bytes_uploaded, sizeof(vertices));
+  ASSERT_EQ(recording.stats.draw_calls, 2);
+  ASSERT_EQ(recording.stats.indices_drawn, 18);
+
+  recording.reset();
+  ASSERT_EQ(recording.stats.draw_calls, 0);
+  ASSERT_TRUE(recording.commands.empty());
+}
+
+TEST(RecordingRenderBackend, UniformLocationsAreStablePerProgram)
+{
+  RecordingRenderBackend recording;
+  unsigned int program = recording.create_program("", "");
+
+  int a = recording.get_uniform_location(program, "projection");
+  int b = recording.get_uniform_location(program, "view");
+  ASSERT_NE(a, b);
+  ASSERT_EQ(a, recording.get_uniform_location(program, "projection"));
+
+  recording.set_uniform_int(a, 1);
+  ASSERT_EQ(recording.stats.uniform_sets, 1);
+}
+
+TEST(UniformName, LiteralsAndStringsHashTheSame)
+{
+  constexpr UniformName literal("tex_uv_scale[1]");
+  static_assert(literal.hash == hash_uniform_name("tex_uv_scale[1]"), "uniform names should hash at compile time");
+
+  std::string built = "tex_uv_scale[" + std::to_string(1) + "]";
+  ASSERT_EQ(UniformName(built).hash, literal.hash);
+  ASSERT_NE(UniformName("projection").hash, UniformName("view").hash);
+}
@@ -0,0 +1,78 @@
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "opengl/render_queue.hpp"
+
+using namespace game2d;
+
+TEST(RenderQueue, RadixSortMatchesStableSort)
+{
+  std::vector<GameObject2D> objs(2000);
+
+  std::mt19937_64 rng(1);
+  std::vector<render_queue::DrawItem> items(objs.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    // few distinct layers and states, so plenty of equal keys to check stability on
+    const RenderLayer layer = static_cast<RenderLayer>(rng() % 3);
+    const uint16_t depth = static_cast<uint16_t>(rng() % 64);
+    const BlendMode blend = rng() % 2 == 0 ? BlendMode::Alpha : BlendMode::Additive;
+    items[i].key = render_queue::make_key(layer, depth, rng() % 2, rng() % 2, blend);
+    items[i].go = &objs[i];
+  }
+
+  std::vector<render_queue::DrawItem> expected = items;
+  std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+  std::vector<render_queue::DrawItem> scratch;
+  render_queue::radix_sort(items, scratch);
+
+  ASSERT_EQ(items.size(), expected.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    ASSERT_EQ(items[i].key, expected[i].key);
+    ASSERT_EQ(items[i].go, expected[i].go);
+  }
+}
+
+TEST(RenderQueue, RadixSortSkipsOnlySharedDigits)
+{
+  // every key but one has the same top byte, the odd one has to still move
+  std::vector<render_queue::DrawItem> items(3);
+  items[0].key = 0x0100'0000'0000'0000;
+  items[1].key = 0x0000'0000'0000'0002;
+  items[2].key = 0x0000'0000'0000'0001;
+
+  std::vector<render_queue::DrawItem> scratch;
+  render_queue::radix_sort(items, scratch);
+  ASSERT_EQ(items[0].key, 0x0000'0000'0000'0001u);
+  ASSERT_EQ(items[1].key, 0x0000'0000'0000'0002u);
+  ASSERT_EQ(items[2].key, 0x0100'0000'0000'0000u);
+}
+
+TEST(RenderQueue, LowerSpritesDrawLaterInTheirLayer)
+{
+  const uint16_t above = render_queue::depth_from_y(-10.0f);
+  const uint16_t below = render_queue::depth_from_y(10.0f);
+  ASSERT_LT(render_queue::make_key(RenderLayer::Entities, above, 0, 0, BlendMode::Alpha),
+            render_queue::make_key(RenderLayer::Entities, below, 0, 0, BlendMode::Alpha));
+
+  // the layer still wins over depth
+  ASSERT_LT(render_queue::make_key(RenderLayer::Ground, below, 0, 0, BlendMode::Alpha),
+            render_queue::make_key(RenderLayer::Entities, above, 0, 0, BlendMode::Alpha));
+
+  ASSERT_EQ(render_queue::depth_from_y(-1.0e9f), 0);
+  ASSERT_EQ(render_queue::depth_from_y(1.0e9f), 65535);
+}
+
+TEST(RenderQueue, UnregisteredStateIsDroppedAtSubmit)
+{
+  render_queue::reset_stats();
+  render_queue::begin_frame();
+
+  GameObject2D go;
+  render_queue::submit(go, { 1.0f, 1.0f }, 200, 200);
+  ASSERT_EQ(render_queue::get_submitted(), 0);
+}
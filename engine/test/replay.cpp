@@ -0,0 +1,111 @@
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "2d_game.hpp"
+#include "2d_headless.hpp"
+#include "2d_replay.hpp"
+
+using namespace game2d;
+
+static uint64_t
+play_scripted(replay::Recording& recording, uint32_t ticks)
+{
+  GameState game;
+  replay::new_game(game, recording);
+  for (uint32_t i = 0; i < ticks; i++) {
+    for (KeysAndState& keys : game.player_keys)
+      headless::scripted_input(game.tick, keys);
+    replay::record(recording, game, 1.0f / 60.0f, false);
+    tick(game, 1.0f / 60.0f);
+  }
+  return headless::checksum(game);
+}
+
+static uint64_t
+play_replay(const replay::Recording& recording)
+{
+  GameState game;
+  replay::new_game(game, recording);
+  for (const replay::Tick& t : recording.ticks) {
+    replay::apply(game, t);
+    tick(game, t.delta_time_s, t.physics_while_paused);
+  }
+  return headless::checksum(game);
+}
+
+TEST(Replay, SameSeedSameGame)
+{
+  replay::Recording a;
+  a.seed = 7;
+  a.enemies = 50;
+  a.invulnerable = true;
+  replay::Recording b = a;
+  ASSERT_EQ(play_scripted(a, 1200), play_scripted(b, 1200));
+
+  replay::Recording c = a;
+  c.ticks.clear();
+  c.seed = 8;
+  ASSERT_NE(play_scripted(a, 1200), play_scripted(c, 1200));
+}
+
+TEST(Replay, PlaybackMatchesTheRecordedGame)
+{
+  replay::Recording recorded;
+  recorded.seed = 3;
+  recorded.enemies = 50;
+  recorded.invulnerable = true;
+  const uint64_t expected = play_scripted(recorded, 1200);
+
+  const std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test.replay").string();
+  ASSERT_TRUE(replay::save(path, recorded));
+  replay::Recording loaded;
+  ASSERT_TRUE(replay::load(path, loaded));
+  std::filesystem::remove(path);
+
+  ASSERT_EQ(loaded.seed, recorded.seed);
+  ASSERT_EQ(loaded.enemies, recorded.enemies);
+  ASSERT_TRUE(loaded.invulnerable);
+  ASSERT_EQ(loaded.ticks.size(), recorded.ticks.size());
+  for (size_t i = 0; i < loaded.ticks.size(); i++) {
+    const replay::Tick& l = loaded.ticks[i];
+    const replay::Tick& r = recorded.ticks[i];
+    ASSERT_EQ(l.delta_time_s, r.delta_time_s);
+    ASSERT_EQ(l.keys[0].angle_around_player, r.keys[0].angle_around_player);
+    ASSERT_EQ(l.keys[0].l_analogue_x, r.keys[0].l_analogue_x);
+    ASSERT_EQ(l.keys[0].shoot_pressed, r.keys[0].shoot_pressed);
+    ASSERT_EQ(l.keys[0].shoot_down, r.keys[0].shoot_down);
+    ASSERT_EQ(l.keys[0].weapon_next_pressed, r.keys[0].weapon_next_pressed);
+  }
+
+  ASSERT_EQ(play_replay(loaded), expected);
+}
+
+TEST(Replay, CorruptHeadersFailInsteadOfAllocating)
+{
+  replay::Header header;
+  std::memcpy(header.magic, replay::magic, sizeof(replay::magic));
+  header.version = replay::version;
+  header.players = 1;
+  header.tick_count = 0xFFFFFFFF; // a truncated file with a header that says otherwise
+
+  const std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test_corrupt.replay").string();
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  replay::Recording loaded;
+  ASSERT_FALSE(replay::load(path, loaded));
+
+  header.tick_count = 1;
+  header.players = 0xFFFFFFFF;
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  ASSERT_FALSE(replay::load(path, loaded));
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,50 @@
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "engine/opengl/shader.hpp"
+#include "engine/opengl/shader_cache.hpp"
+
+using namespace fightingengine;
+
+TEST(ShaderCache, KeyChangesWithSourceDefinesAndDriver)
+{
+  uint64_t key = shader_cache::make_key("vert", "frag", {}, "driver");
+  ASSERT_EQ(key, shader_cache::make_key("vert", "frag", {}, "driver"));
+  ASSERT_NE(key, shader_cache::make_key("vert", "frag2", {}, "driver"));
+  ASSERT_NE(key, shader_cache::make_key("vert", "frag", { "LIGHTS 4" }, "driver"));
+  ASSERT_NE(key, shader_cache::make_key("vert", "frag", {}, "driver 2"));
+  ASSERT_NE(key, shader_cache::make_key("ver", "tfrag", {}, "driver"));
+}
+
+TEST(ShaderCache, SavesAndLoadsBlobs)
+{
+  std::string directory = (std::filesystem::temp_directory_path() / "fightingengine_shader_cache_test").string();
+  std::filesystem::remove_all(directory);
+  shader_cache::set_directory(directory);
+
+  shader_cache::ProgramBinary binary;
+  binary.key = 42;
+  binary.format = 7;
+  binary.data = { 'a', 'b', 'c' };
+  shader_cache::save(binary);
+
+  shader_cache::ProgramBinary loaded;
+  ASSERT_TRUE(shader_cache::load(42, loaded));
+  ASSERT_EQ(loaded.format, 7);
+  ASSERT_EQ(loaded.data, binary.data);
+  ASSERT_FALSE(shader_cache::load(43, loaded));
+
+  shader_cache::set_directory("");
+  ASSERT_FALSE(shader_cache::load(42, loaded));
+
+  std::filesystem::remove_all(directory);
+  shader_cache::set_directory("shader_cache/");
+}
+
+TEST(ShaderCache, DefinesGoAfterVersion)
+{
+  std::string code = apply_shader_defines("#version 330 core\nvoid main(){}\n", { "LIGHTS 4" });
+  ASSERT_EQ(code, "#version 330 core\n#define LIGHTS 4\nvoid main(){}\n");
+}
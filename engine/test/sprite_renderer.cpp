@@ -0,0 +1,122 @@
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "engine/opengl/recording_backend.hpp"
+#include "engine/opengl/render_backend.hpp"
+#include "opengl/sprite_renderer.hpp"
+
+using namespace fightingengine;
+using namespace game2d;
+
+static int
+count_commands(const RecordingRenderBackend& recording, RecordedCommandType type)
+{
+  int count = 0;
+  for (const RecordedCommand& command : recording.commands) {
+    if (command.type == type)
+      count += 1;
+  }
+  return count;
+}
+
+TEST(SpriteRenderer, BatchesSpritesIntoOneDraw)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+  sprite_renderer::init();
+  {
+    Shader shader(recording.create_program("", ""));
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    const int sprites = 100;
+    std::vector<GameObject2D> objs(sprites + 1);
+    for (int i = 0; i < sprites; i++)
+      objs[i].pos = { 10.0f * i, 10.0f };
+    objs[sprites].pos = { 9000.0f, 10.0f }; // off screen, skipped
+
+    recording.reset();
+    sprite_renderer::reset_stats();
+    sprite_renderer::begin_batch();
+    for (const GameObject2D& go : objs)
+      sprite_renderer::draw_instanced_sprite(camera, screen, shader, go, { 16.0f, 16.0f });
+    sprite_renderer::end_batch();
+    sprite_renderer::flush(shader);
+
+    ASSERT_EQ(recording.stats.draw_calls, 1);
+    ASSERT_EQ(recording.stats.indices_drawn, sprites * 6);
+    ASSERT_EQ(recording.stats.bytes_uploaded, sprites * 4 * sizeof(sprite_renderer::Vertex));
+    ASSERT_EQ(sprite_renderer::get_draw_calls(), 1);
+    ASSERT_EQ(sprite_renderer::get_quad_count(), sprites * 4);
+  }
+  sprite_renderer::shutdown();
+  set_render_backend(nullptr);
+}
+
+TEST(SpriteRenderer, FullBatchesFlushOnTheirOwn)
+{
+  RecordingRenderBackend recording;
+  recording.record_commands = false;
+  set_render_backend(&recording);
+  sprite_renderer::init();
+  {
+    Shader shader(recording.create_program("", ""));
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    const size_t sprites = sprite_renderer::max_quad + 10;
+    GameObject2D go;
+    go.pos = { 10.0f, 10.0f };
+
+    recording.reset();
+    sprite_renderer::begin_batch();
+    for (size_t i = 0; i < sprites; i++)
+      sprite_renderer::draw_instanced_sprite(camera, screen, shader, go, { 16.0f, 16.0f });
+    sprite_renderer::end_batch();
+    sprite_renderer::flush(shader);
+
+    ASSERT_EQ(recording.stats.draw_calls, 2);
+    ASSERT_EQ(recording.stats.indices_drawn, sprites * 6);
+    ASSERT_EQ(recording.stats.bytes_uploaded, sprites * 4 * sizeof(sprite_renderer::Vertex));
+  }
+  sprite_renderer::shutdown();
+  set_render_backend(nullptr);
+}
+
+TEST(SpriteRenderer, DebugLinesGoThroughTheBackend)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+  sprite_renderer::init();
+  {
+    Shader shader(recording.create_program("", ""));
+    Shader line_shader(recording.create_program("", ""));
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    const int sprites = 3;
+    GameObject2D go;
+    go.pos = { 10.0f, 10.0f };
+    go.physics_size = { 16.0f, 16.0f };
+
+    recording.reset();
+    sprite_renderer::begin_batch();
+    for (int i = 0; i < sprites; i++)
+      sprite_renderer::draw_sprite_debug(camera, screen, shader, go, { 16.0f, 16.0f }, line_shader, glm::vec4(1.0f));
+    sprite_renderer::end_batch();
+    sprite_renderer::flush(shader);
+
+    // a line loop per sprite, then the sprites in one batch
+    ASSERT_EQ(count_commands(recording, RecordedCommandType::DrawLineLoop), sprites);
+    ASSERT_EQ(count_commands(recording, RecordedCommandType::DrawIndexed), 1);
+    ASSERT_EQ(recording.stats.bytes_uploaded,
+              sprites * 4 * sizeof(glm::vec2) + sprites * 4 * sizeof(sprite_renderer::Vertex));
+  }
+  sprite_renderer::shutdown();
+  set_render_backend(nullptr);
+}
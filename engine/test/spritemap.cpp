@@ -0,0 +1,66 @@
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+#include "spritemap.hpp"
+
+using namespace game2d;
+
+TEST(Spritemap, AtlasRoundTrips)
+{
+  sprite::Atlas saved = sprite::make_kennynl_atlas();
+  saved.cells[sprite::index(sprite::type::ORC)].pivot_x = 0.25f;
+  sprite::SpriteCell extra;
+  extra.x = 5;
+  extra.y = 7;
+  saved.cells.push_back(extra);
+  saved.names.push_back("NOT_A_TYPE");
+
+  const std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test.atlas").string();
+  ASSERT_TRUE(sprite::save_atlas(path, saved));
+
+  sprite::Atlas loaded;
+  ASSERT_TRUE(sprite::load_atlas(path, loaded));
+  std::filesystem::remove(path);
+
+  ASSERT_EQ(loaded.sheet_size, saved.sheet_size);
+  ASSERT_EQ(loaded.cell_size, saved.cell_size);
+  ASSERT_EQ(loaded.cells.size(), saved.cells.size());
+  ASSERT_EQ(loaded.names, saved.names);
+  for (size_t i = 0; i < saved.cells.size(); i++) {
+    ASSERT_EQ(loaded.cells[i].x, saved.cells[i].x);
+    ASSERT_EQ(loaded.cells[i].y, saved.cells[i].y);
+    ASSERT_EQ(loaded.cells[i].pivot_x, saved.cells[i].pivot_x);
+    ASSERT_EQ(loaded.cells[i].pivot_y, saved.cells[i].pivot_y);
+    ASSERT_EQ(loaded.cells[i].rotation, saved.cells[i].rotation);
+  }
+  ASSERT_EQ(sprite::find_sprite(loaded, "NOT_A_TYPE"), static_cast<int>(sprite::type_count));
+}
+
+TEST(Spritemap, AtlasMissingATypeFailsToLoad)
+{
+  sprite::Atlas saved = sprite::make_kennynl_atlas();
+  const size_t missing = sprite::index(sprite::type::BOAT);
+  saved.cells.erase(saved.cells.begin() + missing);
+  saved.names.erase(saved.names.begin() + missing);
+
+  const std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test_missing.atlas").string();
+  ASSERT_TRUE(sprite::save_atlas(path, saved));
+
+  // the atlas is left untouched
+  sprite::Atlas loaded = sprite::make_kennynl_atlas();
+  ASSERT_FALSE(sprite::load_atlas(path, loaded));
+  std::filesystem::remove(path);
+  ASSERT_EQ(loaded.cells.size(), sprite::type_count);
+  ASSERT_EQ(loaded.cells[missing].x, sprite::kennynl_table[missing].x);
+  ASSERT_EQ(loaded.cells[missing].y, sprite::kennynl_table[missing].y);
+}
+
+TEST(Spritemap, AtlasMissingFileFailsToLoad)
+{
+  sprite::Atlas loaded;
+  ASSERT_FALSE(sprite::load_atlas("this/atlas/does/not/exist.atlas", loaded));
+  ASSERT_TRUE(loaded.cells.empty());
+}
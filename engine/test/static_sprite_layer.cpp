@@ -0,0 +1,187 @@
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "engine/opengl/recording_backend.hpp"
+#include "engine/opengl/render_backend.hpp"
+#include "opengl/sprite_renderer.hpp"
+#include "opengl/static_sprite_layer.hpp"
+
+using namespace fightingengine;
+using namespace game2d;
+
+static GameObject2D
+make_tree(const glm::vec2& pos)
+{
+  GameObject2D go;
+  go.pos = pos;
+  go.render_size = { 16.0f, 16.0f };
+  go.do_render_static = true;
+  go.sprite = sprite::type::TREE_1;
+  return go;
+}
+
+static int
+count_commands(const RecordingRenderBackend& recording, RecordedCommandType type)
+{
+  int count = 0;
+  for (const RecordedCommand& command : recording.commands) {
+    if (command.type == type)
+      count += 1;
+  }
+  return count;
+}
+
+TEST(StaticSpriteLayer, BakesOnceAndRebuildsOnlyWhenDirty)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+  {
+    Shader shader(recording.create_program("", ""));
+    TextureArray tex;
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    static_sprite_layer::StaticLayer layer;
+    std::vector<GameObject2D> trees;
+    trees.push_back(make_tree({ 10.0f, 10.0f }));
+    trees.push_back(make_tree({ 20.0f, 10.0f }));
+    trees.push_back(make_tree({ 600.0f, 10.0f })); // the next chunk over
+    trees.push_back(make_tree({ 9000.0f, 10.0f })); // off screen
+    static_sprite_layer::sync(layer, trees);
+    ASSERT_EQ(layer.chunks.size(), 3);
+
+    // the first draw bakes only the chunks on screen, a draw call each
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(layer.chunks_rebuilt, 2);
+    ASSERT_EQ(layer.chunks_drawn, 2);
+    ASSERT_EQ(recording.stats.draw_calls, 2);
+    ASSERT_EQ(recording.stats.indices_drawn, 3 * 6);
+    ASSERT_EQ(recording.stats.bytes_uploaded, 3 * 4 * sizeof(sprite_renderer::Vertex));
+
+    // syncing the same objects again changes nothing, so nothing is uploaded
+    static_sprite_layer::sync(layer, trees);
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(layer.chunks_rebuilt, 0);
+    ASSERT_EQ(recording.stats.draw_calls, 2);
+    ASSERT_EQ(recording.stats.bytes_uploaded, 0);
+
+    // a new sprite only rebuilds its own chunk
+    trees.push_back(make_tree({ 30.0f, 10.0f }));
+    static_sprite_layer::sync(layer, trees);
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(layer.chunks_rebuilt, 1);
+    ASSERT_EQ(recording.stats.draw_calls, 2);
+    ASSERT_EQ(recording.stats.bytes_uploaded, 3 * 4 * sizeof(sprite_renderer::Vertex));
+
+    static_sprite_layer::shutdown(layer);
+  }
+  set_render_backend(nullptr);
+}
+
+TEST(StaticSpriteLayer, EmptyChunksAreFreed)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+  {
+    Shader shader(recording.create_program("", ""));
+    TextureArray tex;
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    static_sprite_layer::StaticLayer layer;
+    std::vector<GameObject2D> splats;
+    splats.push_back(make_tree({ 10.0f, 10.0f }));
+    splats.push_back(make_tree({ 600.0f, 10.0f }));
+    static_sprite_layer::sync(layer, splats);
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+
+    // the splat in the second chunk expires
+    splats[1].flag_for_delete = true;
+    recording.reset();
+    static_sprite_layer::sync(layer, splats);
+    ASSERT_EQ(layer.chunks.size(), 1);
+    ASSERT_EQ(count_commands(recording, RecordedCommandType::DeleteVertexArray), 1);
+    ASSERT_EQ(count_commands(recording, RecordedCommandType::DeleteBuffer), 1);
+    ASSERT_FALSE(static_sprite_layer::contains(layer, splats[1].id));
+
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(recording.stats.draw_calls, 1);
+
+    static_sprite_layer::shutdown(layer);
+  }
+  set_render_backend(nullptr);
+}
+
+TEST(StaticSpriteLayer, BoundsShrinkOnRebuild)
+{
+  RecordingRenderBackend recording;
+  set_render_backend(&recording);
+  {
+    Shader shader(recording.create_program("", ""));
+    TextureArray tex;
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    // the chunk's second sprite hangs far out of it
+    static_sprite_layer::StaticLayer layer;
+    std::vector<GameObject2D> objs;
+    objs.push_back(make_tree({ 10.0f, 10.0f }));
+    objs.push_back(make_tree({ 500.0f, 10.0f }));
+    objs[1].render_size = { 2000.0f, 16.0f };
+    static_sprite_layer::sync(layer, objs);
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+
+    objs[1].flag_for_delete = true;
+    static_sprite_layer::sync(layer, objs);
+    camera.pos = { 1000.0f, 0.0f };
+    static_sprite_layer::draw(layer, camera, screen, shader, tex); // still overlaps, so it's rebuilt
+    ASSERT_EQ(layer.chunks_rebuilt, 1);
+
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(layer.chunks_drawn, 0);
+    ASSERT_EQ(recording.stats.draw_calls, 0);
+
+    static_sprite_layer::shutdown(layer);
+  }
+  set_render_backend(nullptr);
+}
+
+TEST(StaticSpriteLayer, BigChunksAreSplitNotTruncated)
+{
+  RecordingRenderBackend recording;
+  recording.record_commands = false;
+  set_render_backend(&recording);
+  {
+    Shader shader(recording.create_program("", ""));
+    TextureArray tex;
+    GameObject2D camera;
+    camera.pos = { 0.0f, 0.0f };
+    const glm::ivec2 screen = { 1280, 720 };
+
+    static_sprite_layer::StaticLayer layer;
+    const size_t count = sprite_renderer::max_quad + 10;
+    std::vector<GameObject2D> splats;
+    for (size_t i = 0; i < count; i++)
+      splats.push_back(make_tree({ 10.0f, 10.0f }));
+    static_sprite_layer::sync(layer, splats);
+
+    recording.reset();
+    static_sprite_layer::draw(layer, camera, screen, shader, tex);
+    ASSERT_EQ(layer.chunks_drawn, 1);
+    ASSERT_EQ(recording.stats.draw_calls, 2);
+    ASSERT_EQ(recording.stats.indices_drawn, count * 6);
+
+    static_sprite_layer::shutdown(layer);
+  }
+  set_render_backend(nullptr);
+}
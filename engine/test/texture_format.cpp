@@ -0,0 +1,96 @@
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "engine/mapped_file.hpp"
+#include "engine/texture_format.hpp"
+
+using namespace fightingengine;
+
+TEST(TextureFormat, MipsFilterEveryTexel)
+{
+  // 5x3, odd in both directions. left half black, right half white, opaque
+  texture_format::Image base;
+  base.width = 5;
+  base.height = 3;
+  for (uint32_t y = 0; y < base.height; y++) {
+    for (uint32_t x = 0; x < base.width; x++) {
+      const uint8_t value = x % 2 == 0 ? 0 : 255;
+      base.rgba.insert(base.rgba.end(), { value, value, value, 255 });
+    }
+  }
+
+  std::vector<texture_format::Image> linear = texture_format::generate_mips(base, false);
+  ASSERT_EQ(linear.size(), texture_format::get_level_count(5, 3));
+  ASSERT_EQ(linear.size(), 3);
+  ASSERT_EQ(linear[1].width, 2);
+  ASSERT_EQ(linear[1].height, 1);
+  ASSERT_EQ(linear[2].width, 1);
+  ASSERT_EQ(linear[2].height, 1);
+
+  // the first texel covers columns 0-1, the second folds in the odd column 4: 0, 255, 0
+  ASSERT_EQ(linear[1].rgba[0], 128);
+  ASSERT_EQ(linear[1].rgba[4], 85);
+  ASSERT_EQ(linear[1].rgba[3], 255);
+
+  // half black, half white is middle grey in linear light, which is brighter in srgb
+  std::vector<texture_format::Image> srgb = texture_format::generate_mips(base, true);
+  ASSERT_EQ(srgb[1].rgba[0], 188);
+}
+
+TEST(TextureFormat, TransparentTexelsDontBleed)
+{
+  // opaque red next to transparent black
+  texture_format::Image base;
+  base.width = 2;
+  base.height = 1;
+  base.rgba = { 255, 0, 0, 255, 0, 0, 0, 0 };
+
+  std::vector<texture_format::Image> mips = texture_format::generate_mips(base, true);
+  ASSERT_EQ(mips.size(), 2);
+  ASSERT_EQ(mips[1].rgba[0], 255);
+  ASSERT_EQ(mips[1].rgba[1], 0);
+  ASSERT_EQ(mips[1].rgba[3], 128);
+}
+
+TEST(TextureFormat, WritesAndMapsTextures)
+{
+  ASSERT_EQ(texture_format::get_level_size(texture_format::Format::BC1, 5, 3), 16);
+  ASSERT_EQ(texture_format::get_level_size(texture_format::Format::BC3, 1, 1), 16);
+  ASSERT_EQ(texture_format::get_level_size(texture_format::Format::RGBA8, 5, 3), 60);
+
+  texture_format::TextureData texture;
+  texture.format = texture_format::Format::BC1;
+  texture.width = 8;
+  texture.height = 4;
+  texture.levels.push_back(std::vector<uint8_t>(16, 1));
+  texture.levels.push_back(std::vector<uint8_t>(8, 2));
+  texture.levels.push_back(std::vector<uint8_t>(8, 3));
+
+  std::string path = (std::filesystem::temp_directory_path() / "fightingengine_test.tex").string();
+  ASSERT_TRUE(texture_format::write(path, texture));
+
+  MappedFile file;
+  ASSERT_TRUE(map_file(path, file));
+
+  texture_format::TextureView view;
+  ASSERT_TRUE(texture_format::parse(file.data, file.size, view));
+  ASSERT_EQ(view.header->format, texture_format::Format::BC1);
+  ASSERT_EQ(view.header->level_count, 3);
+  ASSERT_EQ(view.levels[1].width, 4);
+  ASSERT_EQ(view.levels[1].height, 2);
+  ASSERT_EQ(view.levels[2].size, 8);
+  ASSERT_EQ(view.levels[2].offset % 16, 0);
+  ASSERT_EQ(view.data[view.levels[2].offset], 3);
+
+  // a truncated file is rejected, not read past the end
+  ASSERT_FALSE(texture_format::parse(file.data, file.size - 4, view));
+
+  unmap_file(file);
+  std::filesystem::remove(path);
+
+  // levels that don't match their size aren't written
+  texture.levels[1].resize(4);
+  ASSERT_FALSE(texture_format::write(path, texture));
+}
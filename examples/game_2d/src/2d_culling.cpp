@@ -0,0 +1,188 @@
+// your header
+#include "2d_culling.hpp"
+
+// engine headers
+#include "engine/grid.hpp"
+
+namespace game2d {
+
+namespace culling {
+
+uint64_t
+cell_key(const glm::ivec2& cell)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
+}
+
+// cull_cell and cull_slot are only trusted while the entry there is still this object's
+static bool
+in_grid(const CullGrid& grid, const GameObject2D& go)
+{
+  if (go.cull_cell < 0 || go.cull_cell >= grid.cells.size())
+    return false;
+  const CullCell& cell = grid.cells[go.cull_cell];
+  return go.cull_slot >= 0 && go.cull_slot < cell.entries.size() && cell.entries[go.cull_slot].id == go.id &&
+         cell.entries[go.cull_slot].obj != nullptr;
+}
+
+static void
+unlink(CullGrid& grid, GameObject2D& go)
+{
+  CullCell& cell = grid.cells[go.cull_cell];
+  cell.entries[go.cull_slot].obj = nullptr;
+  if (!cell.dirty) {
+    cell.dirty = true;
+    grid.dirty_cells.push_back(go.cull_cell);
+  }
+  go.cull_cell = -1;
+  go.cull_slot = -1;
+  grid.objects -= 1;
+}
+
+static void
+link(CullGrid& grid, GameObject2D& go, const glm::ivec2& tl)
+{
+  const uint64_t key = cell_key(tl);
+  auto it = grid.cell_index.find(key);
+  if (it == grid.cell_index.end()) {
+    int index = 0;
+    if (!grid.free_cells.empty()) {
+      index = grid.free_cells.back();
+      grid.free_cells.pop_back();
+    } else {
+      index = static_cast<int>(grid.cells.size());
+      grid.cells.emplace_back();
+    }
+    grid.cells[index].cell = tl;
+    it = grid.cell_index.emplace(key, index).first;
+  }
+
+  CullCell& cell = grid.cells[it->second];
+  CullEntry entry;
+  entry.id = go.id;
+  entry.obj = &go;
+  go.cull_cell = it->second;
+  go.cull_slot = static_cast<int>(cell.entries.size());
+  cell.entries.push_back(entry);
+  grid.objects += 1;
+
+  glm::ivec2 br = grid::convert_world_space_to_grid_space(go.pos + go.render_size, grid.grid_size);
+  grid.max_overhang_cells = glm::max(grid.max_overhang_cells, br - tl);
+}
+
+void
+remove(CullGrid& grid, GameObject2D& go)
+{
+  if (in_grid(grid, go))
+    unlink(grid, go);
+}
+
+void
+remove_flagged(CullGrid& grid, std::vector<GameObject2D>& objs)
+{
+  for (GameObject2D& go : objs) {
+    if (go.flag_for_delete)
+      remove(grid, go);
+  }
+}
+
+void
+sync(CullGrid& grid, GameObject2D& go)
+{
+  const bool linked = in_grid(grid, go);
+  if (!go.do_render || go.do_render_static) {
+    if (linked)
+      unlink(grid, go); // static sprites are culled per chunk by the static layer
+    return;
+  }
+
+  const glm::ivec2 tl = grid::convert_world_space_to_grid_space(go.pos, grid.grid_size);
+  if (!linked) {
+    link(grid, go, tl);
+    return;
+  }
+
+  CullCell& cell = grid.cells[go.cull_cell];
+  if (cell.cell == tl) {
+    cell.entries[go.cull_slot].obj = &go; // the vector may have moved
+    return;
+  }
+
+  unlink(grid, go);
+  link(grid, go, tl);
+}
+
+void
+sync(CullGrid& grid, std::vector<GameObject2D>& objs)
+{
+  for (GameObject2D& go : objs)
+    sync(grid, go);
+}
+
+void
+compact(CullGrid& grid)
+{
+  for (const int index : grid.dirty_cells) {
+    CullCell& cell = grid.cells[index];
+    cell.dirty = false;
+
+    // every live entry was synced, so its obj points at the object
+    size_t kept = 0;
+    for (size_t i = 0; i < cell.entries.size(); i++) {
+      if (cell.entries[i].obj == nullptr)
+        continue;
+      cell.entries[kept] = cell.entries[i];
+      cell.entries[kept].obj->cull_slot = static_cast<int>(kept);
+      kept += 1;
+    }
+    cell.entries.resize(kept);
+
+    if (kept == 0) {
+      grid.cell_index.erase(cell_key(cell.cell));
+      grid.free_cells.push_back(index);
+    }
+  }
+  grid.dirty_cells.clear();
+}
+
+void
+query_visible(CullGrid& grid,
+              const GameObject2D& camera,
+              const glm::ivec2& screen_size,
+              std::vector<std::reference_wrapper<GameObject2D>>& results)
+{
+  grid.cells_visited = 0;
+  grid.objects_tested = 0;
+  grid.objects_visible = 0;
+
+  // the camera rect in worldspace
+  glm::ivec2 tl = grid::convert_world_space_to_grid_space(camera.pos, grid.grid_size);
+  glm::ivec2 br = grid::convert_world_space_to_grid_space(camera.pos + glm::vec2(screen_size), grid.grid_size);
+  tl -= grid.max_overhang_cells;
+
+  for (int y = tl.y; y <= br.y; y++) {
+    for (int x = tl.x; x <= br.x; x++) {
+      grid.cells_visited += 1;
+
+      auto it = grid.cell_index.find(cell_key({ x, y }));
+      if (it == grid.cell_index.end())
+        continue;
+
+      for (const CullEntry& entry : grid.cells[it->second].entries) {
+        if (entry.obj == nullptr)
+          continue;
+        grid.objects_tested += 1;
+        const GameObject2D& go = *entry.obj;
+        glm::vec2 worldspace_pos = gameobject_in_worldspace(camera, go);
+        if (gameobject_off_screen(worldspace_pos, go.render_size, screen_size))
+          continue;
+        results.push_back(*entry.obj);
+        grid.objects_visible += 1;
+      }
+    }
+  }
+}
+
+} // namespace culling
+
+} // namespace game2d
@@ -0,0 +1,93 @@
+#pragma once
+
+// c++ lib headers
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// other lib headers
+#include <glm/glm.hpp>
+
+// game headers
+#include "2d_game_object.hpp"
+
+namespace game2d {
+
+namespace culling {
+
+// spatial index over renderables, used to find what the camera can see.
+// each object is stored once, in the cell its top-left corner is in.
+// objects can overhang in to the cells right and below,
+// so queries are grown up and left by the largest overhang seen.
+//
+// the grid is kept between ticks. objects are added the first tick they're synced,
+// only moved when they change cell, and removed before they're erased,
+// so a frame only pays for the cells the camera overlaps.
+// each object keeps its cell and slot (cull_cell, cull_slot) so nothing is looked up by id.
+
+struct CullEntry
+{
+  uint32_t id = 0;
+  GameObject2D* obj = nullptr; // nullptr once removed, until the cell is compacted
+};
+
+struct CullCell
+{
+  glm::ivec2 cell = { 0, 0 };
+  std::vector<CullEntry> entries;
+  bool dirty = false; // has removed entries
+};
+
+struct CullGrid
+{
+  int grid_size = 200;
+
+  // cells are reused from free_cells, so their vectors keep their capacity
+  std::vector<CullCell> cells;
+  std::vector<int> free_cells;
+  std::vector<int> dirty_cells;
+  std::unordered_map<uint64_t, int> cell_index;
+  glm::ivec2 max_overhang_cells = { 0, 0 };
+
+  // stats
+  int objects = 0;
+  int cells_visited = 0;
+  int objects_tested = 0;
+  int objects_visible = 0;
+};
+
+[[nodiscard]] uint64_t
+cell_key(const glm::ivec2& cell);
+
+// removes the object, call before it's erased
+void
+remove(CullGrid& grid, GameObject2D& go);
+
+// removes every object flagged for delete, call before they're erased
+void
+remove_flagged(CullGrid& grid, std::vector<GameObject2D>& objs);
+
+// adds new objects, moves ones that changed cell and removes ones that stopped rendering.
+// !do_render and do_render_static objects are skipped.
+// every object in the grid has to be synced after its vector changes (push_back, erase, sort),
+// as the grid points in to the vectors. call compact() after syncing everything.
+void
+sync(CullGrid& grid, GameObject2D& go);
+void
+sync(CullGrid& grid, std::vector<GameObject2D>& objs);
+
+// drops removed entries and frees empty cells
+void
+compact(CullGrid& grid);
+
+// visible objects are appended to results, in cell order
+void
+query_visible(CullGrid& grid,
+              const GameObject2D& camera,
+              const glm::ivec2& screen_size,
+              std::vector<std::reference_wrapper<GameObject2D>>& results);
+
+} // namespace culling
+
+} // namespace game2d
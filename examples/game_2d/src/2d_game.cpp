@@ -0,0 +1,479 @@
+// header
+#include "2d_game.hpp"
+
+// c++ lib headers
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+// other lib headers
+#include "thirdparty/magic_enum.hpp"
+#include <glm/gtx/norm.hpp>
+
+// engine headers
+#include "engine/grid.hpp"
+#include "engine/tools/profiler.hpp"
+
+// game headers
+#include "2d_game_logic.hpp"
+#include "2d_vfx.hpp"
+
+namespace game2d {
+
+using namespace fightingengine;
+
+void
+init(GameState& game, glm::ivec2 screen_wh, uint32_t seed)
+{
+  GameObject2D::reset_ids();
+  Attack::reset_ids();
+
+  game = GameState();
+  game.seed = seed;
+  game.screen_wh = screen_wh;
+  game.rnd.rng.seed(seed);
+
+  game.camera = gameobject::create_camera();
+  game.weapon_base.sprite = sprite_weapon_base;
+  game.weapon_base.pos = { screen_wh.x / 2.0f, screen_wh.y / 2.0f };
+  game.weapon_base.render_size = { 1.0f * 768.0f / 48.0f, 1.0f * 362.0f / 22.0f };
+  game.weapon_base.physics_size = { 1.0f * 768.0f / 48.0f, 1.0f * 362.0f / 22.0f };
+  game.weapon_base.collision_layer = CollisionLayer::Weapon;
+  game.weapon_base.colour = bullet_colour;
+
+  // add players
+  {
+    GameObject2D player0 = gameobject::create_player(sprite_player, tex_slot_kenny_nl, player_colour, screen_wh);
+
+    KeysAndState player0_keys;
+    player0_keys.use_keyboard = true;
+
+    game.entities_player.push_back(player0);
+    game.player_keys.push_back(player0_keys);
+  }
+
+  game.metrics.players = metrics::register_gauge("players");
+  game.metrics.enemies = metrics::register_gauge("enemies");
+  game.metrics.bullets = metrics::register_gauge("bullets");
+  game.metrics.vfx = metrics::register_gauge("vfx");
+  game.metrics.live_attacks = metrics::register_gauge("live attacks");
+  game.metrics.collision_pairs = metrics::register_counter("collision pairs");
+  game.metrics.attacks_landed = metrics::register_counter("attacks landed");
+}
+
+void
+update_physics(GameState& game)
+{
+  PROFILE_FUNCTION();
+
+  std::vector<std::reference_wrapper<GameObject2D>> collidable;
+  collidable.insert(collidable.end(), game.entities_enemies.begin(), game.entities_enemies.end());
+  collidable.insert(collidable.end(), game.entities_bullets.begin(), game.entities_bullets.end());
+  collidable.insert(collidable.end(), game.entities_player.begin(), game.entities_player.end());
+  collidable.insert(collidable.end(), game.entities_trees.begin(), game.entities_trees.end());
+  collidable.push_back(game.weapon_base);
+
+  std::vector<std::reference_wrapper<GameObject2D>> active_collidable;
+  for (auto& obj : collidable) {
+    if (obj.get().do_physics)
+      active_collidable.push_back(obj);
+  }
+
+  // pre-physics: update grid position
+  for (auto& e : active_collidable) {
+    grid::get_unique_cells(e.get().pos, e.get().physics_size, PHYSICS_GRID_SIZE, e.get().in_physics_grid_cell);
+  }
+
+  // generate filtered broadphase collisions.
+  std::map<uint64_t, Collision2D> filtered_collisions;
+  generate_filtered_broadphase_collisions(active_collidable, filtered_collisions);
+  metrics::add(game.metrics.collision_pairs, static_cast<double>(filtered_collisions.size()));
+
+  // clear collision events this frame
+  game.collision_events.clear();
+
+  // Add collision to events
+  for (auto& c : filtered_collisions) {
+    uint32_t id_0 = c.second.ent_id_0;
+    uint32_t id_1 = c.second.ent_id_1;
+
+    // Find the objs in the read-only list
+    const auto obj_0_it =
+      std::find_if(collidable.begin(), collidable.end(), [&id_0](const auto& obj) { return obj.get().id == id_0; });
+    const auto obj_1_it =
+      std::find_if(collidable.begin(), collidable.end(), [&id_1](const auto& obj) { return obj.get().id == id_1; });
+
+    if (obj_0_it == collidable.end() || obj_1_it == collidable.end()) {
+      std::cerr << "Collision entity not in entity list" << std::endl;
+      continue;
+    }
+
+    CollisionEvent eve(obj_0_it->get(), obj_1_it->get());
+    game.collision_events.push_back(eve);
+  }
+}
+
+static void
+resolve_collisions(GameState& game)
+{
+  game.player_at_tree = false;
+
+  for (auto& event : game.collision_events) {
+
+    auto& coll_layer_0 = event.go0.collision_layer;
+    auto& coll_layer_1 = event.go1.collision_layer;
+
+    if ((coll_layer_0 == CollisionLayer::Player && coll_layer_1 == CollisionLayer::Enemy) ||
+        (coll_layer_1 == CollisionLayer::Player && coll_layer_0 == CollisionLayer::Enemy)) {
+
+      GameObject2D& enemy = event.go0.collision_layer == CollisionLayer::Enemy ? event.go0 : event.go1;
+      GameObject2D& player = event.go0.collision_layer == CollisionLayer::Enemy ? event.go1 : event.go0;
+
+      if (player.hits_taken >= player.hits_able_to_be_taken)
+        continue; // player is dead
+
+      enemy.flag_for_delete = true;                  // enemy
+      player.hits_taken += 1;                        // player
+      player.flash_time_left = vfx_flash_time;       // vfx: flash
+      game.screenshake_time_left = screenshake_time; // screenshake
+
+      // vfx spawn a splat
+      GameObject2D splat = gameobject::create_generic(sprite_splat, tex_slot_kenny_nl, player_splat_colour);
+      splat.pos = player.pos;
+      splat.angle_radians = fightingengine::rand_det_s(game.rnd.rng, 0.0f, fightingengine::PI);
+      splat.render_layer = RenderLayer::Ground;
+      splat.do_render_static = true;
+      game.entities_vfx.push_back(splat);
+    }
+
+    if ((coll_layer_0 == CollisionLayer::Enemy && coll_layer_1 == CollisionLayer::Weapon) ||
+        (coll_layer_1 == CollisionLayer::Enemy && coll_layer_0 == CollisionLayer::Weapon)) {
+
+      GameObject2D& enemy = event.go0.collision_layer == CollisionLayer::Enemy ? event.go0 : event.go1;
+      GameObject2D& weapon = event.go0.collision_layer == CollisionLayer::Enemy ? event.go1 : event.go0;
+      GameObject2D& player = game.entities_player[0]; // hack: use player 0 for the moment
+
+      for (auto& attack : game.live_attacks) {
+
+        bool is_shovel = attack.weapon_type == Weapons::SHOVEL;
+        bool collision_with_specific_shovel_attack = weapon.id == attack.entity_weapon_id;
+        bool taken_damage_from_shovel = std::find(enemy.attack_ids_taken_damage_from.begin(),
+                                                  enemy.attack_ids_taken_damage_from.end(),
+                                                  attack.id) != enemy.attack_ids_taken_damage_from.end();
+
+        if (is_shovel && collision_with_specific_shovel_attack && !taken_damage_from_shovel) {
+          // std::cout << "enemy taking damage from weapon attack ONCE!" << std::endl;
+          metrics::add(game.metrics.attacks_landed);
+          enemy.hits_taken += 1;
+          enemy.attack_ids_taken_damage_from.push_back(attack.id);
+          enemy.flash_time_left = vfx_flash_time; // vfx: flash
+
+          // vfx dealthsplat
+          if (enemy.hits_taken >= enemy.hits_able_to_be_taken) {
+            vfx::spawn_death_splat(
+              game.rnd, enemy, sprite_splat, tex_slot_kenny_nl, enemy_death_splat_colour, game.entities_vfx);
+          }
+
+          // vfx impactsplat
+          vfx::spawn_impact_splats(
+            game.rnd, enemy, player, sprite_splat, tex_slot_kenny_nl, enemy_impact_splat_colour, game.entities_vfx);
+        }
+      }
+    }
+
+    if ((coll_layer_0 == CollisionLayer::Bullet && coll_layer_1 == CollisionLayer::Enemy) ||
+        (coll_layer_1 == CollisionLayer::Bullet && coll_layer_0 == CollisionLayer::Enemy)) {
+      GameObject2D& bullet = event.go0.collision_layer == CollisionLayer::Bullet ? event.go0 : event.go1;
+      GameObject2D& enemy = event.go0.collision_layer == CollisionLayer::Bullet ? event.go1 : event.go0;
+      GameObject2D& player = game.entities_player[0]; // hack: use player 0 for the moment
+
+      for (auto& attack : game.live_attacks) {
+
+        bool is_bullet = attack.weapon_type == Weapons::PISTOL;
+        bool collision_with_specific_bullet = bullet.id == attack.entity_weapon_id;
+        bool taken_damage_from_bullet = std::find(enemy.attack_ids_taken_damage_from.begin(),
+                                                  enemy.attack_ids_taken_damage_from.end(),
+                                                  attack.id) != enemy.attack_ids_taken_damage_from.end();
+
+        if (is_bullet && collision_with_specific_bullet && !taken_damage_from_bullet) {
+          // std::cout << "enemy taking damage from bullet attack ONCE!" << std::endl;
+          metrics::add(game.metrics.attacks_landed);
+          enemy.hits_taken += 1;
+          enemy.attack_ids_taken_damage_from.push_back(attack.id);
+          enemy.flash_time_left = vfx_flash_time; // vfx: flash
+
+          // vfx dealthsplat
+          if (enemy.hits_taken >= enemy.hits_able_to_be_taken) {
+            vfx::spawn_death_splat(
+              game.rnd, enemy, sprite_splat, tex_slot_kenny_nl, enemy_death_splat_colour, game.entities_vfx);
+          }
+
+          // vfx impactsplat
+          vfx::spawn_impact_splats(
+            game.rnd, enemy, player, sprite_splat, tex_slot_kenny_nl, enemy_impact_splat_colour, game.entities_vfx);
+        }
+      }
+    }
+
+    if ((coll_layer_0 == CollisionLayer::Obstacle && coll_layer_1 == CollisionLayer::Player) ||
+        (coll_layer_1 == CollisionLayer::Obstacle && coll_layer_0 == CollisionLayer::Player)) {
+      game.player_at_tree = true;
+    }
+  }
+}
+
+void
+update_game(GameState& game, float delta_time_s)
+{
+  PROFILE_FUNCTION();
+
+  resolve_collisions(game);
+
+  for (const KeysAndState& keys : game.player_keys) {
+    if (keys.pause_pressed)
+      game.running = game.running == GameRunning::PAUSED ? GameRunning::ACTIVE : GameRunning::PAUSED;
+  }
+
+  if (game.running == GameRunning::ACTIVE) {
+
+    // update: players
+
+    for (int i = 0; i < game.entities_player.size(); i++) {
+      GameObject2D& player = game.entities_player[i];
+      KeysAndState& keys = game.player_keys[i];
+
+      // cycle through the weapons
+      if (keys.weapon_next_pressed) {
+        if (player.equipped_weapon == Weapons::SHOVEL)
+          player.equipped_weapon = Weapons::PISTOL;
+        else if (player.equipped_weapon == Weapons::PISTOL)
+          player.equipped_weapon = Weapons::SHOVEL;
+
+        auto wep = std::string(magic_enum::enum_name(player.equipped_weapon));
+        std::cout << "equipped: " << wep << std::endl;
+      }
+
+      player::update(player,
+                     keys,
+                     game.entities_bullets,
+                     tex_slot_kenny_nl,
+                     bullet_colour,
+                     sprite_bullet,
+                     game.weapon_base,
+                     delta_time_s,
+                     game.live_attacks);
+
+      bool player_alive = player.invulnerable || player.hits_taken < player.hits_able_to_be_taken;
+      if (!player_alive)
+        game.running = GameRunning::GAME_OVER;
+    }
+
+    // update: bullets
+
+    for (auto& bullet : game.entities_bullets) {
+      bullet::update(bullet, delta_time_s);
+    }
+
+    // update: vfx
+
+    for (auto& obj : game.entities_vfx) {
+      gameobject::update_position(obj, delta_time_s);
+    }
+
+    // update: vfx flash
+
+    for (auto& obj : game.entities_player) {
+      if (obj.flash_time_left > 0.0f) {
+        obj.flash_time_left -= delta_time_s;
+        obj.colour = obj.flash_colour;
+      } else {
+        obj.colour = player_colour;
+      }
+    }
+    for (auto& obj : game.entities_enemies) {
+      if (obj.flash_time_left > 0.0f) {
+        obj.flash_time_left -= delta_time_s;
+        obj.colour = obj.flash_colour;
+      } else {
+        obj.colour = wall_colour;
+      }
+    }
+
+    // update: vfx screenshake
+
+    if (game.screenshake_time_left > 0.0f) {
+      game.screenshake_time_left -= delta_time_s;
+      game.shake = true;
+    }
+    if (game.screenshake_time_left <= 0.0f) {
+      game.shake = false;
+    }
+
+    // update: spawn enemies
+
+    size_t players_in_game = game.entities_player.size();
+    if (players_in_game > 0) {
+
+      // for the moment, eat player 0
+      GameObject2D player_to_chase = game.entities_player[0];
+
+      // update with ai behaviour
+      for (auto& obj : game.entities_enemies) {
+
+        // check every frame: close to player?
+        float distance_squared = glm::distance2(obj.pos, player_to_chase.pos);
+        if (distance_squared < game_enemy_direct_attack_threshold) {
+          // push new ai behaviour
+          if (obj.ai_priority_list.size() > 0 && obj.ai_priority_list.back() != AiBehaviour::MOVEMENT_DIRECT) {
+            obj.ai_priority_list.push_back(AiBehaviour::MOVEMENT_DIRECT);
+          }
+        } else {
+          // far away! check if our original ai was move direct or arc angle. pop arc angle if it was pushed.
+          if (obj.ai_priority_list.size() > 1 && obj.ai_priority_list.back() == AiBehaviour::MOVEMENT_DIRECT) {
+            obj.ai_priority_list.pop_back();
+          }
+        }
+
+        // update: ai behaviour (note, currently runs every frame probably bad)
+        if (obj.ai_priority_list.size() > 0 && obj.ai_priority_list.back() == AiBehaviour::MOVEMENT_DIRECT) {
+          enemy_ai::enemy_directly_to_player(obj, player_to_chase, delta_time_s);
+        } else if (obj.ai_priority_list.size() > 0 && obj.ai_priority_list.back() == AiBehaviour::MOVEMENT_ARC_ANGLE) {
+          enemy_ai::enemy_arc_angles_to_player(obj, player_to_chase, delta_time_s);
+        }
+      }
+
+      //... and only spawn enemies if there is a player.
+      enemy_spawner::update(game.spawner,
+                            game.entities_enemies,
+                            game.camera,
+                            game.entities_player,
+                            game.rnd,
+                            game.screen_wh,
+                            game_safe_radius_around_player,
+                            tex_slot_kenny_nl,
+                            wall_colour,
+                            sprite_enemy_core,
+                            delta_time_s);
+
+      // update camera pos
+      camera::update(game.camera, game.player_keys[0], delta_time_s);
+    }
+
+    { // object lifecycle
+
+      gameobject::update_entities_lifecycle(game.entities_enemies, delta_time_s);
+      gameobject::update_entities_lifecycle(game.entities_bullets, delta_time_s);
+      gameobject::update_entities_lifecycle(game.entities_vfx, delta_time_s);
+
+      // remove "attack" object before deleting "bullet" object (or any object that is cleaned up)
+      // e.g when deleting "player" (in the future)
+      std::vector<Attack>::iterator it = game.live_attacks.begin();
+      while (it != game.live_attacks.end()) {
+        const Attack& attack = (*it);
+        int id = attack.entity_weapon_id;
+
+        if (attack.weapon_type == Weapons::PISTOL) {
+          const auto& bullet = std::find_if(game.entities_bullets.begin(),
+                                            game.entities_bullets.end(),
+                                            [&id](const auto& obj) { return obj.id == id; });
+
+          if (bullet != game.entities_bullets.end() && bullet->flag_for_delete) {
+            // remove the attack object
+            it = game.live_attacks.erase(it);
+            continue;
+          }
+        }
+        ++it;
+      }
+    }
+  }
+
+  game.tick += 1;
+}
+
+void
+erase_flagged(GameState& game)
+{
+  if (game.running == GameRunning::ACTIVE) {
+    culling::remove_flagged(game.cull_grid, game.entities_enemies);
+    culling::remove_flagged(game.cull_grid, game.entities_bullets);
+    culling::remove_flagged(game.cull_grid, game.entities_vfx);
+
+    // the delta time isn't used
+    gameobject::erase_entities_that_are_flagged_for_delete(game.entities_enemies, 0.0f);
+    gameobject::erase_entities_that_are_flagged_for_delete(game.entities_bullets, 0.0f);
+    gameobject::erase_entities_that_are_flagged_for_delete(game.entities_vfx, 0.0f);
+
+    if (game.morton_sort_interval > 0 && game.tick % game.morton_sort_interval == 0) {
+      sort_by_morton(game.entities_enemies, PHYSICS_GRID_SIZE);
+      sort_by_morton(game.entities_bullets, PHYSICS_GRID_SIZE);
+      sort_by_morton(game.entities_vfx, PHYSICS_GRID_SIZE);
+    }
+
+    // the events point in to the entity lists
+    game.collision_events.clear();
+  }
+
+  // the lists may have grown, shrunk or been sorted since the last sync
+  culling::sync(game.cull_grid, game.entities_enemies);
+  culling::sync(game.cull_grid, game.entities_bullets);
+  culling::sync(game.cull_grid, game.entities_vfx);
+  culling::sync(game.cull_grid, game.entities_player);
+  culling::sync(game.cull_grid, game.entities_trees);
+  culling::sync(game.cull_grid, game.weapon_base);
+  culling::compact(game.cull_grid);
+
+  metrics::set(game.metrics.players, static_cast<double>(game.entities_player.size()));
+  metrics::set(game.metrics.enemies, static_cast<double>(game.entities_enemies.size()));
+  metrics::set(game.metrics.bullets, static_cast<double>(game.entities_bullets.size()));
+  metrics::set(game.metrics.vfx, static_cast<double>(game.entities_vfx.size()));
+  metrics::set(game.metrics.live_attacks, static_cast<double>(game.live_attacks.size()));
+}
+
+void
+sort_by_morton(std::vector<GameObject2D>& objs, int grid_size)
+{
+  PROFILE_FUNCTION();
+
+  // the index breaks ties, so it's a stable sort
+  std::vector<std::pair<uint64_t, uint32_t>> keys(objs.size());
+  for (uint32_t i = 0; i < objs.size(); i++) {
+    const glm::ivec2 cell = glm::ivec2(glm::floor(objs[i].pos / static_cast<float>(grid_size)));
+    keys[i] = { morton_encode_2d(cell), i };
+  }
+  if (std::is_sorted(keys.begin(), keys.end()))
+    return;
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<GameObject2D> sorted;
+  sorted.reserve(objs.size());
+  for (const auto& key : keys)
+    sorted.push_back(std::move(objs[key.second]));
+  objs.swap(sorted);
+}
+
+void
+spawn_enemies_around_player(GameState& game, uint32_t count)
+{
+  const glm::vec2 centre = game.entities_player[0].pos;
+  for (uint32_t i = 0; i < count; i++) {
+    GameObject2D enemy = gameobject::create_enemy(sprite_enemy_core, tex_slot_kenny_nl, wall_colour, game.rnd);
+    const float angle = rand_det_s(game.rnd.rng, 0.0f, 2.0f * PI);
+    const float distance = rand_det_s(game.rnd.rng, 200.0f, 1000.0f);
+    enemy.pos = centre + distance * glm::vec2(glm::cos(angle), glm::sin(angle));
+    game.entities_enemies.push_back(enemy);
+  }
+}
+
+void
+tick(GameState& game, float delta_time_s, bool physics_while_paused)
+{
+  if (game.running == GameRunning::ACTIVE || (game.running == GameRunning::PAUSED && physics_while_paused))
+    update_physics(game);
+  update_game(game, delta_time_s);
+  erase_flagged(game);
+}
+
+} // namespace game2d
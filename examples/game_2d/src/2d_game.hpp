@@ -0,0 +1,146 @@
+#pragma once
+
+// c++ lib headers
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// other lib headers
+#include <glm/glm.hpp>
+
+// engine headers
+#include "engine/maths_core.hpp"
+#include "engine/tools/metrics.hpp"
+
+// game headers
+#include "2d_culling.hpp"
+#include "2d_game_logic.hpp"
+#include "2d_game_object.hpp"
+#include "2d_physics.hpp"
+#include "spritemap.hpp"
+
+namespace game2d {
+
+//
+// The game's state and its update, without a window, renderer, ui or audio.
+// main.cpp fills the player's keys from the window and draws the state,
+// headless runs fill them from a script and only tick.
+//
+
+enum class GameRunning
+{
+  ACTIVE,
+  PAUSED,
+  GAME_OVER
+};
+
+// all spritesheets live in one texture array, the tex_slot_* values are the layer of each sheet in that array.
+const int tex_slot_kenny_nl = 0;
+const int tex_slot_tree = 1;
+
+// colour palette; https://colorhunt.co/palette/273312
+const glm::vec4 PALETTE_COLOUR_1_1 = glm::vec4(57.0f / 255.0f, 62.0f / 255.0f, 70.0f / 255.0f, 1.0f);    // black
+const glm::vec4 PALETTE_COLOUR_2_1 = glm::vec4(0.0f / 255.0f, 173.0f / 255.0f, 181.0f / 255.0f, 1.0f);   // blue
+const glm::vec4 PALETTE_COLOUR_3_1 = glm::vec4(170.0f / 255.0f, 216.0f / 255.0f, 211.0f / 255.0f, 1.0f); // lightblue
+const glm::vec4 PALETTE_COLOUR_4_1 = glm::vec4(238.0f / 255.0f, 238.0f / 255.0f, 238.0f / 255.0f, 1.0f); // grey
+
+const glm::vec4 player_colour = PALETTE_COLOUR_2_1;                              // blue
+const glm::vec4 bullet_colour = PALETTE_COLOUR_3_1;                              // lightblue
+const glm::vec4 wall_colour = PALETTE_COLOUR_4_1;                                // grey
+const glm::vec4 player_splat_colour = glm::vec4(0.95f, 0.3f, 0.3f, 1.0f);        // redish
+const glm::vec4 enemy_death_splat_colour = glm::vec4(0.65f, 0.65f, 0.65f, 1.0f); // greyish
+const glm::vec4 enemy_impact_splat_colour = glm::vec4(1.0f, 0.3f, 0.3f, 1.0f);   // redish
+
+const sprite::type sprite_player = sprite::type::PERSON_1;
+const sprite::type sprite_bullet = sprite::type::WEAPON_ARROW_1;
+const sprite::type sprite_enemy_core = sprite::type::PERSON_2;
+const sprite::type sprite_weapon_base = sprite::type::WEAPON_SHOVEL;
+const sprite::type sprite_splat = sprite::type::CASTLE_FLOOR;
+
+const float game_safe_radius_around_player = 7500.0f;
+const float game_enemy_direct_attack_threshold = 4000.0f;
+const float screenshake_time = 0.1f;
+const float vfx_flash_time = 0.2f;
+const int PHYSICS_GRID_SIZE = 100;
+
+// the counters and gauges the game keeps, see engine/tools/metrics.hpp
+struct GameMetrics
+{
+  fightingengine::metrics::Id players = 0;
+  fightingengine::metrics::Id enemies = 0;
+  fightingengine::metrics::Id bullets = 0;
+  fightingengine::metrics::Id vfx = 0;
+  fightingengine::metrics::Id live_attacks = 0;
+  fightingengine::metrics::Id collision_pairs = 0;
+  fightingengine::metrics::Id attacks_landed = 0;
+};
+
+struct GameState
+{
+  GameRunning running = GameRunning::ACTIVE;
+  uint32_t seed = 0;
+  fightingengine::RandomState rnd;
+  glm::ivec2 screen_wh = { 1280, 720 };
+  uint64_t tick = 0;
+
+  GameObject2D camera;
+  GameObject2D weapon_base;
+  std::vector<GameObject2D> entities_enemies;
+  std::vector<GameObject2D> entities_bullets;
+  std::vector<GameObject2D> entities_player;
+  std::vector<GameObject2D> entities_trees;
+  std::vector<GameObject2D> entities_vfx;
+  std::vector<KeysAndState> player_keys; // one per player, filled before update_game()
+  std::vector<Attack> live_attacks;
+  std::vector<CollisionEvent> collision_events;
+  enemy_spawner::Spawner spawner;
+  culling::CullGrid cull_grid; // everything renderable that isn't static, kept in step by erase_flagged()
+
+  // vfx
+  float screenshake_time_left = 0.0f;
+  bool shake = false;
+
+  // set when a player walked in to a tree this tick
+  bool player_at_tree = false;
+
+  // ticks between re-sorting the enemies, bullets and vfx by position, see sort_by_morton(). 0 never sorts
+  uint32_t morton_sort_interval = 60;
+
+  GameMetrics metrics;
+};
+
+// one player, no enemies. the seed is the only randomness in the game.
+// restarts the ids, so only one game can be running at once
+void
+init(GameState& game, glm::ivec2 screen_wh, uint32_t seed);
+
+// broadphase collisions, in to game.collision_events
+void
+update_physics(GameState& game);
+
+// resolves collisions, moves everything and flags the dead for deletion
+void
+update_game(GameState& game, float delta_time_s);
+
+// erases everything flagged, and every morton_sort_interval ticks re-sorts what's left.
+// anything keeping its own copy (the static sprite layer) has to catch up before this.
+// the cull grid is synced after, so it points at where everything ended up
+void
+erase_flagged(GameState& game);
+
+// sorts objects by the morton code of the grid cell they're in, so objects near each other
+// in the world are near each other in memory for the broadphase and culling.
+// objects in the same cell keep their order, so the same objects always sort the same way
+void
+sort_by_morton(std::vector<GameObject2D>& objs, int grid_size);
+
+// count enemies in a ring around player 0, outside the safe radius
+void
+spawn_enemies_around_player(GameState& game, uint32_t count);
+
+// all three, for when nothing else needs to see the state in between.
+// physics_while_paused is for stepping a paused game one frame at a time
+void
+tick(GameState& game, float delta_time_s, bool physics_while_paused = false);
+
+} // namespace game2d
@@ -25,17 +25,11 @@ bullet::update(GameObject2D& obj, float delta_time_s)
 };
 
 void
-camera::update(GameObject2D& camera, const KeysAndState& keys, fightingengine::Application& app, float delta_time_s)
+camera::update(GameObject2D& camera, const KeysAndState& keys, float delta_time_s)
 {
   // go.pos = glm::vec2(other.pos.x - screen_width / 2.0f, other.pos.y - screen_height / 2.0f);
-  if (app.get_input().get_key_held(keys.key_camera_left))
-    camera.pos.x -= delta_time_s * camera.speed_current;
-  if (app.get_input().get_key_held(keys.key_camera_right))
-    camera.pos.x += delta_time_s * camera.speed_current;
-  if (app.get_input().get_key_held(keys.key_camera_up))
-    camera.pos.y -= delta_time_s * camera.speed_current;
-  if (app.get_input().get_key_held(keys.key_camera_down))
-    camera.pos.y += delta_time_s * camera.speed_current;
+  camera.pos.x += keys.camera_x * delta_time_s * camera.speed_current;
+  camera.pos.y += keys.camera_y * delta_time_s * camera.speed_current;
 };
 
 void
@@ -78,15 +72,12 @@ enemy_ai::enemy_arc_angles_to_player(GameObject2D& obj, GameObject2D& player, fl
 namespace enemy_spawner {
 
 const bool game_spawn_enemies = true;
-const float game_wall_seconds_between_spawning_start = 1.0f;
-float game_wall_seconds_between_spawning_current = game_wall_seconds_between_spawning_start;
-float game_wall_seconds_between_spawning_left = 0.0f;
 const float game_wall_seconds_between_spawning_end = 0.2f;
 const float game_seconds_until_max_difficulty = 100.0f;
-float game_seconds_until_max_difficulty_spent = 0.0f;
 
 void
-update(std::vector<GameObject2D>& enemies,
+update(Spawner& spawner,
+       std::vector<GameObject2D>& enemies,
        GameObject2D& camera,
        std::vector<GameObject2D>& players,
        fightingengine::RandomState& rnd,
@@ -97,9 +88,9 @@ update(std::vector<GameObject2D>& enemies,
        const sprite::type sprite,
        const float delta_time_s)
 {
-  game_wall_seconds_between_spawning_left -= delta_time_s;
-  if (game_wall_seconds_between_spawning_left <= 0.0f) {
-    game_wall_seconds_between_spawning_left = game_wall_seconds_between_spawning_current;
+  spawner.seconds_between_spawning_left -= delta_time_s;
+  if (spawner.seconds_between_spawning_left <= 0.0f) {
+    spawner.seconds_between_spawning_left = spawner.seconds_between_spawning_current;
 
     // search params
     bool continue_search = true;
@@ -152,10 +143,11 @@ update(std::vector<GameObject2D>& enemies,
   // increase difficulty
   // 0.5 is starting cooldown
   // after 30 seconds, cooldown should be 0
-  game_seconds_until_max_difficulty_spent += delta_time_s;
-  float percent = glm::clamp(game_seconds_until_max_difficulty_spent / game_seconds_until_max_difficulty, 0.0f, 1.0f);
-  game_wall_seconds_between_spawning_current =
-    glm::mix(game_wall_seconds_between_spawning_start, game_wall_seconds_between_spawning_end, percent);
+  spawner.seconds_until_max_difficulty_spent += delta_time_s;
+  float percent =
+    glm::clamp(spawner.seconds_until_max_difficulty_spent / game_seconds_until_max_difficulty, 0.0f, 1.0f);
+  spawner.seconds_between_spawning_current =
+    glm::mix(Spawner::seconds_between_spawning_start, game_wall_seconds_between_spawning_end, percent);
 };
 
 } // namespace enemyspawner
@@ -170,8 +162,12 @@ update_input(GameObject2D& obj, KeysAndState& keys, fightingengine::Application&
   keys.r_analogue_x = 0.0f;
   keys.r_analogue_y = 0.0f;
   keys.shoot_pressed = false;
+  keys.shoot_down = false;
   keys.boost_pressed = false;
+  keys.weapon_next_pressed = false;
   keys.pause_pressed = false;
+  keys.camera_x = 0.0f;
+  keys.camera_y = 0.0f;
 
   // Keymaps: keyboard
   if (keys.use_keyboard) {
@@ -192,9 +188,23 @@ update_input(GameObject2D& obj, KeysAndState& keys, fightingengine::Application&
     }
 
     keys.shoot_pressed = app.get_input().get_mouse_lmb_held();
+    keys.shoot_down = app.get_input().get_mouse_lmb_down();
     keys.boost_pressed = app.get_input().get_key_held(keys.key_boost);
     keys.pause_pressed = app.get_input().get_key_down(keys.key_pause);
 
+    const float mousewheel = app.get_input().get_mousewheel_y();
+    const float epsilon = 0.0001f;
+    keys.weapon_next_pressed = mousewheel > epsilon || mousewheel < -epsilon;
+
+    if (app.get_input().get_key_held(keys.key_camera_left))
+      keys.camera_x -= 1.0f;
+    if (app.get_input().get_key_held(keys.key_camera_right))
+      keys.camera_x += 1.0f;
+    if (app.get_input().get_key_held(keys.key_camera_up))
+      keys.camera_y -= 1.0f;
+    if (app.get_input().get_key_held(keys.key_camera_down))
+      keys.camera_y += 1.0f;
+
     glm::vec2 player_world_space_pos = gameobject_in_worldspace(camera, obj);
     float mouse_angle_around_player = atan2(app.get_input().get_mouse_pos().y - player_world_space_pos.y,
                                             app.get_input().get_mouse_pos().x - player_world_space_pos.x);
@@ -248,8 +258,7 @@ ability_boost(GameObject2D& player, const KeysAndState& keys, const float delta_
 }
 
 void
-ability_shoot(fightingengine::Application& app,
-              GameObject2D& player,
+ability_shoot(GameObject2D& player,
               const KeysAndState& keys,
               std::vector<GameObject2D>& bullets,
               const int tex_unit,
@@ -264,7 +273,7 @@ ability_shoot(fightingengine::Application& app,
   if (player.bullet_seconds_between_spawning_left > 0.0f)
     player.bullet_seconds_between_spawning_left -= delta_time_s;
 
-  if (player.bullet_seconds_between_spawning_left <= 0.0f || app.get_input().get_mouse_lmb_down()) {
+  if (player.bullet_seconds_between_spawning_left <= 0.0f || keys.shoot_down) {
     player.bullet_seconds_between_spawning_left = player.bullet_seconds_between_spawning;
     // obj.bullets_to_fire_after_releasing_mouse_left -= 1;
     // obj.bullets_to_fire_after_releasing_mouse_left =
@@ -292,30 +301,26 @@ ability_shoot(fightingengine::Application& app,
   }
 }
 
-// slash stats
+// slash stats, the slash in progress is kept on the player
 const float weapon_radius = 30.0f;
 const float lmb_slash_attack_time = 0.15f;
-float lmb_slash_attack_time_left = 0.0f;
-float weapon_current_angle = 0.0f;
-float weapon_angle_speed = fightingengine::HALF_PI / 30.0f; // closer to 0 is faster
-bool attack_left_to_right = true;
+const float weapon_angle_speed = fightingengine::HALF_PI / 30.0f; // closer to 0 is faster
 
 void
-ability_slash(fightingengine::Application& app,
-              GameObject2D& player_obj,
+ability_slash(GameObject2D& player_obj,
               const KeysAndState& keys,
               GameObject2D& weapon,
               float delta_time_s,
               std::vector<Attack>& attacks)
 {
-  if (app.get_input().get_mouse_lmb_down()) {
-    lmb_slash_attack_time_left = lmb_slash_attack_time;
-    attack_left_to_right = !attack_left_to_right; // keep swapping left to right to right to left etc
+  if (keys.shoot_down) {
+    player_obj.slash_time_left = lmb_slash_attack_time;
+    player_obj.slash_left_to_right = !player_obj.slash_left_to_right; // keep swapping left-right, right-left
 
-    if (attack_left_to_right)
-      weapon_current_angle = keys.angle_around_player - fightingengine::HALF_PI / 2.0f;
+    if (player_obj.slash_left_to_right)
+      player_obj.slash_angle = keys.angle_around_player - fightingengine::HALF_PI / 2.0f;
     else
-      weapon_current_angle = keys.angle_around_player + fightingengine::HALF_PI / 2.0f;
+      player_obj.slash_angle = keys.angle_around_player + fightingengine::HALF_PI / 2.0f;
 
     // set angle, but freezes weapon angle throughout slash?
     weapon.angle_radians = keys.angle_around_player + sprite::spritemap::get_sprite_rotation_offset(weapon.sprite);
@@ -336,8 +341,8 @@ ability_slash(fightingengine::Application& app,
     attacks.push_back(a);
   }
 
-  if (lmb_slash_attack_time_left > 0.0f) {
-    lmb_slash_attack_time_left -= delta_time_s;
+  if (player_obj.slash_time_left > 0.0f) {
+    player_obj.slash_time_left -= delta_time_s;
     weapon.do_render = true;
     weapon.do_physics = true;
   } else {
@@ -349,20 +354,19 @@ ability_slash(fightingengine::Application& app,
   pos.x += player_obj.physics_size.x / 2.0f - weapon.physics_size.x / 2.0f;
   pos.y += player_obj.physics_size.y / 2.0f - weapon.physics_size.y / 2.0f;
 
-  if (attack_left_to_right)
-    weapon_current_angle += weapon_angle_speed;
+  if (player_obj.slash_left_to_right)
+    player_obj.slash_angle += weapon_angle_speed;
   else
-    weapon_current_angle -= weapon_angle_speed;
+    player_obj.slash_angle -= weapon_angle_speed;
 
   // offset around center of circle
   glm::vec2 offset_pos =
-    glm::vec2(weapon_radius * sin(weapon_current_angle), -weapon_radius * cos(weapon_current_angle));
+    glm::vec2(weapon_radius * sin(player_obj.slash_angle), -weapon_radius * cos(player_obj.slash_angle));
   weapon.pos = pos + offset_pos;
 }
 
 void
-update(fightingengine::Application& app,
-       GameObject2D& player,
+update(GameObject2D& player,
        const KeysAndState& keys,
        std::vector<GameObject2D>& bullets,
        const int tex_unit,
@@ -382,9 +386,9 @@ update(fightingengine::Application& app,
   gameobject::update_position(player, delta_time_s);
 
   if (player.equipped_weapon == Weapons::SHOVEL)
-    ability_slash(app, player, keys, weapon, delta_time_s, attacks);
+    ability_slash(player, keys, weapon, delta_time_s, attacks);
   if (player.equipped_weapon == Weapons::PISTOL)
-    ability_shoot(app, player, keys, bullets, tex_unit, col, sprite, delta_time_s, attacks);
+    ability_shoot(player, keys, bullets, tex_unit, col, sprite, delta_time_s, attacks);
 };
 
 }; // namespace player
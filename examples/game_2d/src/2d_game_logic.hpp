@@ -25,7 +25,7 @@ update(GameObject2D& obj, float delta_time_s);
 namespace camera {
 
 void
-update(GameObject2D& camera, const KeysAndState& keys, fightingengine::Application& app, float delta_time_s);
+update(GameObject2D& camera, const KeysAndState& keys, float delta_time_s);
 
 }; // namespace camera
 
@@ -44,9 +44,19 @@ enemy_arc_angles_to_player(GameObject2D& obj, GameObject2D& player, float delta_
 
 namespace enemy_spawner {
 
+// the spawn timer and how far the difficulty has ramped up
+struct Spawner
+{
+  static constexpr float seconds_between_spawning_start = 1.0f;
+  float seconds_between_spawning_current = seconds_between_spawning_start;
+  float seconds_between_spawning_left = 0.0f;
+  float seconds_until_max_difficulty_spent = 0.0f;
+};
+
 // spawn a random enemy every X seconds
 void
-update(std::vector<GameObject2D>& enemies,
+update(Spawner& spawner,
+       std::vector<GameObject2D>& enemies,
        GameObject2D& camera,
        std::vector<GameObject2D>& players,
        fightingengine::RandomState& rnd,
@@ -61,12 +71,13 @@ update(std::vector<GameObject2D>& enemies,
 
 namespace player {
 
+// fills keys from the window's input. the rest of the game only reads keys,
+// so it can run from scripted or recorded input without a window.
 void
 update_input(GameObject2D& obj, KeysAndState& keys, fightingengine::Application& app, GameObject2D& camera);
 
 void
-update(fightingengine::Application& app,
-       GameObject2D& player,
+update(GameObject2D& player,
        const KeysAndState& keys,
        std::vector<GameObject2D>& bullets,
        const int tex_unit,
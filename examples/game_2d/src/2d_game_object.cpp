@@ -164,6 +164,8 @@ create_tree(int tex_slot)
   game_object.collision_layer = CollisionLayer::Obstacle;
   game_object.name = "tree";
   game_object.tex_slot = tex_slot;
+  game_object.render_layer = RenderLayer::Ground;
+  game_object.do_render_static = true;
   game_object.sprite = sprite::type::EMPTY;
   game_object.render_size = { 32.0f, 32.0f };
   game_object.physics_size = { 32.0f, 32.0f };
@@ -182,6 +184,7 @@ create_player(sprite::type sprite, int tex_slot, glm::vec4 colour, glm::vec2 scr
   game_object.pos = { screen.x / 2.0f, screen.y / 2.0f };
   // default
   game_object.collision_layer = CollisionLayer::Player;
+  game_object.render_layer = RenderLayer::Player;
   game_object.name = "player";
   game_object.angle_radians = 0.0;
   game_object.render_size = { 1.0f * 768.0f / 48.0f, 1.0f * 362.0f / 22.0f };
@@ -201,6 +204,8 @@ create_kennynl_texture(int tex_slot)
 {
   GameObject2D game_object;
   game_object.name = "texture_sheet";
+  game_object.tex_slot = tex_slot;
+  game_object.render_layer = RenderLayer::Debug;
   game_object.pos = { 0.0f, 20.0f };
   game_object.render_size = { 768.0f, 352.0f };
   game_object.physics_size = { 768.0f, 352.0f };
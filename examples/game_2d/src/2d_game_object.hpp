@@ -22,6 +22,16 @@ enum class CollisionLayer
   Count = 6
 };
 
+// draw order, lower layers are drawn first
+enum class RenderLayer : uint8_t
+{
+  Background = 0,
+  Ground = 1,
+  Entities = 2,
+  Player = 3,
+  Debug = 4,
+};
+
 static const std::vector<bool> GAME_COLL_MATRIX = {
   false, // NoCollision_NoCollision_0_0
   false, // bullet_NoCollision_1_0
@@ -78,7 +88,11 @@ struct KeysAndState
   float angle_around_player = 0.0f;
   bool pause_pressed = false;
   bool shoot_pressed = false;
+  bool shoot_down = false; // pressed this frame
   bool boost_pressed = false;
+  bool weapon_next_pressed = false;
+  float camera_x = 0.0f; // -1 to 1
+  float camera_y = 0.0f;
 };
 
 enum class AiBehaviour
@@ -114,6 +128,9 @@ public:
   {
     id = ++Attack::global_attack_int_counter;
   };
+
+  // ids start again from 1, see GameObject2D::reset_ids()
+  static void reset_ids() { global_attack_int_counter = 0; };
 };
 
 //
@@ -129,7 +146,12 @@ private:
 public:
   uint32_t id = 0;
 
+  // ids start again from 1. the broadphase orders pairs by id,
+  // so a new game has to reset them to play out the same as an earlier one
+  static void reset_ids() { global_int_counter = 0; };
+
   bool do_render = true;
+  bool do_render_static = false; // never moves, drawn by the static sprite layer
   bool do_lifecycle_timed = false;
   bool do_lifecycle_health = true;
   bool do_physics = true;
@@ -137,11 +159,14 @@ public:
 
   // render
   int tex_slot = 0;
+  RenderLayer render_layer = RenderLayer::Entities;
   sprite::type sprite = sprite::type::SQUARE;
   glm::vec2 pos = { 0.0f, 0.0f }; // in pixels, centered
   float angle_radians = 0.0f;
   glm::vec4 colour = { 1.0f, 0.0f, 0.0f, 1.0f };
   glm::vec2 render_size = { 20.0f, 20.0f };
+  int cull_cell = -1; // where the object is in the cull grid, see 2d_culling.hpp
+  int cull_slot = -1;
 
   // physics
   glm::vec2 physics_size = render_size;
@@ -167,6 +192,11 @@ public:
   float bullet_seconds_between_spawning = 0.15f;
   float bullet_seconds_between_spawning_left = 0.0f;
 
+  // game: slashing
+  float slash_time_left = 0.0f;
+  float slash_angle = 0.0f;
+  bool slash_left_to_right = true;
+
   // game: lifecycle timed
   float time_alive_left = 5.0f;
   glm::vec4 flash_colour = glm::vec4(1.0f, 0.3f, 0.3f, 1.0f);
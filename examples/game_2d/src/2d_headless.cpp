@@ -0,0 +1,262 @@
+// header
+#include "2d_headless.hpp"
+
+// c++ lib headers
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// other lib headers
+#include <glm/glm.hpp>
+
+// engine headers
+#include "engine/maths_core.hpp"
+#include "engine/tools/metrics.hpp"
+#include "engine/tools/profiler.hpp"
+
+namespace game2d {
+
+namespace headless {
+
+using namespace fightingengine;
+
+bool
+is_requested(int argc, char** argv)
+{
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--headless") == 0 || std::strcmp(argv[i], "--replay") == 0)
+      return true;
+  }
+  return false;
+}
+
+bool
+parse_args(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (std::strcmp(arg, "--headless") == 0)
+      continue;
+
+    if (i + 1 >= argc) {
+      std::cerr << "headless: " << arg << " is missing a value" << std::endl;
+      return false;
+    }
+    const char* value = argv[++i];
+
+    try {
+      if (std::strcmp(arg, "--ticks") == 0)
+        options.ticks = static_cast<uint32_t>(std::stoul(value));
+      else if (std::strcmp(arg, "--enemies") == 0)
+        options.enemies = static_cast<uint32_t>(std::stoul(value));
+      else if (std::strcmp(arg, "--seed") == 0)
+        options.seed = static_cast<uint32_t>(std::stoul(value));
+      else if (std::strcmp(arg, "--dt") == 0)
+        options.delta_time_s = std::stof(value);
+      else if (std::strcmp(arg, "--metrics") == 0)
+        options.metrics_path = value;
+      else if (std::strcmp(arg, "--record") == 0)
+        options.record_path = value;
+      else if (std::strcmp(arg, "--replay") == 0)
+        options.replay_path = value;
+      else {
+        std::cerr << "headless: unknown arg " << arg << std::endl;
+        return false;
+      }
+    } catch (const std::exception&) {
+      std::cerr << "headless: could not read " << arg << " " << value << std::endl;
+      return false;
+    }
+  }
+
+  if (options.delta_time_s <= 0.0f) {
+    std::cerr << "headless: --dt has to be above 0" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void
+scripted_input(uint64_t tick, KeysAndState& keys)
+{
+  const float t = static_cast<float>(tick);
+
+  // walk in a slow circle, boosting for a third of a second every 5 seconds
+  keys.l_analogue_x = glm::cos(t * 0.01f);
+  keys.l_analogue_y = glm::sin(t * 0.01f);
+  keys.boost_pressed = tick % 300 < 20;
+
+  // aim round the player once every 2 seconds
+  keys.angle_around_player = t * (2.0f * fightingengine::PI / 120.0f);
+  keys.r_analogue_x = glm::sin(keys.angle_around_player);
+  keys.r_analogue_y = -glm::cos(keys.angle_around_player);
+
+  // hold fire for a second, let go for a second. swing the shovel twice a second
+  keys.shoot_pressed = (tick / 60) % 2 == 0;
+  keys.shoot_down = tick % 30 == 0;
+
+  // swap between the shovel and pistol every 10 seconds
+  keys.weapon_next_pressed = tick > 0 && tick % 600 == 0;
+
+  keys.pause_pressed = false;
+  keys.camera_x = 0.0f;
+  keys.camera_y = 0.0f;
+}
+
+static void
+hash_bytes(uint64_t& hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+}
+
+static void
+hash_objects(uint64_t& hash, const std::vector<GameObject2D>& objs)
+{
+  const uint64_t count = objs.size();
+  hash_bytes(hash, &count, sizeof(count));
+  for (const GameObject2D& obj : objs) {
+    hash_bytes(hash, &obj.pos, sizeof(obj.pos));
+    hash_bytes(hash, &obj.velocity, sizeof(obj.velocity));
+    hash_bytes(hash, &obj.hits_taken, sizeof(obj.hits_taken));
+  }
+}
+
+uint64_t
+checksum(const GameState& game)
+{
+  uint64_t hash = 14695981039346656037ull;
+  hash_bytes(hash, &game.tick, sizeof(game.tick));
+  hash_objects(hash, game.entities_player);
+  hash_objects(hash, game.entities_enemies);
+  hash_objects(hash, game.entities_bullets);
+  hash_objects(hash, game.entities_vfx);
+  hash_bytes(hash, &game.camera.pos, sizeof(game.camera.pos));
+  return hash;
+}
+
+static void
+print_stats(const char* name, const Profiler::Stats& stats)
+{
+  printf("%-12s %8.3f %8.3f %8.3f %8.3f %8.3f\n", name, stats.mean, stats.p50, stats.p95, stats.p99, stats.max);
+}
+
+int
+run(const Options& options)
+{
+  replay::Recording recording;
+  if (!options.replay_path.empty()) {
+    if (!replay::load(options.replay_path, recording))
+      return 1;
+    printf("replay: %s, %zu ticks, %u enemies, seed %u\n",
+           options.replay_path.c_str(),
+           recording.ticks.size(),
+           recording.enemies,
+           recording.seed);
+  } else {
+    // the players can't die, so every run lasts all the ticks
+    recording.seed = options.seed;
+    recording.enemies = options.enemies;
+    recording.invulnerable = true;
+    printf("headless: %u ticks, %u enemies, seed %u, dt %f\n",
+           options.ticks,
+           options.enemies,
+           options.seed,
+           options.delta_time_s);
+  }
+  const bool replaying = !options.replay_path.empty();
+  const uint32_t ticks = replaying ? static_cast<uint32_t>(recording.ticks.size()) : options.ticks;
+
+  profiler::set_thread_name("main");
+  Profiler profiler;
+
+  // the metrics export covers every tick, not only the last history_frames. a frame is sampled before the first tick
+  metrics::set_history_frames(std::max(metrics::get_history_frames(), ticks + 1));
+
+  GameState game;
+  replay::new_game(game, recording);
+
+  // every tick's times, the profiler only keeps the last history_frames
+  std::vector<float> physics_ms;
+  std::vector<float> game_tick_ms;
+  std::vector<float> tick_ms;
+  physics_ms.reserve(ticks);
+  game_tick_ms.reserve(ticks);
+  tick_ms.reserve(ticks);
+  auto keep_last_tick = [&]() {
+    physics_ms.push_back(profiler.get_time(Profiler::Stage::Physics));
+    game_tick_ms.push_back(profiler.get_time(Profiler::Stage::GameTick));
+    tick_ms.push_back(profiler.get_time(Profiler::Stage::UpdateLoop));
+  };
+
+  for (uint32_t i = 0; i < ticks; i++) {
+    metrics::new_frame();
+    profiler.new_frame();
+    if (i > 0)
+      keep_last_tick();
+    profiler.begin(Profiler::Stage::UpdateLoop);
+
+    float delta_time_s = options.delta_time_s;
+    bool physics_while_paused = false;
+    if (replaying) {
+      const replay::Tick& tick = recording.ticks[i];
+      replay::apply(game, tick);
+      delta_time_s = tick.delta_time_s;
+      physics_while_paused = tick.physics_while_paused;
+    } else {
+      for (KeysAndState& keys : game.player_keys)
+        scripted_input(game.tick, keys);
+      if (!options.record_path.empty())
+        replay::record(recording, game, delta_time_s, physics_while_paused);
+    }
+
+    profiler.begin(Profiler::Stage::Physics);
+    if (game.running == GameRunning::ACTIVE || (game.running == GameRunning::PAUSED && physics_while_paused))
+      update_physics(game);
+    profiler.end(Profiler::Stage::Physics);
+
+    profiler.begin(Profiler::Stage::GameTick);
+    update_game(game, delta_time_s);
+    erase_flagged(game);
+    profiler.end(Profiler::Stage::GameTick);
+
+    profiler.end(Profiler::Stage::UpdateLoop);
+  }
+  metrics::new_frame();
+  profiler.new_frame();
+  if (ticks > 0)
+    keep_last_tick();
+
+  printf("\nms over all %u ticks\n", ticks);
+  printf("%-12s %8s %8s %8s %8s %8s\n", "stage", "mean", "p50", "p95", "p99", "max");
+  print_stats("Physics", Profiler::stats_from(physics_ms));
+  print_stats("Game Tick", Profiler::stats_from(game_tick_ms));
+  print_stats("Tick", Profiler::stats_from(tick_ms));
+
+  printf("\nafter %llu ticks: %zu players, %zu enemies, %zu bullets, %zu vfx, %zu attacks\n",
+         static_cast<unsigned long long>(game.tick),
+         game.entities_player.size(),
+         game.entities_enemies.size(),
+         game.entities_bullets.size(),
+         game.entities_vfx.size(),
+         game.live_attacks.size());
+  printf("checksum: %016llx\n", static_cast<unsigned long long>(checksum(game)));
+
+  bool ok = true;
+  if (!options.record_path.empty() && !replaying)
+    ok &= replay::save(options.record_path, recording);
+  if (!options.metrics_path.empty())
+    ok &= metrics::write_csv(options.metrics_path);
+  return ok ? 0 : 1;
+}
+
+} // namespace headless
+
+} // namespace game2d
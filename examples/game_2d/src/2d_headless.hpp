@@ -0,0 +1,62 @@
+#pragma once
+
+// c++ lib headers
+#include <cstdint>
+#include <string>
+
+// game headers
+#include "2d_game.hpp"
+#include "2d_game_object.hpp"
+#include "2d_replay.hpp"
+
+namespace game2d {
+
+namespace headless {
+
+//
+// Runs the game without a window, renderer, ui or audio:
+// a fixed seed, a fixed delta time and scripted input, for a set number of ticks.
+// Prints the physics and game tick times at the end, and a summary of the final
+// state so two runs with the same options can be compared.
+// Replays play a recorded game (see 2d_replay.hpp) instead of the script,
+// as fast as they can, so one recorded spike can be run as a load benchmark.
+//
+// game_2d --headless [--ticks N] [--enemies N] [--seed N] [--dt seconds] [--metrics out.csv] [--record out.replay]
+// game_2d --replay in.replay [--metrics out.csv]
+//
+
+struct Options
+{
+  uint32_t ticks = 3600;
+  uint32_t enemies = 0; // spawned around the player before the first tick
+  uint32_t seed = 0;
+  float delta_time_s = 1.0f / 60.0f;
+  std::string metrics_path; // every tick is written with metrics::write_csv() if set
+  std::string record_path;  // the scripted input is saved as a replay if set
+  std::string replay_path;  // plays this instead, ignoring ticks, enemies, seed and dt
+};
+
+// --headless or --replay
+[[nodiscard]] bool
+is_requested(int argc, char** argv);
+
+// returns false if an arg couldn't be read
+[[nodiscard]] bool
+parse_args(int argc, char** argv, Options& options);
+
+// the same input for the same tick, every run
+void
+scripted_input(uint64_t tick, KeysAndState& keys);
+
+// fnv-1a over every entity's position, velocity and hits taken. ids are left out,
+// they come from a global counter so depend on what else was made in the process
+[[nodiscard]] uint64_t
+checksum(const GameState& game);
+
+// returns the process exit code
+int
+run(const Options& options);
+
+} // namespace headless
+
+} // namespace game2d
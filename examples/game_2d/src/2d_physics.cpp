@@ -4,6 +4,7 @@
 // engine headers
 #include "engine/grid.hpp"
 #include "engine/maths_core.hpp"
+#include "engine/tools/profiler.hpp"
 
 namespace game2d {
 
@@ -24,6 +25,7 @@ generate_broadphase_collisions(const std::vector<std::reference_wrapper<GameObje
                                COLLISION_AXIS axis,
                                std::map<uint64_t, Collision2D>& collisions)
 {
+  PROFILE_FUNCTION();
 
   // 2. begin on the left of above list.
   std::vector<std::reference_wrapper<GameObject2D>> active_list;
@@ -119,6 +121,7 @@ void
 generate_filtered_broadphase_collisions(std::vector<std::reference_wrapper<GameObject2D>>& collidable,
                                         std::map<uint64_t, Collision2D>& filtered_collisions)
 {
+  PROFILE_FUNCTION();
   // Do broad-phase check.
   std::map<uint64_t, Collision2D> collisions;
 
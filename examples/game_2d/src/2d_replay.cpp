@@ -0,0 +1,233 @@
+// header
+#include "2d_replay.hpp"
+
+// c++ lib headers
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace game2d {
+
+namespace replay {
+
+void
+new_game(GameState& game, const Recording& recording)
+{
+  init(game, recording.screen_wh, recording.seed);
+
+  if (recording.invulnerable) {
+    for (GameObject2D& player : game.entities_player)
+      player.invulnerable = true;
+  }
+  spawn_enemies_around_player(game, recording.enemies);
+}
+
+void
+record(Recording& recording, const GameState& game, float delta_time_s, bool physics_while_paused)
+{
+  Tick tick;
+  tick.delta_time_s = delta_time_s;
+  tick.physics_while_paused = physics_while_paused;
+  tick.screen_wh = game.screen_wh;
+  tick.keys = game.player_keys;
+  recording.ticks.push_back(std::move(tick));
+}
+
+void
+apply(GameState& game, const Tick& tick)
+{
+  game.screen_wh = tick.screen_wh;
+  for (size_t i = 0; i < game.player_keys.size() && i < tick.keys.size(); i++)
+    game.player_keys[i] = tick.keys[i];
+}
+
+//
+// writing
+//
+
+template<typename T>
+static void
+put(std::vector<uint8_t>& out, const T& value)
+{
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static bool
+axes_equal(const KeysAndState& a, const KeysAndState& b)
+{
+  return a.l_analogue_x == b.l_analogue_x && a.l_analogue_y == b.l_analogue_y && a.r_analogue_x == b.r_analogue_x &&
+         a.r_analogue_y == b.r_analogue_y && a.angle_around_player == b.angle_around_player &&
+         a.camera_x == b.camera_x && a.camera_y == b.camera_y;
+}
+
+bool
+save(const std::string& path, const Recording& recording)
+{
+  const uint32_t players = recording.ticks.empty() ? 0 : static_cast<uint32_t>(recording.ticks[0].keys.size());
+
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.seed = recording.seed;
+  header.screen_w = recording.screen_wh.x;
+  header.screen_h = recording.screen_wh.y;
+  header.enemies = recording.enemies;
+  header.players = players;
+  header.flags = recording.invulnerable ? header_flag_invulnerable : 0;
+  header.tick_count = static_cast<uint32_t>(recording.ticks.size());
+
+  std::vector<uint8_t> out;
+  put(out, header);
+
+  glm::ivec2 screen_wh = recording.screen_wh;
+  std::vector<KeysAndState> last_keys(players);
+  for (const Tick& tick : recording.ticks) {
+    if (tick.keys.size() != players) {
+      std::cerr << "replay: every tick has to have the same number of players" << std::endl;
+      return false;
+    }
+
+    uint8_t tick_flags = 0;
+    if (tick.physics_while_paused)
+      tick_flags |= tick_flag_physics_while_paused;
+    if (tick.screen_wh != screen_wh)
+      tick_flags |= tick_flag_screen_changed;
+
+    put(out, tick.delta_time_s);
+    put(out, tick_flags);
+    if (tick_flags & tick_flag_screen_changed) {
+      put(out, static_cast<int32_t>(tick.screen_wh.x));
+      put(out, static_cast<int32_t>(tick.screen_wh.y));
+      screen_wh = tick.screen_wh;
+    }
+
+    for (uint32_t p = 0; p < players; p++) {
+      const KeysAndState& keys = tick.keys[p];
+
+      uint8_t key_flags = 0;
+      key_flags |= keys.pause_pressed ? key_flag_pause : 0;
+      key_flags |= keys.shoot_pressed ? key_flag_shoot : 0;
+      key_flags |= keys.shoot_down ? key_flag_shoot_down : 0;
+      key_flags |= keys.boost_pressed ? key_flag_boost : 0;
+      key_flags |= keys.weapon_next_pressed ? key_flag_weapon_next : 0;
+      key_flags |= axes_equal(keys, last_keys[p]) ? 0 : key_flag_axes_changed;
+
+      put(out, key_flags);
+      if (key_flags & key_flag_axes_changed) {
+        put(out, keys.l_analogue_x);
+        put(out, keys.l_analogue_y);
+        put(out, keys.r_analogue_x);
+        put(out, keys.r_analogue_y);
+        put(out, keys.angle_around_player);
+        put(out, keys.camera_x);
+        put(out, keys.camera_y);
+      }
+      last_keys[p] = keys;
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    std::cerr << "replay: could not write " << path << std::endl;
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(out.data()), out.size());
+  return file.good();
+}
+
+//
+// reading
+//
+
+struct Reader
+{
+  const std::vector<uint8_t>& bytes;
+  size_t at = 0;
+
+  template<typename T>
+  [[nodiscard]] bool get(T& value)
+  {
+    if (at + sizeof(T) > bytes.size())
+      return false;
+    std::memcpy(&value, bytes.data() + at, sizeof(T));
+    at += sizeof(T);
+    return true;
+  };
+};
+
+bool
+load(const std::string& path, Recording& recording)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "replay: could not open " << path << std::endl;
+    return false;
+  }
+  const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  Reader reader{ bytes };
+
+  Header header;
+  if (!reader.get(header) || std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version) {
+    std::cerr << "replay: not a v" << version << " replay file" << std::endl;
+    return false;
+  }
+
+  // every tick is at least its delta time, its flags and a byte per player.
+  // checked before anything is sized from the header, so a corrupt file can't ask for a huge allocation
+  const uint64_t remaining = bytes.size() - reader.at;
+  const uint64_t min_tick_bytes = sizeof(float) + sizeof(uint8_t) + static_cast<uint64_t>(header.players);
+  if (header.players > remaining || header.tick_count * min_tick_bytes > remaining) {
+    std::cerr << "replay: " << path << " is too short for " << header.tick_count << " ticks of " << header.players
+              << " players" << std::endl;
+    return false;
+  }
+
+  recording = Recording();
+  recording.seed = header.seed;
+  recording.screen_wh = { header.screen_w, header.screen_h };
+  recording.enemies = header.enemies;
+  recording.invulnerable = (header.flags & header_flag_invulnerable) != 0;
+  recording.ticks.reserve(header.tick_count);
+
+  glm::ivec2 screen_wh = recording.screen_wh;
+  std::vector<KeysAndState> keys(header.players);
+  for (uint32_t t = 0; t < header.tick_count; t++) {
+    Tick tick;
+    uint8_t tick_flags = 0;
+    bool ok = reader.get(tick.delta_time_s) && reader.get(tick_flags);
+    if (ok && (tick_flags & tick_flag_screen_changed))
+      ok = reader.get(screen_wh.x) && reader.get(screen_wh.y);
+    tick.physics_while_paused = (tick_flags & tick_flag_physics_while_paused) != 0;
+    tick.screen_wh = screen_wh;
+
+    for (uint32_t p = 0; ok && p < header.players; p++) {
+      KeysAndState& k = keys[p];
+      uint8_t key_flags = 0;
+      ok = reader.get(key_flags);
+      k.pause_pressed = (key_flags & key_flag_pause) != 0;
+      k.shoot_pressed = (key_flags & key_flag_shoot) != 0;
+      k.shoot_down = (key_flags & key_flag_shoot_down) != 0;
+      k.boost_pressed = (key_flags & key_flag_boost) != 0;
+      k.weapon_next_pressed = (key_flags & key_flag_weapon_next) != 0;
+      if (ok && (key_flags & key_flag_axes_changed)) {
+        ok = reader.get(k.l_analogue_x) && reader.get(k.l_analogue_y) && reader.get(k.r_analogue_x) &&
+             reader.get(k.r_analogue_y) && reader.get(k.angle_around_player) && reader.get(k.camera_x) &&
+             reader.get(k.camera_y);
+      }
+    }
+
+    if (!ok) {
+      std::cerr << "replay: file is truncated at tick " << t << std::endl;
+      return false;
+    }
+    tick.keys = keys;
+    recording.ticks.push_back(std::move(tick));
+  }
+  return true;
+}
+
+} // namespace replay
+
+} // namespace game2d
@@ -0,0 +1,110 @@
+#pragma once
+
+// c++ lib headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// other lib headers
+#include <glm/glm.hpp>
+
+// game headers
+#include "2d_game.hpp"
+#include "2d_game_object.hpp"
+
+namespace game2d {
+
+namespace replay {
+
+//
+// Recorded games (.replay). The game only changes through the seed and each
+// player's KeysAndState, so recording those with every tick's delta time
+// and playing them back through a new game gives the same game again.
+//
+// Layout (little endian)
+//
+// Header
+// per tick:
+//   float    delta_time_s
+//   uint8_t  tick flags
+//   int32_t  screen w, h          if tick_flag_screen_changed
+//   per player:
+//     uint8_t key flags
+//     float   l_analogue_x, l_analogue_y, r_analogue_x, r_analogue_y,
+//             angle_around_player, camera_x, camera_y   if key_flag_axes_changed
+//
+// Anything not written is the same as the tick before (the header, for the first tick).
+//
+
+static const char magic[4] = { 'R', 'P', 'L', 'Y' };
+static const uint32_t version = 1;
+
+// header flags
+static const uint32_t header_flag_invulnerable = 1 << 0;
+
+// tick flags
+static const uint8_t tick_flag_physics_while_paused = 1 << 0;
+static const uint8_t tick_flag_screen_changed = 1 << 1;
+
+// key flags
+static const uint8_t key_flag_pause = 1 << 0;
+static const uint8_t key_flag_shoot = 1 << 1;
+static const uint8_t key_flag_shoot_down = 1 << 2;
+static const uint8_t key_flag_boost = 1 << 3;
+static const uint8_t key_flag_weapon_next = 1 << 4;
+static const uint8_t key_flag_axes_changed = 1 << 7;
+
+struct Header
+{
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t seed = 0;
+  int32_t screen_w = 0;
+  int32_t screen_h = 0;
+  uint32_t enemies = 0;
+  uint32_t players = 0;
+  uint32_t flags = 0; // header_flag_*
+  uint32_t tick_count = 0;
+};
+static_assert(sizeof(Header) == 36, "replay header layout changed, bump the version");
+
+struct Tick
+{
+  float delta_time_s = 0.0f;
+  bool physics_while_paused = false;
+  glm::ivec2 screen_wh = { 0, 0 };
+  std::vector<KeysAndState> keys; // one per player
+};
+
+struct Recording
+{
+  // how the game was started, see new_game()
+  uint32_t seed = 0;
+  glm::ivec2 screen_wh = { 1280, 720 };
+  uint32_t enemies = 0;
+  bool invulnerable = false;
+
+  std::vector<Tick> ticks;
+};
+
+// init() and the setup the recording was started with
+void
+new_game(GameState& game, const Recording& recording);
+
+// call once a tick, after the keys are filled and before update_game()
+void
+record(Recording& recording, const GameState& game, float delta_time_s, bool physics_while_paused);
+
+// sets the game's keys and screen size to the tick's, so it can be ticked
+void
+apply(GameState& game, const Tick& tick);
+
+[[nodiscard]] bool
+save(const std::string& path, const Recording& recording);
+
+[[nodiscard]] bool
+load(const std::string& path, Recording& recording);
+
+} // namespace replay
+
+} // namespace game2d
@@ -17,6 +17,8 @@ spawn_death_splat(fightingengine::RandomState& rnd,
   GameObject2D splat = gameobject::create_generic(s, tex_unit, colour);
   splat.do_lifecycle_timed = true;
   splat.time_alive_left = 30.0f; // long splat
+  splat.render_layer = RenderLayer::Ground;
+  splat.do_render_static = true;
 
   splat.pos = enemy.pos;
   splat.angle_radians = fightingengine::rand_det_s(rnd.rng, 0.0f, fightingengine::PI);
@@ -0,0 +1,276 @@
+// header
+#include "opengl/render_queue.hpp"
+
+// standard lib headers
+#include <array>
+#include <cassert>
+#include <iostream>
+
+// other project headers
+#include <GL/glew.h>
+
+// engine project headers
+#include "engine/opengl/render_backend.hpp"
+#include "engine/opengl/texture.hpp"
+#include "engine/tools/profiler.hpp"
+#include "opengl/sprite_renderer.hpp"
+
+namespace game2d {
+
+namespace render_queue {
+
+static const int key_shift_layer = 56;
+static const int key_shift_depth = 40;
+static const int key_shift_shader = 32;
+static const int key_shift_texture = 24;
+static const int key_shift_blend = 16;
+
+// the bits in the key that need a flush when they change
+static const uint64_t key_state_mask = 0x0000'00FF'FFFF'0000;
+
+struct TextureArrayBinding
+{
+  unsigned int id = 0;
+  int texture_unit = 0;
+};
+
+struct render_queue_data
+{
+  std::vector<fightingengine::Shader*> shaders;
+  std::vector<TextureArrayBinding> textures;
+
+  std::vector<DrawItem> items;
+  std::vector<DrawItem> scratch;
+
+  // stats
+  int submitted = 0;
+  int batches = 0;
+  int state_changes = 0;
+  int state_changes_unsorted = 0;
+};
+static render_queue_data s_data;
+
+static int
+count_state_changes(const std::vector<DrawItem>& items)
+{
+  int changes = 0;
+  for (int i = 1; i < items.size(); i++) {
+    if ((items[i].key & key_state_mask) != (items[i - 1].key & key_state_mask))
+      changes += 1;
+  }
+  return changes;
+}
+
+static void
+set_blend_mode(BlendMode blend)
+{
+  switch (blend) {
+    case BlendMode::Additive:
+      fightingengine::get_render_backend().set_blend_func(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+    case BlendMode::Alpha:
+    default:
+      fightingengine::get_render_backend().set_blend_func(
+        GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+      break;
+  }
+}
+
+uint64_t
+make_key(RenderLayer layer, uint16_t depth, uint8_t shader, uint8_t texture, BlendMode blend)
+{
+  uint64_t key = 0;
+  key |= static_cast<uint64_t>(static_cast<uint8_t>(layer)) << key_shift_layer;
+  key |= static_cast<uint64_t>(depth) << key_shift_depth;
+  key |= static_cast<uint64_t>(shader) << key_shift_shader;
+  key |= static_cast<uint64_t>(texture) << key_shift_texture;
+  key |= static_cast<uint64_t>(static_cast<uint8_t>(blend)) << key_shift_blend;
+  return key;
+}
+
+uint16_t
+depth_from_y(float y)
+{
+  const float depth = y + 32768.0f;
+  if (depth <= 0.0f)
+    return 0;
+  if (depth >= 65535.0f)
+    return 65535;
+  return static_cast<uint16_t>(depth);
+}
+
+uint8_t
+register_shader(fightingengine::Shader& shader)
+{
+  assert(s_data.shaders.size() < 256); // ids are 8 bits in the key
+  s_data.shaders.push_back(&shader);
+  return static_cast<uint8_t>(s_data.shaders.size() - 1);
+}
+
+uint8_t
+register_texture_array(unsigned int id, int texture_unit)
+{
+  assert(s_data.textures.size() < 256); // ids are 8 bits in the key
+  TextureArrayBinding binding;
+  binding.id = id;
+  binding.texture_unit = texture_unit;
+  s_data.textures.push_back(binding);
+  return static_cast<uint8_t>(s_data.textures.size() - 1);
+}
+
+void
+reset_stats()
+{
+  s_data.submitted = 0;
+  s_data.batches = 0;
+  s_data.state_changes = 0;
+  s_data.state_changes_unsorted = 0;
+}
+int
+get_submitted()
+{
+  return s_data.submitted;
+}
+int
+get_batches()
+{
+  return s_data.batches;
+}
+int
+get_state_changes()
+{
+  return s_data.state_changes;
+}
+int
+get_state_changes_avoided()
+{
+  int avoided = s_data.state_changes_unsorted - s_data.state_changes;
+  return avoided > 0 ? avoided : 0;
+}
+
+void
+begin_frame()
+{
+  s_data.items.clear();
+}
+
+void
+submit(const GameObject2D& go,
+       const glm::vec2 draw_size,
+       uint8_t shader,
+       uint8_t texture,
+       BlendMode blend)
+{
+  // checked here so drain() never has to give up half way through a batch
+  if (shader >= s_data.shaders.size() || texture >= s_data.textures.size()) {
+    std::cerr << "render_queue: draw submitted with unregistered shader or texture" << std::endl;
+    return;
+  }
+
+  DrawItem item;
+  item.key = make_key(go.render_layer, depth_from_y(go.pos.y), shader, texture, blend);
+  item.go = &go;
+  item.draw_size = draw_size;
+  s_data.items.push_back(item);
+  s_data.submitted += 1;
+}
+
+void
+radix_sort(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch)
+{
+  const size_t n = items.size();
+  if (n < 2)
+    return;
+  scratch.resize(n);
+
+  for (int pass = 0; pass < 8; pass++) {
+    const int shift = pass * 8;
+
+    std::array<size_t, 256> count{};
+    for (const DrawItem& item : items)
+      count[(item.key >> shift) & 0xFF] += 1;
+
+    // every key has the same digit, this pass would not move anything
+    if (count[(items[0].key >> shift) & 0xFF] == n)
+      continue;
+
+    size_t offset = 0;
+    for (size_t& c : count) {
+      size_t bucket = c;
+      c = offset;
+      offset += bucket;
+    }
+
+    for (const DrawItem& item : items)
+      scratch[count[(item.key >> shift) & 0xFF]++] = item;
+
+    items.swap(scratch);
+  }
+}
+
+void
+sort()
+{
+  PROFILE_ZONE("render_queue::sort");
+  s_data.state_changes_unsorted += count_state_changes(s_data.items);
+  radix_sort(s_data.items, s_data.scratch);
+}
+
+void
+drain(const GameObject2D& cam,
+      const glm::ivec2& screen_size,
+      fightingengine::Shader* debug_line_shader,
+      const glm::vec4& debug_line_colour)
+{
+  if (s_data.items.empty())
+    return;
+  PROFILE_ZONE("render_queue::drain");
+
+  uint64_t current_state = 0;
+  fightingengine::Shader* shader = nullptr;
+
+  for (int i = 0; i < s_data.items.size(); i++) {
+    const DrawItem& item = s_data.items[i];
+    const uint64_t state = item.key & key_state_mask;
+
+    if (i == 0 || state != current_state) {
+      if (i != 0) {
+        sprite_renderer::end_batch();
+        sprite_renderer::flush(*shader);
+        s_data.state_changes += 1;
+      }
+      current_state = state;
+
+      const uint8_t shader_id = (state >> key_shift_shader) & 0xFF;
+      const uint8_t texture_id = (state >> key_shift_texture) & 0xFF;
+      const BlendMode blend = static_cast<BlendMode>((state >> key_shift_blend) & 0xFF);
+
+      assert(shader_id < s_data.shaders.size() && texture_id < s_data.textures.size());
+      const TextureArrayBinding& texture = s_data.textures[texture_id];
+      shader = s_data.shaders[shader_id];
+      shader->bind();
+      shader->set_int("tex", texture.texture_unit);
+      fightingengine::bind_tex_array(texture.id, texture.texture_unit);
+      set_blend_mode(blend);
+
+      sprite_renderer::begin_batch();
+      s_data.batches += 1;
+    }
+
+    if (debug_line_shader != nullptr)
+      sprite_renderer::draw_sprite_debug(
+        cam, screen_size, *shader, *item.go, item.draw_size, *debug_line_shader, debug_line_colour);
+    else
+      sprite_renderer::draw_instanced_sprite(cam, screen_size, *shader, *item.go, item.draw_size);
+  }
+
+  sprite_renderer::end_batch();
+  sprite_renderer::flush(*shader);
+
+  // leave the default blend mode for anything drawn after the queue
+  set_blend_mode(BlendMode::Alpha);
+}
+
+} // namespace render_queue
+
+} // namespace game2d
@@ -0,0 +1,94 @@
+#pragma once
+
+// c++ standard lib headers
+#include <cstdint>
+#include <vector>
+
+// other project headers
+#include <glm/glm.hpp>
+
+// your project headers
+#include "2d_game_object.hpp"
+#include "engine/opengl/shader.hpp"
+
+namespace game2d {
+
+enum class BlendMode : uint8_t
+{
+  Alpha = 0,
+  Additive = 1,
+};
+
+namespace render_queue {
+
+//
+// Sort-keyed render queue.
+// Every submission gets a 64 bit key, the queue is radix sorted once a frame,
+// then drained in to the sprite_renderer, only flushing when the state changes.
+//
+// key layout (msb -> lsb)
+// | layer 8 | depth 16 | shader 8 | texture 8 | blend 8 | unused 16 |
+//
+// depth is the sprite's y, so within a layer sprites lower down draw over the ones above them.
+//
+
+struct DrawItem
+{
+  uint64_t key = 0;
+  const GameObject2D* go = nullptr;
+  glm::vec2 draw_size = { 0.0f, 0.0f };
+};
+
+[[nodiscard]] uint64_t
+make_key(RenderLayer layer, uint16_t depth, uint8_t shader, uint8_t texture, BlendMode blend);
+
+// y in world space to the depth bits. y is clamped to +-32768, a pixel a step
+[[nodiscard]] uint16_t
+depth_from_y(float y);
+
+// register state once at startup, the returned ids are used in submit()
+[[nodiscard]] uint8_t
+register_shader(fightingengine::Shader& shader);
+[[nodiscard]] uint8_t
+register_texture_array(unsigned int id, int texture_unit);
+
+void
+reset_stats();
+int
+get_submitted();
+int
+get_batches();
+int
+get_state_changes();
+int
+get_state_changes_avoided();
+
+void
+begin_frame();
+
+// draws with a shader or texture that was never registered are dropped with an error
+void
+submit(const GameObject2D& go,
+       const glm::vec2 draw_size,
+       uint8_t shader,
+       uint8_t texture,
+       BlendMode blend = BlendMode::Alpha);
+
+// stable LSD radix sort on the key, 8 bits a pass.
+// passes where every key has the same digit are skipped.
+void
+radix_sort(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch);
+
+void
+sort();
+
+// debug_line_shader is optional, if set the physics box of each sprite is drawn.
+void
+drain(const GameObject2D& cam,
+      const glm::ivec2& screen_size,
+      fightingengine::Shader* debug_line_shader = nullptr,
+      const glm::vec4& debug_line_colour = glm::vec4(1.0f));
+
+} // namespace render_queue
+
+} // namespace game2d
@@ -4,6 +4,7 @@
 
 // standard lib headers
 #include <array>
+#include <cassert>
 #include <iostream>
 
 // other project headers
@@ -12,7 +13,9 @@
 
 // engine project headers
 #include "engine/maths_core.hpp"
+#include "engine/opengl/render_backend.hpp"
 #include "engine/opengl/util.hpp"
+#include "engine/tools/profiler.hpp"
 using namespace fightingengine; // used for opengl macro
 #include "2d_game_object.hpp"
 #include "spritemap.hpp"
@@ -25,18 +28,6 @@ namespace sprite_renderer {
 // V2 Renderer (Dynamic Batched Draw Calls)
 //
 
-struct Vertex
-{
-  glm::vec4 pos_and_tex;
-  glm::vec4 colour;
-  glm::vec2 sprite_pos;
-  glm::mat4 model;
-};
-
-static const size_t max_quad = 5000;
-static const size_t max_quad_vert_count = max_quad * 4;
-static const size_t max_quad_index_count = max_quad * 6;
-
 struct renderer_data
 {
   unsigned int VAO = 0;
@@ -45,6 +36,10 @@ struct renderer_data
 
   uint32_t index_count = 0;
 
+  // the 4 corners of a physics box, in clip space
+  unsigned int debug_line_VAO = 0;
+  unsigned int debug_line_VBO = 0;
+
   Vertex* buffer;
   Vertex* buffer_ptr;
 
@@ -72,41 +67,104 @@ get_quad_count()
 }
 
 void
-init()
+set_vertex_attributes()
 {
-  s_data.buffer = new Vertex[max_quad_vert_count];
+  RenderBackend& backend = get_render_backend();
+  backend.vertex_attrib_float(0, 4, sizeof(Vertex), offsetof(Vertex, pos_and_tex));
+  backend.vertex_attrib_float(1, 4, sizeof(Vertex), offsetof(Vertex, colour));
+  backend.vertex_attrib_float(2, 2, sizeof(Vertex), offsetof(Vertex, sprite_pos));
+  // a mat4 is 4 vec4 attributes
+  backend.vertex_attrib_float(3, 4, sizeof(Vertex), offsetof(Vertex, model) + 0 * sizeof(glm::vec4));
+  backend.vertex_attrib_float(4, 4, sizeof(Vertex), offsetof(Vertex, model) + 1 * sizeof(glm::vec4));
+  backend.vertex_attrib_float(5, 4, sizeof(Vertex), offsetof(Vertex, model) + 2 * sizeof(glm::vec4));
+  backend.vertex_attrib_float(6, 4, sizeof(Vertex), offsetof(Vertex, model) + 3 * sizeof(glm::vec4));
+  backend.vertex_attrib_float(7, 1, sizeof(Vertex), offsetof(Vertex, tex_slot));
+}
 
-  glGenVertexArrays(1, &s_data.VAO);
-  glGenBuffers(1, &s_data.VBO);
-  glGenBuffers(1, &s_data.EBO);
-  glBindVertexArray(s_data.VAO); // bind the vao
+unsigned int
+get_quad_index_buffer()
+{
+  return s_data.EBO;
+}
 
-  glBindBuffer(GL_ARRAY_BUFFER, s_data.VBO);
-  glBufferData(GL_ARRAY_BUFFER, max_quad_vert_count * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW); // dynamic
+std::string
+texture_layer_define()
+{
+  return "MAX_TEXTURE_LAYERS " + std::to_string(max_texture_layers);
+}
 
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos_and_tex));
+void
+write_quad(Vertex*& ptr,
+           const glm::mat4& model,
+           const glm::vec2 sprite_offset,
+           const float tex_slot,
+           const glm::vec4 colour_tl,
+           const glm::vec4 colour_tr,
+           const glm::vec4 colour_bl,
+           const glm::vec4 colour_br)
+{
+  assert(tex_slot >= 0.0f && tex_slot < static_cast<float>(max_texture_layers));
 
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, colour));
+  // tl
+  ptr->pos_and_tex = { 0.0f, 0.0f, 0.0f, 0.0f };
+  ptr->colour = colour_tl;
+  ptr->sprite_pos = sprite_offset;
+  ptr->model = model;
+  ptr->tex_slot = tex_slot;
+  ptr++;
 
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, sprite_pos));
+  // tr
+  ptr->pos_and_tex = { 1.0f, 0.0f, 1.0f, 0.0f };
+  ptr->colour = colour_tr;
+  ptr->sprite_pos = sprite_offset;
+  ptr->model = model;
+  ptr->tex_slot = tex_slot;
+  ptr++;
 
-  glEnableVertexAttribArray(3);
-  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, model));
+  // br
+  ptr->pos_and_tex = { 1.0f, 1.0f, 1.0f, 1.0f };
+  ptr->colour = colour_br;
+  ptr->sprite_pos = sprite_offset;
+  ptr->model = model;
+  ptr->tex_slot = tex_slot;
+  ptr++;
 
-  glEnableVertexAttribArray(4);
-  glVertexAttribPointer(
-    4, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, model) + 1 * sizeof(glm::vec4)));
+  // bl
+  ptr->pos_and_tex = { 0.0f, 1.0f, 0.0f, 1.0f };
+  ptr->colour = colour_bl;
+  ptr->sprite_pos = sprite_offset;
+  ptr->model = model;
+  ptr->tex_slot = tex_slot;
+  ptr++;
+}
 
-  glEnableVertexAttribArray(5);
-  glVertexAttribPointer(
-    5, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, model) + 2 * sizeof(glm::vec4)));
+glm::mat4
+sprite_model_matrix(const glm::vec2 pos, const float angle_radians, const glm::vec2 draw_size, const glm::vec2 pivot)
+{
+  glm::mat4 model = glm::mat4(1.0f);
+  model = glm::translate(model, glm::vec3(pos, 0.0f));
+  model = glm::translate(model, glm::vec3(pivot.x * draw_size.x, pivot.y * draw_size.y, 0.0f));
+  model = glm::rotate(model, angle_radians, glm::vec3(0.0f, 0.0f, 1.0f));
+  model = glm::translate(model, glm::vec3(-pivot.x * draw_size.x, -pivot.y * draw_size.y, 0.0f));
+  model = glm::scale(model, glm::vec3(draw_size, 1.0f));
+  return model;
+}
+
+void
+init()
+{
+  s_data.buffer = new Vertex[max_quad_vert_count];
 
-  glEnableVertexAttribArray(6);
-  glVertexAttribPointer(
-    6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)(offsetof(Vertex, model) + 3 * sizeof(glm::vec4)));
+  RenderBackend& backend = get_render_backend();
+  s_data.VAO = backend.create_vertex_array();
+  s_data.VBO = backend.create_buffer();
+  s_data.EBO = backend.create_buffer();
+  backend.bind_vertex_array(s_data.VAO); // bind the vao
+
+  backend.bind_buffer(GL_ARRAY_BUFFER, s_data.VBO);
+  backend.buffer_data(GL_ARRAY_BUFFER, max_quad_vert_count * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW); // dynamic
+
+  set_vertex_attributes();
 
   uint32_t indices[max_quad_index_count];
   uint32_t index_offset = 0;
@@ -122,20 +180,31 @@ init()
     index_offset += 4;
   }
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_data.EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+  backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, s_data.EBO);
+  backend.buffer_data(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+  // debug lines
+  s_data.debug_line_VAO = backend.create_vertex_array();
+  s_data.debug_line_VBO = backend.create_buffer();
+  backend.bind_vertex_array(s_data.debug_line_VAO);
+  backend.bind_buffer(GL_ARRAY_BUFFER, s_data.debug_line_VBO);
+  backend.buffer_data(GL_ARRAY_BUFFER, 4 * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+  backend.vertex_attrib_float(0, 2, sizeof(glm::vec2), 0);
 
   // unbind vbo and vao
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  backend.bind_buffer(GL_ARRAY_BUFFER, 0);
+  backend.bind_vertex_array(0);
 }
 
 void
 shutdown()
 {
-  glDeleteVertexArrays(1, &s_data.VAO);
-  glDeleteBuffers(1, &s_data.VBO);
-  glDeleteBuffers(1, &s_data.EBO);
+  RenderBackend& backend = get_render_backend();
+  backend.delete_vertex_array(s_data.VAO);
+  backend.delete_buffer(s_data.VBO);
+  backend.delete_buffer(s_data.EBO);
+  backend.delete_vertex_array(s_data.debug_line_VAO);
+  backend.delete_buffer(s_data.debug_line_VBO);
 
   delete[] s_data.buffer;
 }
@@ -145,26 +214,29 @@ end_batch()
 {
   GLsizeiptr size = (uint8_t*)s_data.buffer_ptr - (uint8_t*)s_data.buffer;
   // Set dynamic vertex buffer & upload data
-  glBindBuffer(GL_ARRAY_BUFFER, s_data.VBO);
+  RenderBackend& backend = get_render_backend();
+  backend.bind_buffer(GL_ARRAY_BUFFER, s_data.VBO);
   // glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
-  glBufferSubData(GL_ARRAY_BUFFER, 0, size, s_data.buffer);
+  backend.buffer_sub_data(GL_ARRAY_BUFFER, 0, size, s_data.buffer);
 }
 
 // submit quads for a drawcall
 void
 flush(fightingengine::Shader& shader)
 {
+  PROFILE_ZONE("sprite_renderer::flush");
   shader.bind();
 
-  glBindVertexArray(s_data.VAO);
-  glDrawElements(GL_TRIANGLES, s_data.index_count, GL_UNSIGNED_INT, nullptr);
+  RenderBackend& backend = get_render_backend();
+  backend.bind_vertex_array(s_data.VAO);
+  backend.draw_indexed_triangles(s_data.index_count);
 
   s_data.draw_calls += 1;
   s_data.index_count = 0;
 
   // unbind
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  backend.bind_buffer(GL_ARRAY_BUFFER, 0);
+  backend.bind_vertex_array(0);
 }
 
 void
@@ -205,42 +277,12 @@ draw_instanced_sprite(const GameObject2D& cam,
     return; // skip rendering
   }
 
-  glm::mat4 model = glm::mat4(1.0f);
-  model = glm::translate(model, glm::vec3(glm::vec2(worldspace_pos.x, worldspace_pos.y), 0.0f));
-  model = glm::translate(model, glm::vec3(0.5f * draw_size.x, 0.5f * draw_size.y, 0.0f));
-  model = glm::rotate(model, go.angle_radians, glm::vec3(0.0f, 0.0f, 1.0f));
-  model = glm::translate(model, glm::vec3(-0.5f * draw_size.x, -0.5f * draw_size.y, 0.0f));
-  model = glm::scale(model, glm::vec3(draw_size, 1.0f));
+  glm::vec2 pivot = sprite::spritemap::get_sprite_pivot(go.sprite);
+  glm::mat4 model = sprite_model_matrix(worldspace_pos, go.angle_radians, draw_size, pivot);
+  glm::vec2 sprite_offset = sprite::spritemap::get_sprite_offset(go.sprite);
+  const float tex_slot = static_cast<float>(go.tex_slot);
 
-  glm::ivec2 sprite_offset = sprite::spritemap::get_sprite_offset(go.sprite);
-
-  // tl
-  s_data.buffer_ptr->pos_and_tex = { 0.0f, 0.0f, 0.0f, 0.0f };
-  s_data.buffer_ptr->colour = colour_tl;
-  s_data.buffer_ptr->sprite_pos = sprite_offset;
-  s_data.buffer_ptr->model = model;
-  s_data.buffer_ptr++;
-
-  // tr
-  s_data.buffer_ptr->pos_and_tex = { 1.0f, 0.0f, 1.0f, 0.0f };
-  s_data.buffer_ptr->colour = colour_tr;
-  s_data.buffer_ptr->sprite_pos = sprite_offset;
-  s_data.buffer_ptr->model = model;
-  s_data.buffer_ptr++;
-
-  // br
-  s_data.buffer_ptr->pos_and_tex = { 1.0f, 1.0f, 1.0f, 1.0f };
-  s_data.buffer_ptr->colour = colour_br;
-  s_data.buffer_ptr->sprite_pos = sprite_offset;
-  s_data.buffer_ptr->model = model;
-  s_data.buffer_ptr++;
-
-  // bl
-  s_data.buffer_ptr->pos_and_tex = { 0.0f, 1.0f, 0.0f, 1.0f };
-  s_data.buffer_ptr->colour = colour_bl;
-  s_data.buffer_ptr->sprite_pos = sprite_offset;
-  s_data.buffer_ptr->model = model;
-  s_data.buffer_ptr++;
+  write_quad(s_data.buffer_ptr, model, sprite_offset, tex_slot, colour_tl, colour_tr, colour_bl, colour_br);
 
   s_data.index_count += 6;
   s_data.quad_vertex += 4;
@@ -257,9 +299,6 @@ draw_sprite_debug(const GameObject2D& cam,
 {
   draw_instanced_sprite(cam, screen_size, shader, game_object, draw_size);
 
-#ifdef WIN32
-#ifdef _DEBUG
-
   // draw lines
   debug_line_shader.bind();
   debug_line_shader.set_vec4("colour", debug_line_shader_colour);
@@ -272,16 +311,20 @@ draw_sprite_debug(const GameObject2D& cam,
   tr_pos.x = fightingengine::scale(tr_pos.x, 0.0f, screen_size.x, -1.0f, 1.0f);
   tr_pos.y = fightingengine::scale(tr_pos.y, 0.0f, screen_size.y, 1.0f, -1.0f);
 
-  // This API is deprecated, does not work on phones/tablets.
-  glBegin(GL_LINE_LOOP);
-  glVertex2f(bl_pos.x, bl_pos.y);
-  glVertex2f(tr_pos.x, bl_pos.y);
-  glVertex2f(tr_pos.x, tr_pos.y);
-  glVertex2f(bl_pos.x, tr_pos.y);
-  glEnd();
-
-#endif
-#endif
+  const std::array<glm::vec2, 4> corners = {
+    glm::vec2(bl_pos.x, bl_pos.y),
+    glm::vec2(tr_pos.x, bl_pos.y),
+    glm::vec2(tr_pos.x, tr_pos.y),
+    glm::vec2(bl_pos.x, tr_pos.y),
+  };
+
+  RenderBackend& backend = get_render_backend();
+  backend.bind_vertex_array(s_data.debug_line_VAO);
+  backend.bind_buffer(GL_ARRAY_BUFFER, s_data.debug_line_VBO);
+  backend.buffer_sub_data(GL_ARRAY_BUFFER, 0, sizeof(corners), corners.data());
+  backend.draw_line_loop(static_cast<unsigned int>(corners.size()));
+  backend.bind_buffer(GL_ARRAY_BUFFER, 0);
+  backend.bind_vertex_array(0);
 }
 
 } // namespace sprite_renderer
@@ -1,5 +1,8 @@
 #pragma once
 
+// standard lib headers
+#include <string>
+
 // other project headers
 #include <glm/glm.hpp>
 
@@ -15,6 +18,53 @@ namespace sprite_renderer {
 // V2 Renderer (Batched Draw Calls)
 //
 
+struct Vertex
+{
+  glm::vec4 pos_and_tex;
+  glm::vec4 colour;
+  glm::vec2 sprite_pos;
+  glm::mat4 model;
+  float tex_slot; // layer in the bound texture array
+};
+
+// the most sheets the sprite texture array can hold. sizes the tex_uv_scale and tex_cells
+// uniform arrays, the shader gets it as MAX_TEXTURE_LAYERS (see texture_layer_define())
+static const int max_texture_layers = 8;
+
+static const size_t max_quad = 5000;
+static const size_t max_quad_vert_count = max_quad * 4;
+static const size_t max_quad_index_count = max_quad * 6;
+
+// "MAX_TEXTURE_LAYERS 8", for the defines of shaders that sample the sprite texture array
+[[nodiscard]] std::string
+texture_layer_define();
+
+// sets up the Vertex attributes on the currently bound vao & vbo
+void
+set_vertex_attributes();
+
+// index buffer for max_quad quads, shared with anything using the Vertex layout
+[[nodiscard]] unsigned int
+get_quad_index_buffer();
+
+// writes the 4 vertices of one quad, and advances ptr
+void
+write_quad(Vertex*& ptr,
+           const glm::mat4& model,
+           const glm::vec2 sprite_offset,
+           const float tex_slot,
+           const glm::vec4 colour_tl,
+           const glm::vec4 colour_tr,
+           const glm::vec4 colour_bl,
+           const glm::vec4 colour_br);
+
+// model matrix for a sprite drawn at pos, rotated around pivot (0-1 across the sprite)
+[[nodiscard]] glm::mat4
+sprite_model_matrix(const glm::vec2 pos,
+                    const float angle_radians,
+                    const glm::vec2 draw_size,
+                    const glm::vec2 pivot = glm::vec2(0.5f));
+
 void
 reset_stats();
 int
@@ -52,6 +102,8 @@ draw_instanced_sprite(const GameObject2D& cam,
                       const glm::vec4 colour_bl,
                       const glm::vec4 colour_br);
 
+// draws the sprite, then its physics box as a line loop with debug_line_shader.
+// the box is drawn straight away, the sprite when the batch is flushed.
 void
 draw_sprite_debug(const GameObject2D& cam,
                   const glm::ivec2& screen_size,
@@ -0,0 +1,239 @@
+// header
+#include "opengl/static_sprite_layer.hpp"
+
+// standard lib headers
+#include <algorithm>
+
+// other project headers
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+// engine project headers
+#include "engine/grid.hpp"
+#include "engine/opengl/render_backend.hpp"
+#include "opengl/sprite_renderer.hpp"
+#include "spritemap.hpp"
+
+namespace game2d {
+
+namespace static_sprite_layer {
+
+static uint64_t
+chunk_key(const glm::ivec2& chunk)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(chunk.x)) << 32) | static_cast<uint32_t>(chunk.y);
+}
+
+static void
+delete_buffer(StaticBuffer& buffer)
+{
+  fightingengine::RenderBackend& backend = fightingengine::get_render_backend();
+  backend.delete_vertex_array(buffer.VAO);
+  backend.delete_buffer(buffer.VBO);
+}
+
+static void
+upload_buffer(StaticBuffer& buffer, const std::vector<sprite_renderer::Vertex>& vertices)
+{
+  fightingengine::RenderBackend& backend = fightingengine::get_render_backend();
+  if (buffer.VAO == 0) {
+    buffer.VAO = backend.create_vertex_array();
+    buffer.VBO = backend.create_buffer();
+    backend.bind_vertex_array(buffer.VAO);
+    backend.bind_buffer(GL_ARRAY_BUFFER, buffer.VBO);
+    sprite_renderer::set_vertex_attributes();
+    backend.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, sprite_renderer::get_quad_index_buffer());
+    backend.bind_vertex_array(0);
+  }
+
+  const int quads = static_cast<int>(vertices.size() / 4);
+  backend.bind_buffer(GL_ARRAY_BUFFER, buffer.VBO);
+  if (quads > buffer.vbo_quad_capacity) {
+    // grow in powers of 2, so a chunk filling up with splats doesn't realloc every time
+    buffer.vbo_quad_capacity = std::max(quads, buffer.vbo_quad_capacity * 2);
+    buffer.vbo_quad_capacity = std::min(buffer.vbo_quad_capacity, static_cast<int>(sprite_renderer::max_quad));
+    backend.buffer_data(
+      GL_ARRAY_BUFFER, buffer.vbo_quad_capacity * 4 * sizeof(sprite_renderer::Vertex), nullptr, GL_STATIC_DRAW);
+  }
+  backend.buffer_sub_data(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(sprite_renderer::Vertex), vertices.data());
+  backend.bind_buffer(GL_ARRAY_BUFFER, 0);
+
+  buffer.quad_count = quads;
+}
+
+static void
+rebuild_chunk(StaticChunk& chunk)
+{
+  const int quads = static_cast<int>(chunk.sprites.size());
+  const int max_quad = static_cast<int>(sprite_renderer::max_quad);
+
+  // the index buffer only covers max_quad quads, so big chunks get a buffer per max_quad sprites
+  const size_t buffer_count = (quads + max_quad - 1) / max_quad;
+  for (size_t i = buffer_count; i < chunk.buffers.size(); i++)
+    delete_buffer(chunk.buffers[i]);
+  chunk.buffers.resize(buffer_count);
+
+  std::vector<sprite_renderer::Vertex> vertices;
+  for (size_t b = 0; b < buffer_count; b++) {
+    const int first = static_cast<int>(b) * max_quad;
+    const int last = std::min(quads, first + max_quad);
+
+    vertices.resize((last - first) * 4);
+    sprite_renderer::Vertex* ptr = vertices.data();
+    for (int i = first; i < last; i++) {
+      const StaticSprite& s = chunk.sprites[i];
+      // baked in worldspace, the camera is applied by the view uniform
+      glm::vec2 pivot = sprite::spritemap::get_sprite_pivot(s.sprite);
+      glm::mat4 model = sprite_renderer::sprite_model_matrix(s.pos, s.angle_radians, s.render_size, pivot);
+      glm::vec2 sprite_offset = sprite::spritemap::get_sprite_offset(s.sprite);
+      sprite_renderer::write_quad(
+        ptr, model, sprite_offset, static_cast<float>(s.tex_slot), s.colour, s.colour, s.colour, s.colour);
+    }
+    upload_buffer(chunk.buffers[b], vertices);
+  }
+
+  // removes only ever left the bounds too big, shrink them back to the sprites
+  if (quads > 0) {
+    chunk.bounds_tl = chunk.sprites[0].pos;
+    chunk.bounds_br = chunk.sprites[0].pos + chunk.sprites[0].render_size;
+    for (const StaticSprite& s : chunk.sprites) {
+      chunk.bounds_tl = glm::min(chunk.bounds_tl, s.pos);
+      chunk.bounds_br = glm::max(chunk.bounds_br, s.pos + s.render_size);
+    }
+  }
+
+  chunk.dirty = false;
+}
+
+void
+add(StaticLayer& layer, const GameObject2D& go)
+{
+  if (contains(layer, go.id))
+    return;
+
+  StaticSprite s;
+  s.id = go.id;
+  s.tex_slot = go.tex_slot;
+  s.sprite = go.sprite;
+  s.pos = go.pos;
+  s.render_size = go.render_size;
+  s.angle_radians = go.angle_radians;
+  s.colour = go.colour;
+
+  uint64_t key = chunk_key(grid::convert_world_space_to_grid_space(go.pos, layer.chunk_size));
+  StaticChunk& chunk = layer.chunks[key];
+  if (chunk.sprites.empty()) {
+    chunk.bounds_tl = s.pos;
+    chunk.bounds_br = s.pos + s.render_size;
+  } else {
+    chunk.bounds_tl = glm::min(chunk.bounds_tl, s.pos);
+    chunk.bounds_br = glm::max(chunk.bounds_br, s.pos + s.render_size);
+  }
+  chunk.sprites.push_back(s);
+  chunk.dirty = true;
+
+  layer.id_to_chunk[go.id] = key;
+}
+
+void
+remove(StaticLayer& layer, uint32_t id)
+{
+  auto it = layer.id_to_chunk.find(id);
+  if (it == layer.id_to_chunk.end())
+    return;
+
+  auto chunk_it = layer.chunks.find(it->second);
+  layer.id_to_chunk.erase(it);
+  if (chunk_it == layer.chunks.end())
+    return;
+
+  StaticChunk& chunk = chunk_it->second;
+  chunk.sprites.erase(std::remove_if(chunk.sprites.begin(),
+                                     chunk.sprites.end(),
+                                     [&id](const StaticSprite& s) { return s.id == id; }),
+                      chunk.sprites.end());
+  chunk.dirty = true;
+
+  // splats expire all over the world, so empty chunks can't be kept around
+  if (chunk.sprites.empty()) {
+    for (StaticBuffer& buffer : chunk.buffers)
+      delete_buffer(buffer);
+    layer.chunks.erase(chunk_it);
+  }
+}
+
+bool
+contains(const StaticLayer& layer, uint32_t id)
+{
+  return layer.id_to_chunk.find(id) != layer.id_to_chunk.end();
+}
+
+void
+sync(StaticLayer& layer, const std::vector<GameObject2D>& objs)
+{
+  for (const GameObject2D& obj : objs) {
+    if (!obj.do_render_static)
+      continue;
+    if (obj.flag_for_delete)
+      remove(layer, obj.id);
+    else if (obj.do_render)
+      add(layer, obj);
+  }
+}
+
+void
+draw(StaticLayer& layer,
+     const GameObject2D& cam,
+     const glm::ivec2& screen_size,
+     fightingengine::Shader& shader,
+     const fightingengine::TextureArray& tex)
+{
+  fightingengine::RenderBackend& backend = fightingengine::get_render_backend();
+  layer.chunks_drawn = 0;
+  layer.chunks_rebuilt = 0;
+
+  glm::vec2 cam_tl = cam.pos;
+  glm::vec2 cam_br = cam.pos + glm::vec2(screen_size);
+
+  shader.bind();
+  shader.set_int("tex", tex.texture_unit);
+  shader.set_mat4("view", glm::translate(glm::mat4(1.0f), glm::vec3(-cam.pos, 0.0f)));
+  fightingengine::bind_tex_array(tex.id, tex.texture_unit);
+
+  for (auto& kv : layer.chunks) {
+    StaticChunk& chunk = kv.second;
+    bool off_screen = chunk.bounds_br.x < cam_tl.x || chunk.bounds_br.y < cam_tl.y || chunk.bounds_tl.x > cam_br.x ||
+                      chunk.bounds_tl.y > cam_br.y;
+    if (off_screen)
+      continue;
+
+    if (chunk.dirty) {
+      rebuild_chunk(chunk);
+      layer.chunks_rebuilt += 1;
+    }
+
+    for (const StaticBuffer& buffer : chunk.buffers) {
+      backend.bind_vertex_array(buffer.VAO);
+      backend.draw_indexed_triangles(buffer.quad_count * 6);
+    }
+    layer.chunks_drawn += 1;
+  }
+  backend.bind_vertex_array(0);
+
+  shader.set_mat4("view", glm::mat4(1.0f));
+}
+
+void
+shutdown(StaticLayer& layer)
+{
+  for (auto& kv : layer.chunks) {
+    for (StaticBuffer& buffer : kv.second.buffers)
+      delete_buffer(buffer);
+  }
+  layer.chunks.clear();
+  layer.id_to_chunk.clear();
+}
+
+} // namespace static_sprite_layer
+
+} // namespace game2d
@@ -0,0 +1,100 @@
+#pragma once
+
+// c++ standard lib headers
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// other project headers
+#include <glm/glm.hpp>
+
+// your project headers
+#include "2d_game_object.hpp"
+#include "engine/opengl/shader.hpp"
+#include "engine/opengl/texture.hpp"
+
+namespace game2d {
+
+namespace static_sprite_layer {
+
+//
+// Sprites that never move (trees, death splats) are baked in to a vbo per world chunk.
+// A chunk is only rebuilt when a sprite is added or removed,
+// and is drawn with one draw call when it is on screen.
+// Chunks with more than max_quad sprites are split over several buffers, a draw call each.
+// A chunk is freed, with its buffers, when its last sprite is removed.
+//
+
+struct StaticSprite
+{
+  uint32_t id = 0;
+  int tex_slot = 0;
+  sprite::type sprite = sprite::type::EMPTY;
+  glm::vec2 pos = { 0.0f, 0.0f };
+  glm::vec2 render_size = { 0.0f, 0.0f };
+  float angle_radians = 0.0f;
+  glm::vec4 colour = { 1.0f, 1.0f, 1.0f, 1.0f };
+};
+
+// up to max_quad quads of a chunk
+struct StaticBuffer
+{
+  unsigned int VAO = 0;
+  unsigned int VBO = 0;
+  int vbo_quad_capacity = 0;
+  int quad_count = 0;
+};
+
+struct StaticChunk
+{
+  std::vector<StaticBuffer> buffers;
+  bool dirty = true;
+
+  // worldspace bounds of every sprite in the chunk, sprites can overhang the chunk.
+  // grown on add, recomputed on rebuild
+  glm::vec2 bounds_tl = { 0.0f, 0.0f };
+  glm::vec2 bounds_br = { 0.0f, 0.0f };
+
+  std::vector<StaticSprite> sprites;
+};
+
+struct StaticLayer
+{
+  int chunk_size = 512;
+  std::unordered_map<uint64_t, StaticChunk> chunks;
+  std::unordered_map<uint32_t, uint64_t> id_to_chunk;
+
+  // stats
+  int chunks_drawn = 0;
+  int chunks_rebuilt = 0;
+};
+
+void
+add(StaticLayer& layer, const GameObject2D& go);
+
+void
+remove(StaticLayer& layer, uint32_t id);
+
+[[nodiscard]] bool
+contains(const StaticLayer& layer, uint32_t id);
+
+// adds new do_render_static objects, and removes ones flagged for delete.
+// call before the objects are erased.
+void
+sync(StaticLayer& layer, const std::vector<GameObject2D>& objs);
+
+// rebuilds dirty chunks on screen, then draws them.
+// the shader's view is set to the camera while drawing, and reset to identity after.
+void
+draw(StaticLayer& layer,
+     const GameObject2D& cam,
+     const glm::ivec2& screen_size,
+     fightingengine::Shader& shader,
+     const fightingengine::TextureArray& tex);
+
+void
+shutdown(StaticLayer& layer);
+
+} // namespace static_sprite_layer
+
+} // namespace game2d
@@ -0,0 +1,187 @@
+// header
+#include "spritemap.hpp"
+
+// standard lib
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// other proj headers
+#include "thirdparty/magic_enum.hpp"
+
+namespace game2d {
+
+namespace sprite {
+
+//
+// Atlas file layout (little endian)
+//
+// char[4]   magic "ATLS"
+// uint32_t  version
+// int32_t   sheet width, sheet height (pixels)
+// int32_t   cell width, cell height (pixels)
+// uint32_t  sprite count
+// per sprite:
+//   uint16_t  name length, then the name (no null terminator)
+//   int32_t   x, y (cells)
+//   float     pivot x, pivot y
+//   float     rotation offset (radians)
+//
+
+static const char atlas_magic[4] = { 'A', 'T', 'L', 'S' };
+static const uint32_t atlas_version = 1;
+
+template<typename T>
+static void
+write_value(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool
+read_value(std::ifstream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return in.good();
+}
+
+Atlas
+make_kennynl_atlas()
+{
+  Atlas atlas;
+  atlas.sheet_size = { 768, 352 };
+  atlas.cell_size = { 16, 16 };
+  atlas.cells.assign(kennynl_table.begin(), kennynl_table.end());
+  for (size_t i = 0; i < type_count; i++)
+    atlas.names.push_back(std::string(magic_enum::enum_name(static_cast<type>(i))));
+  return atlas;
+}
+
+bool
+load_atlas(const std::string& path, Atlas& atlas)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    std::cerr << "atlas: could not open " << path << std::endl;
+    return false;
+  }
+
+  char magic[4];
+  uint32_t version = 0;
+  in.read(magic, 4);
+  if (!in.good() || std::memcmp(magic, atlas_magic, 4) != 0 || !read_value(in, version) ||
+      version != atlas_version) {
+    std::cerr << "atlas: " << path << " is not a v" << atlas_version << " atlas file" << std::endl;
+    return false;
+  }
+
+  Atlas result;
+  uint32_t count = 0;
+  bool ok = read_value(in, result.sheet_size.x) && read_value(in, result.sheet_size.y) &&
+            read_value(in, result.cell_size.x) && read_value(in, result.cell_size.y) && read_value(in, count);
+  if (!ok || result.cell_size.x <= 0 || result.cell_size.y <= 0) {
+    std::cerr << "atlas: bad header in " << path << std::endl;
+    return false;
+  }
+
+  // every sprite::type has a slot, the file has to fill all of them
+  result.cells.resize(type_count);
+  result.names.resize(type_count);
+  for (size_t i = 0; i < type_count; i++)
+    result.names[i] = std::string(magic_enum::enum_name(static_cast<type>(i)));
+  std::vector<bool> found(type_count, false);
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint16_t name_length = 0;
+    if (!read_value(in, name_length)) {
+      std::cerr << "atlas: truncated file " << path << std::endl;
+      return false;
+    }
+    std::string name(name_length, '\0');
+    in.read(name.data(), name_length);
+
+    SpriteCell cell;
+    ok = in.good() && read_value(in, cell.x) && read_value(in, cell.y) && read_value(in, cell.pivot_x) &&
+         read_value(in, cell.pivot_y) && read_value(in, cell.rotation);
+    if (!ok) {
+      std::cerr << "atlas: truncated file " << path << std::endl;
+      return false;
+    }
+
+    auto t = magic_enum::enum_cast<type>(name);
+    if (t.has_value() && t.value() != type::COUNT) {
+      result.cells[index(t.value())] = cell;
+      found[index(t.value())] = true;
+    } else {
+      result.cells.push_back(cell);
+      result.names.push_back(name);
+    }
+  }
+
+  // a missing type would silently draw cell 0, 0
+  for (size_t i = 0; i < type_count; i++) {
+    if (!found[i]) {
+      std::cerr << "atlas: " << path << " has no sprite " << result.names[i] << std::endl;
+      return false;
+    }
+  }
+
+  atlas = std::move(result);
+  return true;
+}
+
+bool
+save_atlas(const std::string& path, const Atlas& atlas)
+{
+  std::ofstream out(path, std::ios::binary);
+  if (!out.is_open()) {
+    std::cerr << "atlas: could not write " << path << std::endl;
+    return false;
+  }
+
+  out.write(atlas_magic, 4);
+  write_value(out, atlas_version);
+  write_value(out, atlas.sheet_size.x);
+  write_value(out, atlas.sheet_size.y);
+  write_value(out, atlas.cell_size.x);
+  write_value(out, atlas.cell_size.y);
+  write_value(out, static_cast<uint32_t>(atlas.cells.size()));
+
+  for (size_t i = 0; i < atlas.cells.size(); i++) {
+    const std::string& name = atlas.names[i];
+    const SpriteCell& cell = atlas.cells[i];
+    write_value(out, static_cast<uint16_t>(name.size()));
+    out.write(name.data(), name.size());
+    write_value(out, cell.x);
+    write_value(out, cell.y);
+    write_value(out, cell.pivot_x);
+    write_value(out, cell.pivot_y);
+    write_value(out, cell.rotation);
+  }
+
+  return out.good();
+}
+
+glm::vec2
+atlas_grid(const Atlas& atlas)
+{
+  if (atlas.cell_size.x <= 0 || atlas.cell_size.y <= 0)
+    return { 1.0f, 1.0f };
+  return glm::vec2(atlas.sheet_size) / glm::vec2(atlas.cell_size);
+}
+
+int
+find_sprite(const Atlas& atlas, const std::string& name)
+{
+  for (int i = 0; i < atlas.names.size(); i++) {
+    if (atlas.names[i] == name)
+      return i;
+  }
+  return -1;
+}
+
+} // namespace sprite
+
+} // namespace game2d
@@ -1,8 +1,8 @@
 #pragma once
 
 // standard lib
-#include <map>
-#include <stdexcept>
+#include <array>
+#include <string>
 #include <vector>
 
 // other proj headers
@@ -75,107 +75,165 @@ enum class type
   SPACE_VEHICLE_3,
   FIREWORK,
   ROCKET_1,
-  ROCKET_2
+  ROCKET_2,
+
+  COUNT
 };
 
-struct spritemap
+// where a sprite is on its sheet, in cells.
+// pivot is what the sprite rotates around, 0-1 across the sprite.
+struct SpriteCell
 {
-  static inline std::map<type, glm::ivec2>& get_locations()
-  {
-    static std::map<type, glm::ivec2> ret;
-
-    // row 0
-    ret[type::EMPTY] = { 0, 0 };
-    ret[type::BUSH_0] = { 1, 0 };
-    ret[type::BUSH_1] = { 2, 0 };
-    ret[type::BUSH_2] = { 3, 0 };
-    ret[type::BUSH_3] = { 4, 0 };
-    ret[type::BUSH_4] = { 5, 0 };
-    ret[type::BUSH_5] = { 6, 0 };
-    ret[type::BUSH_6] = { 7, 0 };
-    ret[type::PERSON_0] = { 24, 0 };
-    ret[type::PERSON_1] = { 25, 0 };
-    ret[type::PERSON_2] = { 26, 0 };
-    ret[type::PERSON_3] = { 27, 0 };
-    ret[type::PERSON_4] = { 28, 0 };
-    ret[type::PERSON_5] = { 29, 0 };
-    ret[type::PERSON_6] = { 30, 0 };
-    ret[type::PERSON_7] = { 31, 0 };
-
-    // row 1
-    ret[type::TREE_1] = { 0, 1 };
-    ret[type::TREE_2] = { 1, 1 };
-    ret[type::TREE_3] = { 2, 1 };
-    ret[type::TREE_4] = { 3, 1 };
-    ret[type::TREE_5] = { 4, 1 };
-    ret[type::TREE_6] = { 5, 1 };
-    ret[type::TREE_7] = { 6, 1 };
-    ret[type::TREE_8] = { 7, 1 };
-    ret[type::CASTLE_FLOOR] = { 19, 1 };
-
-    // row 3
-    ret[type::WALL_BIG] = { 2, 3 };
-
-    // row 5
-    ret[type::SQUARE] = { 8, 5 };
-    ret[type::WEAPON_ARROW_1] = { 40, 5 };
-    ret[type::WEAPON_ARROW_2] = { 41, 5 };
-    ret[type::WEAPON_SHOVEL] = { 42, 5 };
-    ret[type::WEAPON_PICKAXE] = { 42, 5 };
-
-    // row 6
-    ret[type::ORC] = { 30, 6 };
-
-    // row 10
-    ret[type::CAMPFIRE] = { 14, 10 };
-    ret[type::FIRE] = { 15, 10 };
-
-    // row 15
-    ret[type::SKULL_AND_BONES] = { 0, 15 };
-
-    // row 19
-    ret[type::BOAT] = { 10, 19 };
-
-    // row 21
-    ret[type::SPACE_VEHICLE_1] = { 12, 21 };
-    ret[type::SPACE_VEHICLE_2] = { 13, 21 };
-    ret[type::SPACE_VEHICLE_3] = { 14, 21 };
-    ret[type::FIREWORK] = { 32, 21 };
-    ret[type::ROCKET_1] = { 33, 21 };
-    ret[type::ROCKET_2] = { 34, 21 };
-
-    return ret;
-  }
+  int x = 0;
+  int y = 0;
+  float rotation = 0.0f;
+  float pivot_x = 0.5f;
+  float pivot_y = 0.5f;
+};
 
-  static inline std::map<type, float>& get_rotations()
-  {
-    static std::map<type, float> ret;
+constexpr size_t type_count = static_cast<size_t>(type::COUNT);
+
+[[nodiscard]] constexpr size_t
+index(type t)
+{
+  return static_cast<size_t>(t);
+}
+
+// kennynl 1bit pack, monochrome_transparent_packed.png
+[[nodiscard]] constexpr std::array<SpriteCell, type_count>
+make_kennynl_table()
+{
+  std::array<SpriteCell, type_count> ret{};
+
+  // row 0
+  ret[index(type::EMPTY)] = { 0, 0 };
+  ret[index(type::BUSH_0)] = { 1, 0 };
+  ret[index(type::BUSH_1)] = { 2, 0 };
+  ret[index(type::BUSH_2)] = { 3, 0 };
+  ret[index(type::BUSH_3)] = { 4, 0 };
+  ret[index(type::BUSH_4)] = { 5, 0 };
+  ret[index(type::BUSH_5)] = { 6, 0 };
+  ret[index(type::BUSH_6)] = { 7, 0 };
+  ret[index(type::PERSON_0)] = { 24, 0 };
+  ret[index(type::PERSON_1)] = { 25, 0 };
+  ret[index(type::PERSON_2)] = { 26, 0 };
+  ret[index(type::PERSON_3)] = { 27, 0 };
+  ret[index(type::PERSON_4)] = { 28, 0 };
+  ret[index(type::PERSON_5)] = { 29, 0 };
+  ret[index(type::PERSON_6)] = { 30, 0 };
+  ret[index(type::PERSON_7)] = { 31, 0 };
+
+  // row 1
+  ret[index(type::TREE_1)] = { 0, 1 };
+  ret[index(type::TREE_2)] = { 1, 1 };
+  ret[index(type::TREE_3)] = { 2, 1 };
+  ret[index(type::TREE_4)] = { 3, 1 };
+  ret[index(type::TREE_5)] = { 4, 1 };
+  ret[index(type::TREE_6)] = { 5, 1 };
+  ret[index(type::TREE_7)] = { 6, 1 };
+  ret[index(type::TREE_8)] = { 7, 1 };
+  ret[index(type::CASTLE_FLOOR)] = { 19, 1 };
+
+  // row 3
+  ret[index(type::WALL_BIG)] = { 2, 3 };
+
+  // row 5
+  ret[index(type::SQUARE)] = { 8, 5 };
+  ret[index(type::WEAPON_ARROW_1)] = { 40, 5, -fightingengine::PI / 4.0f };
+  ret[index(type::WEAPON_ARROW_2)] = { 41, 5, -fightingengine::PI / 4.0f };
+  ret[index(type::WEAPON_SHOVEL)] = { 42, 5, -fightingengine::PI / 4.0f };
+  ret[index(type::WEAPON_PICKAXE)] = { 42, 5, -fightingengine::PI / 8.0f };
+
+  // row 6
+  ret[index(type::ORC)] = { 30, 6 };
+
+  // row 10
+  ret[index(type::CAMPFIRE)] = { 14, 10 };
+  ret[index(type::FIRE)] = { 15, 10 };
+
+  // row 15
+  ret[index(type::SKULL_AND_BONES)] = { 0, 15 };
+
+  // row 19
+  ret[index(type::BOAT)] = { 10, 19 };
+
+  // row 21
+  ret[index(type::SPACE_VEHICLE_1)] = { 12, 21 };
+  ret[index(type::SPACE_VEHICLE_2)] = { 13, 21 };
+  ret[index(type::SPACE_VEHICLE_3)] = { 14, 21 };
+  ret[index(type::FIREWORK)] = { 32, 21 };
+  ret[index(type::ROCKET_1)] = { 33, 21 };
+  ret[index(type::ROCKET_2)] = { 34, 21 };
+
+  return ret;
+}
 
-    // row 5
-    ret[type::SQUARE] = { 0.0f };
-    ret[type::WEAPON_ARROW_1] = { -fightingengine::PI / 4.0f };
-    ret[type::WEAPON_ARROW_2] = { -fightingengine::PI / 4.0f };
-    ret[type::WEAPON_SHOVEL] = { -fightingengine::PI / 4.0f };
-    ret[type::WEAPON_PICKAXE] = { -fightingengine::PI / 8.0f };
+inline constexpr std::array<SpriteCell, type_count> kennynl_table = make_kennynl_table();
 
-    return ret;
+// every type apart from EMPTY needs a cell that isn't 0, 0
+[[nodiscard]] constexpr bool
+table_is_complete(const std::array<SpriteCell, type_count>& table)
+{
+  for (size_t i = index(type::EMPTY) + 1; i < type_count; i++) {
+    if (table[i].x == 0 && table[i].y == 0)
+      return false;
   }
+  return true;
+}
+static_assert(table_is_complete(kennynl_table), "a sprite::type is missing from the kennynl table");
+
+// an atlas loaded at runtime. cells are indexed by sprite::type,
+// any sprites in the file without a sprite::type are added after type::COUNT.
+struct Atlas
+{
+  glm::ivec2 sheet_size = { 0, 0 };
+  glm::ivec2 cell_size = { 0, 0 };
+  std::vector<SpriteCell> cells;
+  std::vector<std::string> names;
+};
+
+[[nodiscard]] Atlas
+make_kennynl_atlas();
+
+// binary atlas file, see spritemap.cpp for the layout.
+// returns false and leaves atlas untouched if the file is missing, invalid,
+// or doesn't have a cell for every sprite::type.
+[[nodiscard]] bool
+load_atlas(const std::string& path, Atlas& atlas);
+
+[[nodiscard]] bool
+save_atlas(const std::string& path, const Atlas& atlas);
+
+// cells across and down the sheet
+[[nodiscard]] glm::vec2
+atlas_grid(const Atlas& atlas);
+
+// returns -1 if the atlas doesn't have a sprite with that name
+[[nodiscard]] int
+find_sprite(const Atlas& atlas, const std::string& name);
+
+struct spritemap
+{
+  // the atlas used by the lookups below, starts as the compiled kennynl table
+  static inline Atlas active = make_kennynl_atlas();
+
+  static inline void set_active(const Atlas& atlas) { active = atlas; }
 
   static inline glm::vec2 get_sprite_offset(const type& t)
   {
-    auto& tiles = get_locations();
-
-    return tiles[t];
+    const SpriteCell& cell = active.cells[index(t)];
+    return { cell.x, cell.y };
   };
 
-  static inline float get_sprite_rotation_offset(const type& t)
+  static inline glm::vec2 get_sprite_pivot(const type& t)
   {
-    auto& tiles = get_rotations();
-
-    return tiles[t];
+    const SpriteCell& cell = active.cells[index(t)];
+    return { cell.pivot_x, cell.pivot_y };
   };
+
+  static inline float get_sprite_rotation_offset(const type& t) { return active.cells[index(t)].rotation; };
 };
 
 } // namespace sprite
 
-} // namespace game2d
\ No newline at end of file
+} // namespace game2d
@@ -23,6 +23,7 @@
 #include "engine/opengl/render_command.hpp"
 #include "engine/opengl/renderer.hpp"
 #include "engine/opengl/shader.hpp"
+#include "engine/opengl/skinned_model.hpp"
 #include "engine/opengl/util.hpp"
 #include "engine/tools/profiler.hpp"
 #include "engine/ui/profiler_panel.hpp"
@@ -41,7 +42,7 @@ int
 main(int argc, char** argv)
 {
   std::cout << "booting up..." << std::endl;
-  const auto app_start = std::chrono::high_resolution_clock::now();
+  const auto app_start = std::chrono::steady_clock::now();
 
   uint32_t width = 1280;
   uint32_t height = 720;
@@ -89,14 +90,29 @@ main(int argc, char** argv)
   // load shaders
   //
 
-  Shader texture_shader = Shader("lit.vert", "basic_shader.frag");
+  // models are quantized (half the vertex memory), lit.vert decodes them
+  const std::vector<std::string> lit_defines = { "QUANTIZED_VERTICES" };
+
+  // compiled as one batch, and loaded from the program cache after the first run
+  std::vector<unsigned int> programs = create_opengl_shaders({
+    { "lit.vert", "basic_shader.frag", lit_defines },
+    { "lit.vert", "unlit_flat.frag", lit_defines },
+    { "lit.vert", "unlit_flat.frag", { "INSTANCED" } },
+    { "skinned.vert", "unlit_flat.frag", {} },
+  });
+
+  Shader texture_shader = Shader(programs[0]);
   texture_shader.bind();
   texture_shader.set_int("texture_diffuse1", tex_unit_player_diffuse);
 
-  Shader solid_colour = Shader("lit.vert", "unlit_flat.frag");
+  Shader solid_colour = Shader(programs[1]);
   solid_colour.bind();
   solid_colour.set_int("texture_diffuse1", tex_unit_player_diffuse);
 
+  Shader solid_colour_instanced = Shader(programs[2]);
+
+  Shader solid_colour_skinned = Shader(programs[3]);
+
   log_time_since("shaders loaded ", app_start);
 
   //
@@ -104,11 +120,33 @@ main(int argc, char** argv)
   //
 
   // Model model_1("assets/models/cyborg/cyborg.obj");
-  Model model_2("assets/models/rpg_characters_nov_2020/OBJ/Monk.obj");
-  Model model_3("assets/models/mercury/Alchemilla_02_05_2021.obj");
+  Model model_2("assets/models/rpg_characters_nov_2020/OBJ/Monk.obj", VertexLayout::Quantized);
+  Model model_3("assets/models/mercury/Alchemilla_02_05_2021.obj", VertexLayout::Quantized);
+
+  // mixamo exports one animation per file, all with the same skeleton
+  SkinnedModel arissa("assets/models/arissa_mixamo_fbx/idle.fbx");
+  arissa.add_clips("assets/models/arissa_mixamo_fbx/walking.fbx");
+  arissa.add_clips("assets/models/arissa_mixamo_fbx/running.fbx");
 
   log_time_since("models loaded ", app_start);
 
+  //
+  // animated characters
+  //
+
+  const int arissa_rows = 4;
+  std::vector<animation::AnimationState> arissa_states;
+  std::vector<glm::mat4> arissa_transforms;
+  for (int i = 0; i < arissa_rows * arissa_rows; i++) {
+    const uint32_t clip = arissa.get_clips().empty() ? 0 : i % arissa.get_clips().size();
+    animation::AnimationState state = arissa.create_state(clip);
+    state.time = rand_det_s(rnd.rng, 0.0f, 1.0f); // out of step with each other
+    arissa_states.push_back(state);
+
+    glm::vec3 pos = glm::vec3(-4.0f - 1.5f * (i / arissa_rows), 0.0f, 1.5f * (i % arissa_rows));
+    arissa_transforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(0.01f))); // cm
+  }
+
   //
   // enemies
   //
@@ -131,6 +169,13 @@ main(int argc, char** argv)
     }
   }
 
+  // the cubes don't move, so their transforms are built once and drawn in one instanced call
+  Mesh cube = create_cube_mesh();
+  std::vector<glm::mat4> cube_transforms;
+  cube_transforms.reserve(cube_pos.size());
+  for (const glm::vec3& pos : cube_pos)
+    cube_transforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(0.25f)));
+
   // App
 
   while (app.is_running()) {
@@ -155,7 +200,7 @@ main(int argc, char** argv)
     }
 
     if (app.get_input().get_key_down(SDL_SCANCODE_R)) {
-      reload_shader_program(&texture_shader.ID, "lit.vert", "basic_shader.frag");
+      reload_shader_program(&texture_shader.ID, "lit.vert", "basic_shader.frag", lit_defines);
     }
 
     profiler.end(Profiler::Stage::SdlInput);
@@ -189,6 +234,9 @@ main(int argc, char** argv)
 
     camera.update(delta_time_s);
 
+    // poses are sampled and palettes built on the worker threads
+    arissa.update(arissa_states, delta_time_s);
+
     profiler.end(Profiler::Stage::GameTick);
     profiler.begin(Profiler::Stage::Render);
     //
@@ -227,6 +275,18 @@ main(int argc, char** argv)
     // soli_dcolour.set_vec3("viewPos")
     model_3.draw(solid_colour);
 
+    solid_colour_instanced.bind();
+    solid_colour_instanced.set_mat4("view_projection", view_projection);
+    solid_colour_instanced.set_vec3("light_colour", glm::vec3(0.1f, 0.1f, 0.1f));
+    solid_colour_instanced.set_vec3("object_colour", glm::vec3(0.1f, 0.1f, 1.0f));
+    cube.draw_instanced(solid_colour_instanced, cube_transforms);
+
+    solid_colour_skinned.bind();
+    solid_colour_skinned.set_mat4("view_projection", view_projection);
+    solid_colour_skinned.set_vec3("light_colour", glm::vec3(0.1f, 0.1f, 0.1f));
+    solid_colour_skinned.set_vec3("object_colour", glm::vec3(0.1f, 1.0f, 0.1f));
+    arissa.draw(solid_colour_skinned, arissa_states, arissa_transforms);
+
     profiler.end(Profiler::Stage::Render);
     profiler.begin(Profiler::Stage::GuiLoop);
     //
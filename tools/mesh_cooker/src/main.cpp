@@ -0,0 +1,115 @@
+//
+// mesh_cooker: bakes a model (anything assimp can import) in to a .mesh file.
+// usage: mesh_cooker [--quantize] <input model> [output .mesh]
+// the output defaults to the input path with a .mesh extension,
+// which Model picks up in place of the source.
+// --quantize writes 16 byte vertices and, where they fit, 16 bit indices.
+//
+
+// c++ standard library headers
+#include <filesystem> // C++17
+#include <iostream>
+#include <string>
+#include <vector>
+
+// other library headers
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+// engine headers
+#include "engine/mesh_format.hpp"
+
+using namespace fightingengine;
+
+static void
+cook_mesh(const aiMesh* mesh, mesh_format::MeshData& out)
+{
+  mesh_format::Submesh submesh;
+  submesh.first_index = static_cast<uint32_t>(out.indices.size());
+  submesh.base_vertex = static_cast<uint32_t>(out.vertices.size());
+  submesh.vertex_count = mesh->mNumVertices;
+  submesh.material = mesh->mMaterialIndex;
+
+  out.vertices.reserve(out.vertices.size() + mesh->mNumVertices);
+  for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+    mesh_format::Vertex vertex = {};
+    vertex.position[0] = mesh->mVertices[i].x;
+    vertex.position[1] = mesh->mVertices[i].y;
+    vertex.position[2] = mesh->mVertices[i].z;
+    if (mesh->HasNormals()) {
+      vertex.normal[0] = mesh->mNormals[i].x;
+      vertex.normal[1] = mesh->mNormals[i].y;
+      vertex.normal[2] = mesh->mNormals[i].z;
+    }
+    if (mesh->mTextureCoords[0]) {
+      vertex.tex_coords[0] = mesh->mTextureCoords[0][i].x;
+      vertex.tex_coords[1] = mesh->mTextureCoords[0][i].y;
+    }
+    out.vertices.push_back(vertex);
+  }
+
+  // triangulated, so every face is 3 indices
+  out.indices.reserve(out.indices.size() + mesh->mNumFaces * 3);
+  for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+    const aiFace& face = mesh->mFaces[i];
+    for (unsigned int j = 0; j < face.mNumIndices; j++)
+      out.indices.push_back(face.mIndices[j]);
+  }
+
+  submesh.index_count = static_cast<uint32_t>(out.indices.size()) - submesh.first_index;
+  submesh.bounds = mesh_format::compute_bounds(&out.vertices[submesh.base_vertex], submesh.vertex_count);
+  out.submeshes.push_back(submesh);
+}
+
+// same order as Model::process_node()
+static void
+cook_node(const aiNode* node, const aiScene* scene, mesh_format::MeshData& out)
+{
+  for (unsigned int i = 0; i < node->mNumMeshes; i++)
+    cook_mesh(scene->mMeshes[node->mMeshes[i]], out);
+  for (unsigned int i = 0; i < node->mNumChildren; i++)
+    cook_node(node->mChildren[i], scene, out);
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool quantize = false;
+  if (!args.empty() && args[0] == "--quantize") {
+    quantize = true;
+    args.erase(args.begin());
+  }
+
+  if (args.empty()) {
+    std::cerr << "usage: mesh_cooker [--quantize] <input model> [output .mesh]" << std::endl;
+    return 1;
+  }
+
+  const std::string input = args[0];
+  const std::string output =
+    args.size() > 1 ? args[1] : std::filesystem::path(input).replace_extension(".mesh").string();
+
+  // the runtime import flags, plus the slower clean up passes there's no time for at startup
+  Assimp::Importer importer;
+  const aiScene* scene = importer.ReadFile(input,
+                                           aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices |
+                                             aiProcess_ImproveCacheLocality);
+  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+    std::cerr << "Failed to load scene: " << importer.GetErrorString() << std::endl;
+    return 1;
+  }
+
+  mesh_format::MeshData mesh;
+  mesh.layout = quantize ? mesh_format::VertexLayout::Quantized : mesh_format::VertexLayout::Float;
+  cook_node(scene->mRootNode, scene, mesh);
+  mesh.bounds = mesh_format::compute_bounds(mesh.vertices.data(), mesh.vertices.size());
+
+  if (!mesh_format::write(output, mesh))
+    return 1;
+
+  std::cout << "cooked " << input << " -> " << output << " (" << mesh.submeshes.size() << " submeshes, "
+            << mesh.vertices.size() << " vertices, " << mesh.indices.size() << " indices)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,136 @@
+//
+// texture_cooker: bakes an image (anything stb_image reads) in to a .tex file.
+// usage: texture_cooker [--rgba | --bc1 | --bc3] [--linear] <input image> [output .tex]
+// the output defaults to the input path with a .tex extension,
+// which load_texture() picks up in place of the source.
+// the format defaults to bc1, or bc3 if the image has any transparency.
+// --linear filters the mips without srgb decoding, for normal maps and other data.
+//
+
+// c++ standard library headers
+#include <algorithm>
+#include <filesystem> // C++17
+#include <iostream>
+#include <string>
+#include <vector>
+
+// other library headers
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb_dxt.h>
+
+// engine headers
+#include "engine/texture_format.hpp"
+
+using namespace fightingengine;
+
+static bool
+has_transparency(const texture_format::Image& image)
+{
+  for (size_t i = 3; i < image.rgba.size(); i += 4) {
+    if (image.rgba[i] != 255)
+      return true;
+  }
+  return false;
+}
+
+// 4x4 blocks, the edges of images that aren't a multiple of 4 repeat their last texel
+static std::vector<uint8_t>
+compress(const texture_format::Image& image, texture_format::Format format)
+{
+  const bool alpha = format == texture_format::Format::BC3;
+  const uint32_t block_size = alpha ? 16 : 8;
+  const uint32_t blocks_x = (image.width + 3) / 4;
+  const uint32_t blocks_y = (image.height + 3) / 4;
+
+  std::vector<uint8_t> result(static_cast<size_t>(blocks_x) * blocks_y * block_size);
+  uint8_t block[16 * 4];
+  for (uint32_t by = 0; by < blocks_y; by++) {
+    for (uint32_t bx = 0; bx < blocks_x; bx++) {
+      for (uint32_t y = 0; y < 4; y++) {
+        for (uint32_t x = 0; x < 4; x++) {
+          const uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+          const uint32_t sy = std::min(by * 4 + y, image.height - 1);
+          const uint8_t* texel = &image.rgba[(static_cast<size_t>(sy) * image.width + sx) * 4];
+          std::copy(texel, texel + 4, &block[(y * 4 + x) * 4]);
+        }
+      }
+      uint8_t* out = &result[(static_cast<size_t>(by) * blocks_x + bx) * block_size];
+      stb_compress_dxt_block(out, block, alpha ? 1 : 0, STB_DXT_HIGHQUAL);
+    }
+  }
+  return result;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool format_given = false;
+  texture_format::Format format = texture_format::Format::BC1;
+  bool srgb = true;
+  while (!args.empty() && args[0].rfind("--", 0) == 0) {
+    if (args[0] == "--rgba" || args[0] == "--bc1" || args[0] == "--bc3") {
+      format_given = true;
+      format = args[0] == "--rgba" ? texture_format::Format::RGBA8
+               : args[0] == "--bc1" ? texture_format::Format::BC1
+                                    : texture_format::Format::BC3;
+    } else if (args[0] == "--linear") {
+      srgb = false;
+    } else {
+      std::cerr << "unknown option " << args[0] << std::endl;
+      return 1;
+    }
+    args.erase(args.begin());
+  }
+
+  if (args.empty()) {
+    std::cerr << "usage: texture_cooker [--rgba | --bc1 | --bc3] [--linear] <input image> [output .tex]" << std::endl;
+    return 1;
+  }
+
+  const std::string input = args[0];
+  const std::string output =
+    args.size() > 1 ? args[1] : std::filesystem::path(input).replace_extension(".tex").string();
+
+  // the same orientation as load_texture(), always rgba
+  int width, height, components;
+  unsigned char* data = stbi_load(input.c_str(), &width, &height, &components, 4);
+  if (!data) {
+    std::cerr << "Failed to load image: " << input << " " << stbi_failure_reason() << std::endl;
+    return 1;
+  }
+  texture_format::Image base;
+  base.width = static_cast<uint32_t>(width);
+  base.height = static_cast<uint32_t>(height);
+  base.rgba.assign(data, data + static_cast<size_t>(width) * height * 4);
+  stbi_image_free(data);
+
+  if (!format_given && has_transparency(base))
+    format = texture_format::Format::BC3;
+
+  std::vector<texture_format::Image> mips = texture_format::generate_mips(base, srgb);
+
+  texture_format::TextureData texture;
+  texture.format = format;
+  texture.width = base.width;
+  texture.height = base.height;
+  size_t bytes = 0;
+  for (const texture_format::Image& mip : mips) {
+    if (format == texture_format::Format::RGBA8)
+      texture.levels.push_back(mip.rgba);
+    else
+      texture.levels.push_back(compress(mip, format));
+    bytes += texture.levels.back().size();
+  }
+
+  if (!texture_format::write(output, texture))
+    return 1;
+
+  const char* format_names[] = { "rgba8", "bc1", "bc3" };
+  std::cout << "cooked " << input << " -> " << output << " (" << width << "x" << height << " "
+            << format_names[static_cast<int>(format)] << ", " << mips.size() << " levels, " << bytes << " bytes)"
+            << std::endl;
+  return 0;
+}